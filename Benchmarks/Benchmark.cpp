@@ -0,0 +1,210 @@
+#include "Benchmark.h"
+#include <LavaCake/Helpers/Trace.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace LavaCake {
+  namespace Benchmark {
+
+    namespace {
+      struct benchmark {
+        std::string                                 name;
+        std::function<void(benchmarkState&)>        function;
+        int64_t                                     argument;
+        bool                                        distribution;
+      };
+
+      struct result {
+        std::string   name;
+        std::string   aggregate;
+        uint64_t      iterations;
+        double        time;           // nanoseconds per iteration
+        double        itemsPerSecond;
+        double        bytesPerSecond;
+        bool          distribution = false;
+        double        latency[5] = {};  // nanoseconds, see percentiles
+      };
+
+      const double percentiles[5] = { 0.0, 0.5, 0.9, 0.99, 1.0 };
+      const char* percentileNames[5] = { "min", "p50", "p90", "p99", "max" };
+
+      std::vector<benchmark>& registry() {
+        static std::vector<benchmark> benchmarks;
+        return benchmarks;
+      }
+
+      result run(const benchmark& b, double minTime) {
+        // grow the number of iterations until a run lasts long enough to be measured
+        uint64_t iterations = 1;
+        while (true) {
+          benchmarkState state(iterations, b.argument, b.distribution);
+          b.function(state);
+          double elapsed = state.elapsed();
+          if (elapsed >= minTime || iterations >= 1000000000ull) {
+            result r;
+            r.name = b.name;
+            r.iterations = iterations;
+            r.time = elapsed * 1e9 / double(iterations);
+            r.itemsPerSecond = elapsed > 0.0 ? double(state.items()) * double(iterations) / elapsed : 0.0;
+            r.bytesPerSecond = elapsed > 0.0 ? double(state.bytes()) * double(iterations) / elapsed : 0.0;
+            if (b.distribution && !state.samples().empty()) {
+              std::vector<std::chrono::steady_clock::duration> samples = state.samples();
+              std::sort(samples.begin(), samples.end());
+              r.distribution = true;
+              for (size_t p = 0; p < 5; p++) {
+                size_t index = std::min(samples.size() - 1, size_t(percentiles[p] * double(samples.size() - 1) + 0.5));
+                r.latency[p] = std::chrono::duration<double, std::nano>(samples[index]).count();
+              }
+            }
+            return r;
+          }
+          double scale = elapsed > 0.0 ? 1.4 * minTime / elapsed : 100.0;
+          iterations = std::max(iterations + 1, uint64_t(double(iterations) * std::min(scale, 100.0)));
+        }
+      }
+
+      result median(std::vector<result> runs) {
+        std::sort(runs.begin(), runs.end(), [](const result& a, const result& b) { return a.time < b.time; });
+        result r = runs[runs.size() / 2];
+        r.aggregate = "median";
+        return r;
+      }
+
+      // the output follows the JSON format of Google Benchmark so its compare.py script can diff two runs
+      void writeJson(std::ostream& out, const std::vector<result>& results) {
+        char date[64];
+        std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+        out << std::setprecision(10);
+        out << "{\n  \"context\": {\n"
+          << "    \"date\": \"" << date << "\",\n"
+          << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef NDEBUG
+          << "    \"library_build_type\": \"release\"\n"
+#else
+          << "    \"library_build_type\": \"debug\"\n"
+#endif
+          << "  },\n  \"benchmarks\": [";
+        for (size_t i = 0; i < results.size(); i++) {
+          const result& r = results[i];
+          out << (i == 0 ? "\n" : ",\n");
+          out << "    {\n"
+            << "      \"name\": \"" << LavaCake::Helpers::escapeJson(r.aggregate.empty() ? r.name : r.name + "_" + r.aggregate) << "\",\n"
+            << "      \"run_name\": \"" << LavaCake::Helpers::escapeJson(r.name) << "\",\n"
+            << "      \"run_type\": \"" << (r.aggregate.empty() ? "iteration" : "aggregate") << "\",\n";
+          if (!r.aggregate.empty()) {
+            out << "      \"aggregate_name\": \"" << r.aggregate << "\",\n";
+          }
+          out << "      \"iterations\": " << r.iterations << ",\n"
+            << "      \"real_time\": " << r.time << ",\n"
+            << "      \"cpu_time\": " << r.time << ",\n";
+          if (r.itemsPerSecond > 0.0) {
+            out << "      \"items_per_second\": " << r.itemsPerSecond << ",\n";
+          }
+          if (r.bytesPerSecond > 0.0) {
+            out << "      \"bytes_per_second\": " << r.bytesPerSecond << ",\n";
+          }
+          if (r.distribution) {
+            for (size_t p = 0; p < 5; p++) {
+              out << "      \"latency_" << percentileNames[p] << "\": " << r.latency[p] << ",\n";
+            }
+          }
+          out << "      \"time_unit\": \"ns\"\n    }";
+        }
+        out << "\n  ]\n}\n";
+      }
+
+      bool parseFlag(const char* arg, const char* flag, std::string& value) {
+        size_t length = std::strlen(flag);
+        if (std::strncmp(arg, flag, length) == 0 && arg[length] == '=') {
+          value = arg + length + 1;
+          return true;
+        }
+        return false;
+      }
+    }
+
+    bool registerBenchmark(const std::string& name, std::function<void(benchmarkState&)> function, const std::vector<int64_t>& arguments, bool distribution) {
+      if (arguments.empty()) {
+        registry().push_back({ name, function, 0, distribution });
+      }
+      for (int64_t argument : arguments) {
+        registry().push_back({ name + "/" + std::to_string(argument), function, argument, distribution });
+      }
+      return true;
+    }
+
+  }
+}
+
+int main(int argc, char** argv) {
+  using namespace LavaCake::Benchmark;
+
+  std::string filter;
+  std::string outFile;
+  double minTime = 0.5;
+  int repetitions = 1;
+  for (int i = 1; i < argc; i++) {
+    std::string value;
+    if (parseFlag(argv[i], "--benchmark_filter", value)) {
+      filter = value;
+    }
+    else if (parseFlag(argv[i], "--benchmark_out", value)) {
+      outFile = value;
+    }
+    else if (parseFlag(argv[i], "--benchmark_min_time", value)) {
+      minTime = std::max(0.0, std::atof(value.c_str()));
+    }
+    else if (parseFlag(argv[i], "--benchmark_repetitions", value)) {
+      repetitions = std::max(1, std::atoi(value.c_str()));
+    }
+    else {
+      std::cerr << "usage: " << argv[0] << " [--benchmark_filter=<substring>] [--benchmark_out=<file.json>]"
+        << " [--benchmark_min_time=<seconds>] [--benchmark_repetitions=<count>]" << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<result> results;
+  std::printf("%-48s %16s %14s\n", "Benchmark", "Time (ns)", "Iterations");
+  for (const benchmark& b : registry()) {
+    if (!filter.empty() && b.name.find(filter) == std::string::npos) {
+      continue;
+    }
+    std::vector<result> runs;
+    for (int r = 0; r < repetitions; r++) {
+      runs.push_back(run(b, minTime));
+      const result& last = runs.back();
+      std::printf("%-48s %16.1f %14llu", b.name.c_str(), last.time, (unsigned long long)last.iterations);
+      if (last.distribution) {
+        for (size_t p = 0; p < 5; p++) {
+          std::printf("  %s %.1f", percentileNames[p], last.latency[p]);
+        }
+      }
+      std::printf("\n");
+    }
+    results.insert(results.end(), runs.begin(), runs.end());
+    if (repetitions > 1) {
+      results.push_back(median(runs));
+      std::printf("%-48s %16.1f\n", (b.name + "_median").c_str(), results.back().time);
+    }
+  }
+
+  if (!outFile.empty()) {
+    std::ofstream ofs(outFile, std::ofstream::out | std::ofstream::trunc);
+    if (!ofs.is_open()) {
+      std::cerr << "Could not open " << outFile << std::endl;
+      return 1;
+    }
+    writeJson(ofs, results);
+  }
+  return 0;
+}
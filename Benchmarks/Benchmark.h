@@ -0,0 +1,146 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace LavaCake {
+  namespace Benchmark {
+
+    /**
+     *Class benchmarkState :
+     *\brief the state given to a benchmark function, the measured code runs in a while (state.keepRunning()) loop
+     */
+    class benchmarkState {
+    public:
+
+      benchmarkState(uint64_t iterations, int64_t argument, bool sampling = false) : m_iterations(iterations), m_argument(argument), m_sampling(sampling) {
+        if (m_sampling) {
+          m_samples.reserve(iterations);
+        }
+      }
+
+      /**
+       \brief start the timer on the first call, then count one iteration per call
+       \return false once the requested number of iterations is done, the timer being stopped
+       */
+      bool keepRunning() {
+        if (m_done == 0) {
+          m_start = std::chrono::steady_clock::now();
+        }
+        else if (m_sampling) {
+          // close the sample of the previous iteration, the time spent paused is not part of it
+          std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+          m_sample += now - m_start;
+          m_elapsed += now - m_start;
+          m_samples.push_back(m_sample);
+          m_sample = std::chrono::steady_clock::duration::zero();
+          m_start = now;
+        }
+        if (m_done == m_iterations) {
+          if (!m_sampling) {
+            m_elapsed += std::chrono::steady_clock::now() - m_start;
+          }
+          return false;
+        }
+        m_done++;
+        return true;
+      }
+
+      /**
+       \brief stop the timer, for setup code inside the loop
+       */
+      void pauseTiming() {
+        std::chrono::steady_clock::duration d = std::chrono::steady_clock::now() - m_start;
+        m_elapsed += d;
+        m_sample += d;
+      }
+
+      /**
+       \brief restart the timer stopped by pauseTiming
+       */
+      void resumeTiming() {
+        m_start = std::chrono::steady_clock::now();
+      }
+
+      /**
+       \brief get the argument the benchmark was registered with, 0 if it has none
+       */
+      int64_t argument() const {
+        return m_argument;
+      }
+
+      /**
+       \brief set the number of items processed by one iteration, reported as a rate
+       */
+      void setItemsPerIteration(uint64_t items) {
+        m_items = items;
+      }
+
+      /**
+       \brief set the number of bytes processed by one iteration, reported as a rate
+       */
+      void setBytesPerIteration(uint64_t bytes) {
+        m_bytes = bytes;
+      }
+
+      uint64_t iterations() const { return m_iterations; }
+      double elapsed() const { return std::chrono::duration<double>(m_elapsed).count(); }
+      uint64_t items() const { return m_items; }
+      uint64_t bytes() const { return m_bytes; }
+
+      /**
+       \brief get the duration of each iteration, only recorded for benchmarks registered with a latency distribution
+       */
+      const std::vector<std::chrono::steady_clock::duration>& samples() const { return m_samples; }
+
+    private:
+      uint64_t                                    m_iterations;
+      uint64_t                                    m_done = 0;
+      int64_t                                     m_argument;
+      uint64_t                                    m_items = 0;
+      uint64_t                                    m_bytes = 0;
+      std::chrono::steady_clock::time_point       m_start;
+      std::chrono::steady_clock::duration         m_elapsed = std::chrono::steady_clock::duration::zero();
+      bool                                        m_sampling;
+      std::chrono::steady_clock::duration         m_sample = std::chrono::steady_clock::duration::zero();
+      std::vector<std::chrono::steady_clock::duration>  m_samples;
+    };
+
+    /**
+     \brief register a benchmark, run once per argument or once without argument if the list is empty
+     \param name the name of the benchmark, the argument is appended to it
+     \param function the benchmark function
+     \param arguments the arguments given to the function through benchmarkState::argument
+     \param distribution time every iteration and report the latency percentiles, for benchmarks whose iterations last long enough to be timed one by one
+     \return true, to register benchmarks from static initializers
+     */
+    bool registerBenchmark(const std::string& name, std::function<void(benchmarkState&)> function, const std::vector<int64_t>& arguments = {}, bool distribution = false);
+
+    /**
+     \brief prevent the compiler from optimizing away the computation of a value
+     */
+    template <typename T>
+    inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+      asm volatile("" : : "r,m"(value) : "memory");
+#else
+      static volatile const void* sink;
+      sink = &value;
+#endif
+    }
+  }
+}
+
+#define LAVACAKE_BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define LAVACAKE_BENCHMARK_CONCAT(a, b) LAVACAKE_BENCHMARK_CONCAT_IMPL(a, b)
+
+// register a function void(benchmarkState&), optionally with a list of arguments: LAVACAKE_BENCHMARK(function, 64, 256)
+#define LAVACAKE_BENCHMARK(function, ...) \
+  static bool LAVACAKE_BENCHMARK_CONCAT(lavacakeBenchmark, __LINE__) = ::LavaCake::Benchmark::registerBenchmark(#function, function, { __VA_ARGS__ })
+
+// same as LAVACAKE_BENCHMARK, and report the distribution of the latency of one iteration
+#define LAVACAKE_BENCHMARK_DISTRIBUTION(function, ...) \
+  static bool LAVACAKE_BENCHMARK_CONCAT(lavacakeBenchmark, __LINE__) = ::LavaCake::Benchmark::registerBenchmark(#function, function, { __VA_ARGS__ }, true)
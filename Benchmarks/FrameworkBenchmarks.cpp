@@ -0,0 +1,78 @@
+#include "Benchmark.h"
+#include <LavaCake/Math/basics.h>
+#include <LavaCake/Framework/ByteDictionary.h>
+
+using namespace LavaCake;
+using namespace LavaCake::Framework;
+using namespace LavaCake::Benchmark;
+
+// a dictionary laid out like a uniform block, a matrix and a vector followed by a number of floats
+static ByteDictionary uniformBlock(uint32_t variables, blockLayout layout) {
+  ByteDictionary dictionary(layout);
+  mat4 m = Identity();
+  vec4f v = vec4f({ 0.0f, 0.0f, 0.0f, 1.0f });
+  dictionary.addVariableRange("model", std::span<const mat4, 1>{ &m, 1 });
+  dictionary.addVariableRange("color", std::span<const vec4f, 1>{ &v, 1 });
+  for (uint32_t i = 0; i < variables; i++) {
+    float f = 0.0f;
+    dictionary.addVariableRange("variable" + std::to_string(i), std::span<const float, 1>{ &f, 1 });
+  }
+  return dictionary;
+}
+
+static void byteDictionarySetByName(benchmarkState& state) {
+  ByteDictionary dictionary = uniformBlock(uint32_t(state.argument()), STD140);
+  mat4 m = PrepareTranslationMatrix(1.0f, 2.0f, 3.0f);
+  const std::string name = "model";
+  while (state.keepRunning()) {
+    dictionary.setVariableRange(name, std::span<const mat4, 1>{ &m, 1 });
+    doNotOptimize(dictionary.data().data());
+  }
+  state.setBytesPerIteration(sizeof(mat4));
+}
+LAVACAKE_BENCHMARK(byteDictionarySetByName, 8, 256);
+
+static void byteDictionarySetByHandle(benchmarkState& state) {
+  ByteDictionary dictionary = uniformBlock(uint32_t(state.argument()), STD140);
+  mat4 m = PrepareTranslationMatrix(1.0f, 2.0f, 3.0f);
+  variableHandle<mat4> handle;
+  handle.layout = dictionary.getVariableLayout("model");
+  while (state.keepRunning()) {
+    dictionary.setVariableRange(handle, std::span<const mat4, 1>{ &m, 1 });
+    doNotOptimize(dictionary.data().data());
+  }
+  state.setBytesPerIteration(sizeof(mat4));
+}
+LAVACAKE_BENCHMARK(byteDictionarySetByHandle, 8, 256);
+
+static void byteDictionaryGet(benchmarkState& state) {
+  ByteDictionary dictionary = uniformBlock(uint32_t(state.argument()), STD140);
+  const std::string name = "color";
+  while (state.keepRunning()) {
+    variableLayout layout = dictionary.getVariableLayout(name);
+    vec4f v;
+    std::memcpy(v.data(), dictionary.data().data() + layout.offset, sizeof(vec4f));
+    doNotOptimize(v);
+  }
+}
+LAVACAKE_BENCHMARK(byteDictionaryGet, 8, 256);
+
+static void byteDictionaryDirtyRanges(benchmarkState& state) {
+  ByteDictionary dictionary = uniformBlock(uint32_t(state.argument()), STD140);
+  std::vector<variableHandle<float>> handles;
+  for (int64_t i = 0; i < state.argument(); i += 4) {
+    variableHandle<float> handle;
+    handle.layout = dictionary.getVariableLayout("variable" + std::to_string(i));
+    handles.push_back(handle);
+  }
+  float f = 1.0f;
+  while (state.keepRunning()) {
+    for (auto& handle : handles) {
+      dictionary.setVariableRange(handle, std::span<const float, 1>{ &f, 1 });
+    }
+    auto ranges = dictionary.dirtyRanges(64);
+    doNotOptimize(ranges.data());
+    dictionary.clearDirtyRanges();
+  }
+}
+LAVACAKE_BENCHMARK(byteDictionaryDirtyRanges, 64, 1024);
@@ -0,0 +1,228 @@
+#include "Benchmark.h"
+#include <LavaCake/Framework/Framework.h>
+#include <LavaCake/Geometry/mesh.h>
+
+// Benchmarks of the framework on a headless device, they need no window and run on software drivers too:
+// select lavapipe or SwiftShader with VK_ICD_FILENAMES (VK_DRIVER_FILES on recent loaders) pointing to its icd json file
+
+using namespace LavaCake;
+using namespace LavaCake::Framework;
+using namespace LavaCake::Benchmark;
+
+namespace {
+  const uint32_t renderSize = 256;
+
+  // the device is created by the first GPU benchmark and released when the program exits
+  struct gpuContext {
+    gpuContext() {
+      Device::getDevice()->initDevices(1, 1);
+    }
+
+    ~gpuContext() {
+      Device* d = Device::getDevice();
+      d->waitForAllCommands();
+      d->end();
+    }
+
+    // the command pool of the device belongs to the family of the first graphic queue, every command is submitted there
+    const Queue& queue() {
+      return Device::getDevice()->getGraphicQueue(0);
+    }
+  };
+
+  gpuContext& context() {
+    static gpuContext c;
+    return c;
+  }
+
+  std::string shaderPath(const std::string& name) {
+    return std::string(LAVACAKE_BENCHMARK_SHADER_DIR) + name;
+  }
+
+  void submitAndWait(const Queue& queue, CommandBuffer& cmd) {
+    cmd.endRecord();
+    cmd.submit(queue, {}, {});
+    cmd.wait(UINT32_MAX);
+    cmd.resetFence();
+  }
+
+  std::shared_ptr<Geometry::Mesh_t> triangle() {
+    auto mesh = std::make_shared<Geometry::TriangleMesh>(Geometry::P3);
+    mesh->appendVertex({ -0.5f, -0.5f, 0.0f });
+    mesh->appendVertex({ 0.5f, -0.5f, 0.0f });
+    mesh->appendVertex({ 0.0f, 0.5f, 0.0f });
+    return mesh;
+  }
+
+  // an offscreen render pass drawing in a color attachment kept after the pass
+  struct offscreenTarget {
+    RenderPass                                  renderPass;
+    FrameBuffer                                 frameBuffer;
+
+    offscreenTarget(const Queue& queue, CommandBuffer& cmd, const RenderPass::SubPass& pipelines) :
+      renderPass(VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_D16_UNORM), frameBuffer(renderSize, renderSize) {
+      SubpassAttachment attachment;
+      attachment.nbColor = 1;
+      attachment.storeColor = true;
+      renderPass.addSubPass(pipelines, attachment);
+      renderPass.compile();
+      renderPass.prepareOutputFrameBuffer(queue, cmd, frameBuffer);
+    }
+  };
+
+  std::shared_ptr<GraphicPipeline> trianglePipeline(const VertexShaderModule& vertex, const FragmentShaderModule& fragment) {
+    auto pipeline = std::make_shared<GraphicPipeline>(vec3f({ 0.0f, 0.0f, 0.0f }), vec3f({ float(renderSize), float(renderSize), 1.0f }),
+      vec2f({ 0.0f, 0.0f }), vec2f({ float(renderSize), float(renderSize) }));
+    pipeline->setVertexModule(vertex);
+    pipeline->setFragmentModule(fragment);
+    pipeline->setDescriptorSet(std::make_shared<DescriptorSet>());
+    return pipeline;
+  }
+}
+
+// host buffer to device local buffer copy, the time includes the write in the mapped memory, the submission and the wait
+static void bufferUpload(benchmarkState& state) {
+  const Queue& queue = context().queue();
+  uint64_t size = uint64_t(state.argument());
+  CommandBuffer cmd;
+  Buffer staging(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+  Buffer target(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+  std::vector<std::byte> data(size, std::byte(1));
+
+  while (state.keepRunning()) {
+    staging.write(std::span<const std::byte>(data));
+    cmd.beginRecord();
+    target.setAccess(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+    staging.copyToBuffer(cmd, target, { 0, 0, size });
+    target.setAccess(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+    submitAndWait(queue, cmd);
+  }
+  state.setBytesPerIteration(size);
+}
+LAVACAKE_BENCHMARK_DISTRIBUTION(bufferUpload, 4096, 1 << 20, 16 << 20);
+
+// device local buffer to host buffer copy, the time includes the submission, the wait and the copy out of the mapped memory
+static void bufferReadback(benchmarkState& state) {
+  const Queue& queue = context().queue();
+  uint64_t size = uint64_t(state.argument());
+  CommandBuffer cmd;
+  std::vector<std::byte> data(size, std::byte(1));
+  Buffer source(queue, cmd, data, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+  Buffer staging(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+
+  while (state.keepRunning()) {
+    cmd.beginRecord();
+    source.setAccess(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+    staging.setAccess(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+    source.copyToBuffer(cmd, staging, { 0, 0, size });
+    staging.setAccess(cmd, VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+    submitAndWait(queue, cmd);
+    staging.invalidate(0, size);
+    std::memcpy(data.data(), staging.map(), size);
+    doNotOptimize(data.data());
+  }
+  state.setBytesPerIteration(size);
+}
+LAVACAKE_BENCHMARK_DISTRIBUTION(bufferReadback, 4096, 1 << 20, 16 << 20);
+
+// creation and destruction of a descriptor set, its layout and its pool, with a number of storage buffer bindings
+static void descriptorSetCreation(benchmarkState& state) {
+  context();
+  Buffer buffer(1024, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+  int bindings = int(state.argument());
+
+  while (state.keepRunning()) {
+    DescriptorSet set;
+    for (int i = 0; i < bindings; i++) {
+      set.addBuffer(buffer, VK_SHADER_STAGE_COMPUTE_BIT, i);
+    }
+    set.generateDescriptorLayout();
+    doNotOptimize(set.getHandle());
+  }
+  state.setItemsPerIteration(uint64_t(bindings));
+}
+LAVACAKE_BENCHMARK_DISTRIBUTION(descriptorSetCreation, 1, 8, 32);
+
+// creation of a compute pipeline from an already loaded shader module
+static void computePipelineCompile(benchmarkState& state) {
+  context();
+  Buffer buffer(64 * sizeof(float), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+  ComputeShaderModule module(shaderPath("dispatch.comp.spv"));
+  auto set = std::make_shared<DescriptorSet>();
+  set->addBuffer(buffer, VK_SHADER_STAGE_COMPUTE_BIT, 0);
+
+  while (state.keepRunning()) {
+    ComputePipeline pipeline;
+    pipeline.setComputeModule(module);
+    pipeline.setDescriptorSet(set);
+    pipeline.compile();
+  }
+}
+LAVACAKE_BENCHMARK_DISTRIBUTION(computePipelineCompile);
+
+// creation of a graphic pipeline for an offscreen render pass, from already loaded shader modules
+static void graphicPipelineCompile(benchmarkState& state) {
+  const Queue& queue = context().queue();
+  CommandBuffer cmd;
+  VertexShaderModule vertex(shaderPath("triangle.vert.spv"));
+  FragmentShaderModule fragment(shaderPath("triangle.frag.spv"));
+  auto vertices = std::make_shared<VertexBuffer>(queue, cmd, std::vector<std::shared_ptr<Geometry::Mesh_t>>{ triangle() });
+  auto reference = trianglePipeline(vertex, fragment);
+  reference->setVertices({ vertices });
+  offscreenTarget target(queue, cmd, { reference });
+  VkRenderPass renderPass = target.renderPass.getHandle();
+
+  while (state.keepRunning()) {
+    auto pipeline = trianglePipeline(vertex, fragment);
+    pipeline->setVertices({ vertices });
+    pipeline->compile(renderPass, 1);
+  }
+}
+LAVACAKE_BENCHMARK_DISTRIBUTION(graphicPipelineCompile);
+
+// a number of dispatches of a single workgroup recorded and submitted together, to measure the cost of one dispatch
+static void computeDispatch(benchmarkState& state) {
+  const Queue& queue = context().queue();
+  CommandBuffer cmd;
+  Buffer buffer(64 * sizeof(float), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+  ComputeShaderModule module(shaderPath("dispatch.comp.spv"));
+  auto set = std::make_shared<DescriptorSet>();
+  set->addBuffer(buffer, VK_SHADER_STAGE_COMPUTE_BIT, 0);
+  ComputePipeline pipeline;
+  pipeline.setComputeModule(module);
+  pipeline.setDescriptorSet(set);
+  pipeline.compile();
+  uint64_t dispatches = uint64_t(state.argument());
+
+  while (state.keepRunning()) {
+    cmd.beginRecord();
+    for (uint64_t i = 0; i < dispatches; i++) {
+      pipeline.compute(cmd, 1, 1, 1);
+    }
+    submitAndWait(queue, cmd);
+  }
+  state.setItemsPerIteration(dispatches);
+}
+LAVACAKE_BENCHMARK_DISTRIBUTION(computeDispatch, 1, 64, 1024);
+
+// a render pass drawing a triangle a number of times in an offscreen frame buffer, to measure the cost of one draw call
+static void offscreenDraw(benchmarkState& state) {
+  const Queue& queue = context().queue();
+  CommandBuffer cmd;
+  VertexShaderModule vertex(shaderPath("triangle.vert.spv"));
+  FragmentShaderModule fragment(shaderPath("triangle.frag.spv"));
+  auto vertices = std::make_shared<VertexBuffer>(queue, cmd, std::vector<std::shared_ptr<Geometry::Mesh_t>>{ triangle() });
+  auto pipeline = trianglePipeline(vertex, fragment);
+  // the pipeline records one draw per vertex buffer
+  pipeline->setVertices(std::vector<std::shared_ptr<VertexBuffer>>(size_t(state.argument()), vertices));
+  offscreenTarget target(queue, cmd, { pipeline });
+  std::vector<VkClearValue> clearValues = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+
+  while (state.keepRunning()) {
+    cmd.beginRecord();
+    target.renderPass.draw(cmd, target.frameBuffer, vec2u({ 0, 0 }), vec2u({ renderSize, renderSize }), clearValues);
+    submitAndWait(queue, cmd);
+  }
+  state.setItemsPerIteration(uint64_t(state.argument()));
+}
+LAVACAKE_BENCHMARK_DISTRIBUTION(offscreenDraw, 1, 100, 10000);
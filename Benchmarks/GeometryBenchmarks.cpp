@@ -0,0 +1,110 @@
+#include "Benchmark.h"
+#include <LavaCake/Geometry/meshLoader.h>
+#include <LavaCake/Geometry/meshExporter.h>
+#include <LavaCake/Geometry/computationalMesh.h>
+#include <cstdio>
+#include <fstream>
+
+using namespace LavaCake;
+using namespace LavaCake::Geometry;
+using namespace LavaCake::Benchmark;
+
+// a height field grid of size x size quads, 2 * size * size triangles
+static TriangleIndexedMesh* generateGrid(uint32_t size) {
+  TriangleIndexedMesh* mesh = new TriangleIndexedMesh(PN3);
+  for (uint32_t j = 0; j <= size; j++) {
+    for (uint32_t i = 0; i <= size; i++) {
+      float x = float(i) / float(size);
+      float y = float(j) / float(size);
+      mesh->appendVertex({ x, y, 0.1f * sinf(8.0f * x) * cosf(8.0f * y), 0.0f, 0.0f, 1.0f });
+    }
+  }
+  for (uint32_t j = 0; j < size; j++) {
+    for (uint32_t i = 0; i < size; i++) {
+      uint32_t v = j * (size + 1) + i;
+      mesh->appendIndex(v);
+      mesh->appendIndex(v + 1);
+      mesh->appendIndex(v + size + 1);
+      mesh->appendIndex(v + 1);
+      mesh->appendIndex(v + size + 2);
+      mesh->appendIndex(v + size + 1);
+    }
+  }
+  return mesh;
+}
+
+static std::string writeObj(uint32_t size) {
+  std::string filename = "lavacake_benchmark_" + std::to_string(size) + ".obj";
+  TriangleIndexedMesh* mesh = generateGrid(size);
+  std::ofstream ofs(filename, std::ofstream::out | std::ofstream::trunc);
+  const std::vector<float>& vertices = mesh->vertices();
+  for (size_t v = 0; v < vertices.size(); v += 6) {
+    ofs << "v " << vertices[v] << " " << vertices[v + 1] << " " << vertices[v + 2] << "\n";
+    ofs << "vn " << vertices[v + 3] << " " << vertices[v + 4] << " " << vertices[v + 5] << "\n";
+    ofs << "vt " << vertices[v] << " " << vertices[v + 1] << "\n";
+  }
+  const std::vector<uint32_t>& indices = mesh->indices();
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    ofs << "f";
+    for (size_t k = 0; k < 3; k++) {
+      uint32_t index = indices[i + k] + 1;
+      ofs << " " << index << "/" << index << "/" << index;
+    }
+    ofs << "\n";
+  }
+  delete mesh;
+  return filename;
+}
+
+static void loadObj(benchmarkState& state) {
+  std::string filename = writeObj(uint32_t(state.argument()));
+  while (state.keepRunning()) {
+    auto model = Load3DModelFromObjFile(filename, true, true, true, false);
+    doNotOptimize(model.first.data());
+  }
+  state.setItemsPerIteration(uint64_t(state.argument()) * state.argument() * 2);
+  std::remove(filename.c_str());
+}
+LAVACAKE_BENCHMARK(loadObj, 16, 64, 256);
+
+static void loadObjIndexed(benchmarkState& state) {
+  std::string filename = writeObj(uint32_t(state.argument()));
+  while (state.keepRunning()) {
+    auto model = Load3DModelFromObjFile(filename, true, false);
+    doNotOptimize(model.first.first.data());
+  }
+  state.setItemsPerIteration(uint64_t(state.argument()) * state.argument() * 2);
+  std::remove(filename.c_str());
+}
+LAVACAKE_BENCHMARK(loadObjIndexed, 16, 64, 256);
+
+static void polygonalMeshConstruction(benchmarkState& state) {
+  TriangleIndexedMesh* mesh = generateGrid(uint32_t(state.argument()));
+  while (state.keepRunning()) {
+    PolygonalMesh polygonal(mesh);
+    doNotOptimize(polygonal.faces.data());
+
+    // the mesh does not free its elements
+    state.pauseTiming();
+    for (auto v : polygonal.vertices) delete v;
+    for (auto e : polygonal.edges) delete e;
+    for (auto f : polygonal.faces) delete f;
+    state.resumeTiming();
+  }
+  state.setItemsPerIteration(mesh->indices().size() / 3);
+  delete mesh;
+}
+LAVACAKE_BENCHMARK(polygonalMeshConstruction, 16, 64, 128);
+
+static void exportPly(benchmarkState& state) {
+  TriangleIndexedMesh* mesh = generateGrid(uint32_t(state.argument()));
+  std::string filename = "lavacake_benchmark_" + std::to_string(state.argument()) + ".ply";
+  while (state.keepRunning()) {
+    bool written = exportToPly(mesh, filename.data());
+    doNotOptimize(written);
+  }
+  state.setItemsPerIteration(mesh->indices().size() / 3);
+  std::remove(filename.c_str());
+  delete mesh;
+}
+LAVACAKE_BENCHMARK(exportPly, 16, 64, 256);
@@ -0,0 +1,127 @@
+#include "Benchmark.h"
+#include <LavaCake/Helpers/ABBox.h>
+#include <LavaCake/Helpers/Field.h>
+#include <random>
+
+using namespace LavaCake;
+using namespace LavaCake::Helpers;
+using namespace LavaCake::Benchmark;
+
+static std::vector<float> randomValues(size_t count, float min, float max) {
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> distribution(min, max);
+  std::vector<float> values(count);
+  for (float& v : values) {
+    v = distribution(generator);
+  }
+  return values;
+}
+
+static void field2DGridSample(benchmarkState& state) {
+  uint32_t size = uint32_t(state.argument());
+  std::vector<float> data = randomValues(size_t(size) * size, 0.0f, 1.0f);
+  Field2DGrid<float> field(data, size, size, ABBox<2>(vec2f({ 0.0f, 0.0f }), vec2f({ 1.0f, 1.0f })));
+  std::vector<float> coordinates = randomValues(2048, 0.0f, 1.0f);
+
+  size_t i = 0;
+  while (state.keepRunning()) {
+    float v = field.sample(vec2f({ coordinates[i], coordinates[i + 1] }));
+    doNotOptimize(v);
+    i = (i + 2) % coordinates.size();
+  }
+  state.setItemsPerIteration(1);
+}
+LAVACAKE_BENCHMARK(field2DGridSample, 64, 1024);
+
+static void field3DGridSample(benchmarkState& state, fieldLayout layout) {
+  uint32_t size = uint32_t(state.argument());
+  std::vector<float> data = randomValues(size_t(size) * size * size, 0.0f, 1.0f);
+  Field3DGrid<float> field(data, size, size, size, ABBox<3>(vec3f({ 0.0f, 0.0f, 0.0f }), vec3f({ 1.0f, 1.0f, 1.0f })), nullptr, layout);
+  std::vector<float> coordinates = randomValues(3072, 0.0f, 1.0f);
+
+  size_t i = 0;
+  while (state.keepRunning()) {
+    float v = field.sample(vec3f({ coordinates[i], coordinates[i + 1], coordinates[i + 2] }));
+    doNotOptimize(v);
+    i = (i + 3) % coordinates.size();
+  }
+  state.setItemsPerIteration(1);
+}
+
+static void field3DGridSampleLinear(benchmarkState& state) {
+  field3DGridSample(state, LINEAR);
+}
+LAVACAKE_BENCHMARK(field3DGridSampleLinear, 32, 256);
+
+static void field3DGridSampleBricked(benchmarkState& state) {
+  field3DGridSample(state, BRICKED);
+}
+LAVACAKE_BENCHMARK(field3DGridSampleBricked, 32, 256);
+
+static void field3DGridSampleBatch(benchmarkState& state) {
+  uint32_t size = 128;
+  std::vector<float> data = randomValues(size_t(size) * size * size, 0.0f, 1.0f);
+  Field3DGrid<float> field(data, size, size, size, ABBox<3>(vec3f({ 0.0f, 0.0f, 0.0f }), vec3f({ 1.0f, 1.0f, 1.0f })));
+  std::vector<float> coordinates = randomValues(size_t(state.argument()) * 3, 0.0f, 1.0f);
+  std::vector<vec3f> positions(size_t(state.argument()));
+  for (size_t i = 0; i < positions.size(); i++) {
+    positions[i] = vec3f({ coordinates[3 * i], coordinates[3 * i + 1], coordinates[3 * i + 2] });
+  }
+  std::vector<float> values(positions.size());
+
+  while (state.keepRunning()) {
+    field.sample(std::span<const vec3f>(positions), std::span<float>(values));
+    doNotOptimize(values.data());
+  }
+  state.setItemsPerIteration(positions.size());
+}
+LAVACAKE_BENCHMARK(field3DGridSampleBatch, 4096);
+
+static void aBBoxAddPoint(benchmarkState& state) {
+  std::vector<float> coordinates = randomValues(3072, -1.0f, 1.0f);
+  ABBox<3> box;
+  size_t i = 0;
+  while (state.keepRunning()) {
+    box.addPoint(vec3f({ coordinates[i], coordinates[i + 1], coordinates[i + 2] }));
+    doNotOptimize(box);
+    i = (i + 3) % coordinates.size();
+  }
+}
+LAVACAKE_BENCHMARK(aBBoxAddPoint);
+
+static void aBBoxAddBox(benchmarkState& state) {
+  ABBox<3> a(vec3f({ -1.0f, -1.0f, -1.0f }), vec3f({ 1.0f, 1.0f, 1.0f }));
+  ABBox<3> b(vec3f({ 0.0f, 0.5f, -2.0f }), vec3f({ 2.0f, 1.5f, 0.0f }));
+  while (state.keepRunning()) {
+    ABBox<3> c = a;
+    c.addBox(b);
+    doNotOptimize(c);
+  }
+}
+LAVACAKE_BENCHMARK(aBBoxAddBox);
+
+static void aBBoxIsContained(benchmarkState& state) {
+  std::vector<float> coordinates = randomValues(3072, -2.0f, 2.0f);
+  ABBox<3> box(vec3f({ -1.0f, -1.0f, -1.0f }), vec3f({ 1.0f, 1.0f, 1.0f }));
+  size_t i = 0;
+  while (state.keepRunning()) {
+    vec3f p = vec3f({ coordinates[i], coordinates[i + 1], coordinates[i + 2] });
+    bool inside = box.isContained(p);
+    doNotOptimize(inside);
+    i = (i + 3) % coordinates.size();
+  }
+}
+LAVACAKE_BENCHMARK(aBBoxIsContained);
+
+static void aBBoxDiag(benchmarkState& state) {
+  vec3f min = vec3f({ -1.0f, -1.0f, -1.0f });
+  vec3f max = vec3f({ 1.0f, 2.0f, 3.0f });
+  while (state.keepRunning()) {
+    // a new box has no cached diagonal
+    ABBox<3> box(min, max);
+    vec3f d = box.diag();
+    doNotOptimize(d);
+    doNotOptimize(min);
+  }
+}
+LAVACAKE_BENCHMARK(aBBoxDiag);
@@ -0,0 +1,79 @@
+#include "Benchmark.h"
+#include <LavaCake/Math/basics.h>
+
+using namespace LavaCake;
+using namespace LavaCake::Benchmark;
+
+static void vec3Arithmetic(benchmarkState& state) {
+  vec3f a = vec3f({ 1.0f, 2.0f, 3.0f });
+  vec3f b = vec3f({ 0.5f, -1.0f, 2.0f });
+  while (state.keepRunning()) {
+    a = (a + b) * 0.5f - b / 3.0f;
+    doNotOptimize(a);
+  }
+}
+LAVACAKE_BENCHMARK(vec3Arithmetic);
+
+static void vec3CrossNormalize(benchmarkState& state) {
+  vec3f a = vec3f({ 1.0f, 2.0f, 3.0f });
+  vec3f b = vec3f({ 0.5f, -1.0f, 2.0f });
+  while (state.keepRunning()) {
+    a = Normalize(cross(a, b));
+    doNotOptimize(a);
+  }
+}
+LAVACAKE_BENCHMARK(vec3CrossNormalize);
+
+static void vec3Dot(benchmarkState& state) {
+  vec3f a = vec3f({ 1.0f, 2.0f, 3.0f });
+  vec3f b = vec3f({ 0.5f, -1.0f, 2.0f });
+  while (state.keepRunning()) {
+    float d = Dot(a, b);
+    doNotOptimize(d);
+    doNotOptimize(a);
+  }
+}
+LAVACAKE_BENCHMARK(vec3Dot);
+
+static void mat4Multiply(benchmarkState& state) {
+  mat4 a = PrepareRotationMatrix(30.0f, vec3f({ 0.0f, 1.0f, 0.0f }));
+  mat4 b = PrepareTranslationMatrix(1.0f, 2.0f, 3.0f);
+  while (state.keepRunning()) {
+    mat4 c = a * b;
+    doNotOptimize(c);
+    doNotOptimize(a);
+  }
+}
+LAVACAKE_BENCHMARK(mat4Multiply);
+
+static void mat4VectorMultiply(benchmarkState& state) {
+  mat4 a = PrepareRotationMatrix(30.0f, vec3f({ 0.0f, 1.0f, 0.0f }));
+  vec4f v = vec4f({ 1.0f, 2.0f, 3.0f, 1.0f });
+  while (state.keepRunning()) {
+    vec4f r = a * v;
+    doNotOptimize(r);
+    doNotOptimize(v);
+  }
+}
+LAVACAKE_BENCHMARK(mat4VectorMultiply);
+
+static void vec3TransformPoint(benchmarkState& state) {
+  mat4 a = PrepareRotationMatrix(30.0f, vec3f({ 0.0f, 1.0f, 0.0f })) * PrepareTranslationMatrix(1.0f, 2.0f, 3.0f);
+  vec3f v = vec3f({ 1.0f, 2.0f, 3.0f });
+  while (state.keepRunning()) {
+    vec3f r = v * a;
+    doNotOptimize(r);
+    doNotOptimize(v);
+  }
+}
+LAVACAKE_BENCHMARK(vec3TransformPoint);
+
+static void mat4Inverse(benchmarkState& state) {
+  const mat4 a = PrepareRotationMatrix(30.0f, vec3f({ 0.0f, 1.0f, 0.0f })) * PrepareTranslationMatrix(1.0f, 2.0f, 3.0f);
+  while (state.keepRunning()) {
+    mat4 r = inverse(a);
+    doNotOptimize(r);
+    doNotOptimize(a);
+  }
+}
+LAVACAKE_BENCHMARK(mat4Inverse);
@@ -0,0 +1,64 @@
+#include "Barrier.h"
+#include <algorithm>
+
+namespace LavaCake {
+  namespace Framework {
+
+    void BarrierBatch::setAccess(Buffer& buffer, VkPipelineStageFlags dstStage, VkAccessFlags dstAccessMode, uint32_t dstQueueFamily) {
+      VkBuffer handle = buffer.getHandle();
+      if (std::any_of(m_bufferBarriers.begin(), m_bufferBarriers.end(), [handle](const VkBufferMemoryBarrier& b) { return b.buffer == handle; })) {
+        flush();
+      }
+
+      VkBufferMemoryBarrier barrier;
+      VkPipelineStageFlags srcStage;
+      if (!buffer.transition(dstStage, dstAccessMode, dstQueueFamily, barrier, srcStage)) {
+        m_elided++;
+        return;
+      }
+      m_bufferBarriers.push_back(barrier);
+      m_srcStage |= srcStage;
+      m_dstStage |= dstStage;
+    }
+
+    void BarrierBatch::setLayout(Image& image, VkImageLayout newLayout, VkPipelineStageFlags dstStage, VkImageSubresourceRange subresourceRange, VkAccessFlags dstAccess) {
+      VkImage handle = image.getHandle();
+      if (std::any_of(m_imageBarriers.begin(), m_imageBarriers.end(), [handle](const VkImageMemoryBarrier& b) { return b.image == handle; })) {
+        flush();
+      }
+
+      VkImageMemoryBarrier barrier;
+      VkPipelineStageFlags srcStage;
+      if (!image.transition(newLayout, dstStage, subresourceRange, dstAccess, barrier, srcStage)) {
+        m_elided++;
+        return;
+      }
+      m_imageBarriers.push_back(barrier);
+      m_srcStage |= srcStage;
+      m_dstStage |= dstStage;
+    }
+
+    void BarrierBatch::flush() {
+      uint32_t issued = static_cast<uint32_t>(m_bufferBarriers.size() + m_imageBarriers.size());
+      if (issued > 0) {
+        // the union of the stages waits at least for every transition of the batch
+        vkCmdPipelineBarrier(
+          m_commandBuffer.getHandle(),
+          m_srcStage,
+          m_dstStage != 0 ? m_dstStage : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+          0,
+          0, nullptr,
+          static_cast<uint32_t>(m_bufferBarriers.size()), m_bufferBarriers.data(),
+          static_cast<uint32_t>(m_imageBarriers.size()), m_imageBarriers.data());
+      }
+      m_commandBuffer.countBarriers(issued, m_elided);
+
+      m_bufferBarriers.clear();
+      m_imageBarriers.clear();
+      m_srcStage = 0;
+      m_dstStage = 0;
+      m_elided = 0;
+    }
+
+  }
+}
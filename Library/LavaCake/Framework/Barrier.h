@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Buffer.h"
+#include "Image.h"
+
+namespace LavaCake {
+  namespace Framework {
+
+    /**
+    \brief check if an access mask only contains read accesses
+    \param access : the access mask
+    \return true if the mask is not empty and contains no write access
+    */
+    inline bool isReadOnlyAccess(VkAccessFlags access) {
+      const VkAccessFlags reads =
+        VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+        VK_ACCESS_INDEX_READ_BIT |
+        VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+        VK_ACCESS_UNIFORM_READ_BIT |
+        VK_ACCESS_INPUT_ATTACHMENT_READ_BIT |
+        VK_ACCESS_SHADER_READ_BIT |
+        VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+        VK_ACCESS_TRANSFER_READ_BIT |
+        VK_ACCESS_HOST_READ_BIT |
+        VK_ACCESS_MEMORY_READ_BIT;
+      return access != 0 && (access & ~reads) == 0;
+    }
+
+    /**
+      Class BarrierBatch :
+      \brief Collect the access changes of buffers and the layout changes of images and record them in a single
+      vkCmdPipelineBarrier. Redundant transitions (reading again what is already readable) are dropped.
+      The state of the resources is updated when a transition is added, the barrier is recorded by flush or when the batch is destroyed.
+      A resource transitioned twice flushes the batch first, its second transition depends on the first one.
+    */
+    class BarrierBatch {
+    public:
+
+      /**
+        \brief create an empty batch
+        \param cmdBuff : the command buffer the barriers are recorded in, must be in a recording state until the batch is flushed
+      */
+      BarrierBatch(CommandBuffer& cmdBuff) : m_commandBuffer(cmdBuff) {};
+
+      BarrierBatch(const BarrierBatch&) = delete;
+      BarrierBatch& operator=(const BarrierBatch&) = delete;
+
+      /**
+        \brief add an access change of a buffer to the batch, see Buffer::setAccess
+        \param buffer : the buffer
+        \param dstStage : the new stage of the buffer
+        \param dstAccessMode : the new access mode of the buffer
+        \param dstQueueFamily : (optional) the new family queue of the buffer
+      */
+      void setAccess(Buffer& buffer, VkPipelineStageFlags dstStage, VkAccessFlags dstAccessMode, uint32_t dstQueueFamily = VK_QUEUE_FAMILY_IGNORED);
+
+      /**
+        \brief add a layout change of an image to the batch, see Image::setLayout
+        \param image : the image
+        \param newLayout : the new layout of the image
+        \param dstStage : the new stage flag
+        \param subresourceRange : the range of the memory that will be affected by the operation
+        \param dstAccess : (optional) the accesses of the new stage, deduced from the new layout when 0
+      */
+      void setLayout(Image& image, VkImageLayout newLayout, VkPipelineStageFlags dstStage, VkImageSubresourceRange subresourceRange, VkAccessFlags dstAccess = 0);
+
+      /**
+        \brief record the pending barriers in a single vkCmdPipelineBarrier, nothing is recorded if they were all redundant
+      */
+      void flush();
+
+      /**
+        \brief check if the batch has barriers waiting to be recorded
+      */
+      bool empty() const {
+        return m_bufferBarriers.empty() && m_imageBarriers.empty();
+      }
+
+      ~BarrierBatch() {
+        flush();
+      }
+
+    private:
+
+      CommandBuffer&                                            m_commandBuffer;
+      VkPipelineStageFlags                                      m_srcStage = 0;
+      VkPipelineStageFlags                                      m_dstStage = 0;
+      uint32_t                                                  m_elided = 0;
+      std::vector<VkBufferMemoryBarrier>                        m_bufferBarriers;
+      std::vector<VkImageMemoryBarrier>                         m_imageBarriers;
+    };
+
+  }
+}
@@ -1,4 +1,7 @@
 #include "Buffer.h"
+#include "Barrier.h"
+#include <LavaCake/Helpers/Trace.h>
+#include <algorithm>
 
 namespace LavaCake {
   namespace Framework {
@@ -10,6 +13,7 @@ namespace LavaCake {
       VkMemoryPropertyFlags memPropertyFlag, 
       VkPipelineStageFlags stageFlagBit, 
       VkFormat format) {
+      LAVACAKE_TRACE_ZONE("Buffer::Buffer");
 
       Device* d = Device::getDevice();
       VkPhysicalDevice physical = d->getPhysicalDevice();
@@ -20,6 +24,7 @@ namespace LavaCake {
       vkGetPhysicalDeviceProperties(physical, &p);
 
       m_padding = p.limits.nonCoherentAtomSize - m_dataSize % p.limits.nonCoherentAtomSize;
+      m_atomSize = p.limits.nonCoherentAtomSize;
 
       m_stage = stageFlagBit;
       m_access = VkAccessFlagBits(0);
@@ -40,8 +45,10 @@ namespace LavaCake {
       }
 
       if (VK_NULL_HANDLE != m_bufferMemory) {
+        MemoryBudget::releaseAllocation(m_bufferMemory);
         vkFreeMemory(logical, m_bufferMemory, nullptr);
         m_bufferMemory = VK_NULL_HANDLE;
+        FrameStatistics::add(COUNTER_FREES);
       }
 
 
@@ -90,6 +97,10 @@ namespace LavaCake {
 
           result = vkAllocateMemory(logical, &buffer_memory_allocate_info, nullptr, &m_bufferMemory);
           if (VK_SUCCESS == result) {
+            FrameStatistics::add(COUNTER_ALLOCATIONS);
+            MemoryBudget::registerAllocation(m_bufferMemory, memory_requirements.size, physical_device_memory_properties.memoryTypes[type].heapIndex,
+              MemoryBudget::bufferCategory(usage, memPropertyFlag));
+            m_memoryFlags = physical_device_memory_properties.memoryTypes[type].propertyFlags;
             break;
           }
         }
@@ -104,6 +115,8 @@ namespace LavaCake {
         ErrorCheck::setError("Could not bind memory object to a buffer.");
       }
 
+      mapPersistently();
+
       if (usage & VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT) {
         VkBufferViewCreateInfo buffer_view_create_info = {
         VK_STRUCTURE_TYPE_BUFFER_VIEW_CREATE_INFO,    // VkStructureType            sType
@@ -129,33 +142,56 @@ namespace LavaCake {
       VkAccessFlags dstAccessMode, 
       uint32_t dstQueueFamily) {
 
-      VkBufferMemoryBarrier bufferMemoryBarrier{};
-      bufferMemoryBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-      bufferMemoryBarrier.buffer = m_buffer;
-      bufferMemoryBarrier.srcAccessMask = m_access;
-      bufferMemoryBarrier.dstAccessMask = dstAccessMode;
+      VkBufferMemoryBarrier bufferMemoryBarrier;
+      VkPipelineStageFlags srcStage;
+      if (!transition(dstStage, dstAccessMode, dstQueueFamily, bufferMemoryBarrier, srcStage)) {
+        cmdBuff.countBarriers(0, 1);
+        return;
+      }
+
+      vkCmdPipelineBarrier(cmdBuff.getHandle(), srcStage, dstStage, 0, 0, nullptr, 1, &bufferMemoryBarrier, 0, nullptr);
+      cmdBuff.countBarriers(1, 0);
+    }
+
+    bool Buffer::transition(
+      VkPipelineStageFlags dstStage,
+      VkAccessFlags dstAccessMode,
+      uint32_t dstQueueFamily,
+      VkBufferMemoryBarrier& barrier,
+      VkPipelineStageFlags& srcStage) {
+
+      // reading again what has already been made visible needs no barrier, the state is left as is
+      bool sameQueue = dstQueueFamily == VK_QUEUE_FAMILY_IGNORED || dstQueueFamily == m_queueFamily;
+      if (sameQueue && isReadOnlyAccess(m_access) && isReadOnlyAccess(dstAccessMode) &&
+        (dstStage & ~m_stage) == 0 && (dstAccessMode & ~m_access) == 0) {
+        return false;
+      }
+
+      barrier = {};
+      barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+      barrier.buffer = m_buffer;
+      barrier.srcAccessMask = m_access;
+      barrier.dstAccessMask = dstAccessMode;
 
       if (dstQueueFamily == VK_QUEUE_FAMILY_IGNORED) {
-        bufferMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
       }
       else {
-        bufferMemoryBarrier.srcQueueFamilyIndex = m_queueFamily;
+        barrier.srcQueueFamilyIndex = m_queueFamily;
       }
 
-      bufferMemoryBarrier.dstQueueFamilyIndex = dstQueueFamily;
-      bufferMemoryBarrier.offset = 0;
-      bufferMemoryBarrier.size = VK_WHOLE_SIZE;
-
-
-      vkCmdPipelineBarrier(cmdBuff.getHandle(), m_stage, dstStage, 0, 0, nullptr, 1, &bufferMemoryBarrier, 0, nullptr);
+      barrier.dstQueueFamilyIndex = dstQueueFamily;
+      barrier.offset = 0;
+      barrier.size = VK_WHOLE_SIZE;
 
+      srcStage = m_stage != 0 ? m_stage : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
 
       m_stage = dstStage;
       if (dstQueueFamily != VK_QUEUE_FAMILY_IGNORED) {
         m_queueFamily = dstQueueFamily;
       }
       m_access = dstAccessMode;
-
+      return true;
     }
 
     const VkBuffer& Buffer::getHandle()  const {
@@ -194,23 +230,85 @@ namespace LavaCake {
       return m_bufferMemory;
     }
 
+    void Buffer::mapPersistently() {
+      if (m_bufferMemory == VK_NULL_HANDLE || !(m_memoryFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) {
+        return;
+      }
+      Device* d = Device::getDevice();
+      VkDevice logical = d->getLogicalDevice();
+      // freeing the memory implicitly unmaps it
+      VkResult result = vkMapMemory(logical, m_bufferMemory, 0, VK_WHOLE_SIZE, 0, &m_mapped);
+      if (VK_SUCCESS != result) {
+        m_mapped = nullptr;
+        ErrorCheck::setError("Could not map memory object.");
+      }
+    }
+
     void* Buffer::map() {
+      if (m_mapped != nullptr) {
+        return m_mapped;
+      }
       Device* d = Device::getDevice();
       VkDevice logical = d->getLogicalDevice();
       VkResult result = vkMapMemory(logical, m_bufferMemory, 0, m_dataSize + m_padding, 0, &m_mapped);
 
       if (VK_SUCCESS != result) {
-        //std::cout << "Could not map memory object." << std::endl;
-        //return false;
+        ErrorCheck::setError("Could not map memory object.");
+        m_mapped = nullptr;
       }
 
       return m_mapped;
     }
 
     void Buffer::unmap() {
-      Device* d = Device::getDevice();
-      VkDevice logical = d->getLogicalDevice();
-      vkUnmapMemory(logical, m_bufferMemory);
+      // host visible buffers stay mapped for their whole lifetime
+    }
+
+    void Buffer::flush(uint64_t offset, uint64_t size) {
+      VkMappedMemoryRange memory_range;
+      if (isCoherent() || !mappedRange(offset, size, memory_range)) {
+        return;
+      }
+      VkResult result = vkFlushMappedMemoryRanges(Device::getDevice()->getLogicalDevice(), 1, &memory_range);
+      if (VK_SUCCESS != result) {
+        ErrorCheck::setError("Could not flush mapped memory.");
+      }
+    }
+
+    void Buffer::invalidate(uint64_t offset, uint64_t size) {
+      VkMappedMemoryRange memory_range;
+      if (isCoherent() || !mappedRange(offset, size, memory_range)) {
+        return;
+      }
+      VkResult result = vkInvalidateMappedMemoryRanges(Device::getDevice()->getLogicalDevice(), 1, &memory_range);
+      if (VK_SUCCESS != result) {
+        ErrorCheck::setError("Could not invalidate mapped memory.");
+      }
+    }
+
+    bool Buffer::mappedRange(uint64_t offset, uint64_t size, VkMappedMemoryRange& range) const {
+      if (m_mapped == nullptr) {
+        return false;
+      }
+
+      // flushed ranges must start and end on a multiple of the non coherent atom size, the buffer size already is one
+      uint64_t begin = offset / m_atomSize * m_atomSize;
+      uint64_t end = m_dataSize + m_padding;
+      if (size != VK_WHOLE_SIZE) {
+        end = std::min(end, (offset + size + m_atomSize - 1) / m_atomSize * m_atomSize);
+      }
+      if (begin >= end) {
+        return false;
+      }
+
+      range = {
+        VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,  // VkStructureType    sType
+        nullptr,                                // const void       * pNext
+        m_bufferMemory,                         // VkDeviceMemory     memory
+        begin,                                  // VkDeviceSize       offset
+        end - begin                             // VkDeviceSize       size
+      };
+      return true;
     }
 
     uint64_t Buffer::getBufferDeviceAddress() const
@@ -3,6 +3,8 @@
 #include "CommandBuffer.h"
 #include "Queue.h"
 #include "Image.h"
+#include "MemoryBudget.h"
+#include <LavaCake/Helpers/Trace.h>
 
 #include <span>
 
@@ -31,7 +33,9 @@ namespace LavaCake {
         m_queueFamily(std::exchange(b.m_queueFamily, 0)),
         m_dataSize(std::exchange(b.m_dataSize, 0)),
         m_padding(std::exchange(b.m_padding, 0)),
-        m_mapped(std::exchange(b.m_mapped, nullptr))
+        m_atomSize(std::exchange(b.m_atomSize, 1)),
+        m_mapped(std::exchange(b.m_mapped, nullptr)),
+        m_memoryFlags(std::exchange(b.m_memoryFlags, 0))
       {}
 
       Buffer& operator=(Buffer&& b) noexcept
@@ -46,7 +50,9 @@ namespace LavaCake {
           m_queueFamily = std::exchange(b.m_queueFamily, 0);
           m_dataSize = std::exchange(b.m_dataSize, 0);
           m_padding = std::exchange(b.m_padding, 0);
+          m_atomSize = std::exchange(b.m_atomSize, 1);
           m_mapped = std::exchange(b.m_mapped, nullptr);
+          m_memoryFlags = std::exchange(b.m_memoryFlags, 0);
         }
         return *this;
       }
@@ -73,6 +79,7 @@ namespace LavaCake {
         VkPipelineStageFlags stageFlag = VK_PIPELINE_STAGE_TRANSFER_BIT,
         VkFormat format = VK_FORMAT_R32_SFLOAT,
         VkAccessFlags accessmod = VK_ACCESS_TRANSFER_WRITE_BIT) {
+        LAVACAKE_TRACE_ZONE("Buffer::Buffer");
 
         Device* d = Device::getDevice();
         VkPhysicalDevice physical = d->getPhysicalDevice();
@@ -83,6 +90,7 @@ namespace LavaCake {
         vkGetPhysicalDeviceProperties(physical, &p);
 
         m_padding = p.limits.nonCoherentAtomSize - m_dataSize % p.limits.nonCoherentAtomSize;
+        m_atomSize = p.limits.nonCoherentAtomSize;
 
         m_stage = stageFlag;
         m_access = accessmod;
@@ -104,8 +112,10 @@ namespace LavaCake {
         }
 
         if (VK_NULL_HANDLE != m_bufferMemory) {
+          MemoryBudget::releaseAllocation(m_bufferMemory);
           vkFreeMemory(logical, m_bufferMemory, nullptr);
           m_bufferMemory = VK_NULL_HANDLE;
+          FrameStatistics::add(COUNTER_FREES);
         }
 
 
@@ -154,6 +164,10 @@ namespace LavaCake {
 
             result = vkAllocateMemory(logical, &buffer_memory_allocate_info, nullptr, &m_bufferMemory);
             if (VK_SUCCESS == result) {
+              FrameStatistics::add(COUNTER_ALLOCATIONS);
+              MemoryBudget::registerAllocation(m_bufferMemory, memory_requirements.size, physical_device_memory_properties.memoryTypes[type].heapIndex,
+                MemoryBudget::bufferCategory(usage, memPropertyFlag));
+              m_memoryFlags = physical_device_memory_properties.memoryTypes[type].propertyFlags;
               break;
             }
           }
@@ -168,6 +182,8 @@ namespace LavaCake {
           ErrorCheck::setError("Could not bind memory object to a buffer.");
         }
 
+        mapPersistently();
+
         if (usage & VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT) {
           VkBufferViewCreateInfo buffer_view_create_info = {
             VK_STRUCTURE_TYPE_BUFFER_VIEW_CREATE_INFO,    // VkStructureType            sType
@@ -238,6 +254,22 @@ namespace LavaCake {
         VkAccessFlags dstAccessMode,
         uint32_t dstQueueFamily = VK_QUEUE_FAMILY_IGNORED);
 
+      /**
+      \brief Compute the barrier changing the acces mode of the buffer and update its state, nothing is recorded, see BarrierBatch
+      \param dstStage : the new stage of the buffer
+      \param dstAccessMode : the new access mode of the buffer
+      \param dstQueueFamily : the new family queue of the buffer, VK_QUEUE_FAMILY_IGNORED to remain on the same family queue
+      \param barrier : filled with the barrier to record
+      \param srcStage : filled with the stage the barrier must wait for
+      \return false if the buffer is already readable in this stage and access mode and no barrier is needed
+      */
+      bool transition(
+        VkPipelineStageFlags dstStage,
+        VkAccessFlags dstAccessMode,
+        uint32_t dstQueueFamily,
+        VkBufferMemoryBarrier& barrier,
+        VkPipelineStageFlags& srcStage);
+
       /**
       \brief Return the handle of the buffer
       \return a const ref to a VkBuffer
@@ -302,16 +334,56 @@ namespace LavaCake {
 
 
       /**
-      \brief Map the buffer memory to a pointer
+      \brief Map the buffer memory to a pointer, host visible buffers stay mapped for their whole lifetime so this only returns the mapping
       \return a void* pointer to mapped memory
       */
       void* map();
 
       /**
-      \brief Unmap the buffer memory
+      \brief Unmap the buffer memory, does nothing for host visible buffers which stay mapped until they are destroyed
       */
       void unmap();
 
+      /**
+      \brief Make host writes to a range of the mapped memory visible to the device, the range is extended to the non coherent atom size.
+      Nothing is done if the memory is host coherent.
+      \param offset : the beginning of the range in bytes
+      \param size : the size of the range in bytes, VK_WHOLE_SIZE to flush up to the end of the buffer
+      */
+      void flush(uint64_t offset = 0, uint64_t size = VK_WHOLE_SIZE);
+
+      /**
+      \brief Make device writes to a range of the mapped memory visible to the host, the range is extended to the non coherent atom size.
+      Nothing is done if the memory is host coherent.
+      \param offset : the beginning of the range in bytes
+      \param size : the size of the range in bytes, VK_WHOLE_SIZE to invalidate up to the end of the buffer
+      */
+      void invalidate(uint64_t offset = 0, uint64_t size = VK_WHOLE_SIZE);
+
+      /**
+      \brief check if the memory of the buffer is host coherent, in which case flush and invalidate are not needed
+      */
+      bool isCoherent() const {
+        return (m_memoryFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+      }
+
+      /**
+      \brief Write a span of data in the buffer at an offset and flush only the written range,
+      the buffer must be host visible for this operation to succeed
+      \param data the data to write
+      \param offset the offset in bytes where the data is written
+      */
+      template <typename t, std::size_t extent>
+      void write(std::span<t, extent> data, uint64_t offset = 0) {
+        if (m_mapped == nullptr || offset + data.size_bytes() > m_dataSize + m_padding) [[unlikely]] {
+          ErrorCheck::setError("The buffer is not host visible or the data does not fit in it");
+          return;
+        }
+        std::memcpy(static_cast<std::byte*>(m_mapped) + offset, data.data(), data.size_bytes());
+        flush(offset, data.size_bytes());
+        FrameStatistics::add(COUNTER_UPLOADED_BYTES, data.size_bytes());
+      }
+
       /**
       \brief Read  back the data contained in a buffer and return it in a vector
       \param queue : a const ref to the queue that will be used to copy data to the Buffer
@@ -343,6 +415,7 @@ namespace LavaCake {
         cmdBuff.wait(UINT32_MAX);
         cmdBuff.resetFence();
         void* local_pointer = stagingBuffer.map();
+        stagingBuffer.invalidate(0, m_dataSize);
 
         std::memcpy(&data[0], local_pointer, static_cast<size_t>(m_dataSize));
 
@@ -362,29 +435,7 @@ namespace LavaCake {
       */
       template <typename t>
       void write(const std::vector<t>& data) {
-        Device* d = Device::getDevice();
-        VkDevice logical = d->getLogicalDevice();
-
-        m_mapped = map();
-
-        std::memcpy(m_mapped, &data[0], sizeof(t) * static_cast<size_t>(data.size()));
-
-        std::vector<VkMappedMemoryRange> memory_ranges = {
-          {
-            VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,  // VkStructureType    sType
-            nullptr,                                // const void       * pNext
-            m_bufferMemory,													// VkDeviceMemory     memory
-            0,																			// VkDeviceSize       offset
-            VK_WHOLE_SIZE                           // VkDeviceSize       size
-          }
-        };
-
-        VkResult result = vkFlushMappedMemoryRanges(logical, static_cast<uint32_t>(memory_ranges.size()), memory_ranges.data());
-        if (VK_SUCCESS != result) {
-          std::cout << "Could not flush mapped memory." << std::endl;
-        }
-
-        unmap();
+        write(std::span<const t>(data));
       }
 
       ~Buffer() {
@@ -401,8 +452,10 @@ namespace LavaCake {
         }
 
         if (VK_NULL_HANDLE != m_bufferMemory) {
+          MemoryBudget::releaseAllocation(m_bufferMemory);
           vkFreeMemory(logical, m_bufferMemory, nullptr);
           m_bufferMemory = VK_NULL_HANDLE;
+          FrameStatistics::add(COUNTER_FREES);
         }
       }
 
@@ -420,6 +473,10 @@ namespace LavaCake {
 
     protected:
 
+      void mapPersistently();
+
+      bool mappedRange(uint64_t offset, uint64_t size, VkMappedMemoryRange& range) const;
+
       VkBuffer	                                                                    m_buffer = VK_NULL_HANDLE;
       VkDeviceMemory                                                                m_bufferMemory = VK_NULL_HANDLE;
       VkBufferView                                                                  m_bufferView = VK_NULL_HANDLE;
@@ -430,8 +487,10 @@ namespace LavaCake {
       uint32_t                                                                      m_queueFamily;
       uint64_t                                                                      m_dataSize = 0;
       uint64_t                                                                      m_padding = 0;
+      uint64_t                                                                      m_atomSize = 1;
 
       void* m_mapped = nullptr;
+      VkMemoryPropertyFlags                                                         m_memoryFlags = 0;
 
 
     };
@@ -4,29 +4,128 @@
 #include <map>
 #include <string>
 #include <span>
+#include <array>
 #include <cstring>
+#include <type_traits>
+#include <algorithm>
 
 #include "ErrorCheck.h"
 
 namespace LavaCake {
   namespace Framework {
+
+    /**
+    \brief the rules used to place the variables of a ByteDictionary.
+    */
+    enum blockLayout {
+      PACKED,       /*!< variables are stored back to back without any alignment */
+      STD140,       /*!< the GLSL std140 rules, used by uniform blocks */
+      STD430        /*!< the GLSL std430 rules, used by storage blocks and push constants */
+    };
+
+    /**
+    \brief the placement of a variable in a ByteDictionary.
+    A variable is made of count elements, each element is made of columns columns (several for matrices) that are
+    contiguous in the source data and may be padded in the dictionary.
+    */
+    struct variableLayout {
+      uint32_t offset = 0;          /*!< the offset of the first element in the dictionary */
+      uint32_t count = 0;           /*!< the number of elements */
+      uint32_t elementSize = 0;     /*!< the size of an element in the source data */
+      uint32_t elementStride = 0;   /*!< the distance between two elements in the dictionary */
+      uint32_t columns = 1;         /*!< the number of columns of an element */
+      uint32_t columnSize = 0;      /*!< the size of a column in the source data */
+      uint32_t columnStride = 0;    /*!< the distance between two columns in the dictionary */
+    };
+
+    /**
+    \brief a typed token to a variable of a ByteDictionary, setting a variable through its handle skips the name lookup.
+    \tparam T: the type of an element of the variable
+    */
+    template<typename T>
+    struct variableHandle {
+      variableLayout layout;
+
+      /**
+      \brief check if the handle refers to a variable, it is not the case if the variable could not be added
+      */
+      bool valid() const { return layout.count > 0; }
+    };
+
+    /**
+    \brief describe how a type is laid out in a GLSL block.
+    Arithmetic types are scalars, std::array of 2, 3 or 4 scalars are vectors, std::array of 9 and 16 scalars are
+    column major 3x3 and 4x4 matrices, every other type is treated as a structure copied as a whole.
+    */
+    template<typename T, typename = void>
+    struct glslType {
+      static constexpr bool     structure = true;
+      static constexpr uint32_t alignment = alignof(T);
+      static constexpr uint32_t size = sizeof(T);
+      static constexpr uint32_t columns = 1;
+      static constexpr uint32_t columnSize = sizeof(T);
+    };
+
+    template<typename T>
+    struct glslType<T, std::enable_if_t<std::is_arithmetic_v<T>>> {
+      static_assert(!std::is_same_v<T, bool>, "bool has no fixed size in GLSL blocks, use uint32_t instead");
+      static constexpr bool     structure = false;
+      static constexpr uint32_t alignment = sizeof(T);
+      static constexpr uint32_t size = sizeof(T);
+      static constexpr uint32_t columns = 1;
+      static constexpr uint32_t columnSize = sizeof(T);
+    };
+
+    template<typename T, std::size_t N>
+    struct glslType<std::array<T, N>, std::enable_if_t<std::is_arithmetic_v<T> && (N == 2 || N == 3 || N == 4)>> {
+      static constexpr bool     structure = false;
+      static constexpr uint32_t alignment = uint32_t(N == 2 ? 2 : 4) * sizeof(T);
+      static constexpr uint32_t size = uint32_t(N * sizeof(T));
+      static constexpr uint32_t columns = 1;
+      static constexpr uint32_t columnSize = uint32_t(N * sizeof(T));
+    };
+
+    template<typename T, std::size_t N>
+    struct glslType<std::array<T, N>, std::enable_if_t<std::is_arithmetic_v<T> && (N == 9 || N == 16)>> {
+      // a matrix is an array of column vectors, each column is aligned as a vec4
+      static constexpr bool     structure = false;
+      static constexpr uint32_t alignment = 4 * sizeof(T);
+      static constexpr uint32_t columns = N == 9 ? 3 : 4;
+      static constexpr uint32_t size = columns * alignment;
+      static constexpr uint32_t columnSize = columns * sizeof(T);
+    };
+
     /**
     \brief help manage Byte dictionary mainly used in UniformBuffers and PushConstant.
     This class is mainly a dictionary of variable of different type that are agregated together as byte.
     */
     class ByteDictionary {
     public:
+
+      /**
+      \brief create an empty dictionary
+      \param layout: the rules used to place the variables, the default packs them without alignment
+      */
+      ByteDictionary(blockLayout layout = PACKED) : m_layout(layout) {};
+
       ~ByteDictionary() = default;
 
       const std::vector<std::byte>& data() const { return m_data; };
 
+      /**
+      \brief get the rules used to place the variables
+      */
+      blockLayout layout() const { return m_layout; };
+
       /**
       \brief Add a span of value into the dictionary.
+      A span of static extent 1 is a single variable, any other span is an array.
       \param name: the name of constant.
       \param data: the span of value.
+      \return a handle to the variable, invalid if the name was already used
       */
       template<typename T, std::size_t TExtent = std::dynamic_extent>
-      void addVariableRange(const std::string& name, const std::span<const T, TExtent> data);
+      variableHandle<std::remove_const_t<T>> addVariableRange(const std::string& name, const std::span<const T, TExtent> data);
 
       /**
       \brief set a span of value into the dictionary
@@ -36,44 +135,194 @@ namespace LavaCake {
       template<typename T, std::size_t TExtent = std::dynamic_extent>
       void setVariableRange(const std::string& name, const std::span<T, TExtent> data);
 
+      /**
+      \brief set a span of value into the dictionary without looking up its name
+      \param variable : the handle returned when the variable was added
+      \param data: the span of value, it must have as many elements as the variable
+      */
+      template<typename T, std::size_t TExtent = std::dynamic_extent>
+      void setVariableRange(const variableHandle<std::remove_const_t<T>>& variable, const std::span<T, TExtent> data);
+
+      /**
+      \brief get the placement of a variable
+      \param name : the name of constant
+      \return the placement of the variable, with a count of 0 if it does not exist
+      */
+      variableLayout getVariableLayout(const std::string& name) const {
+        if (auto it = m_variableNames.find(name); it != m_variableNames.end()) {
+          return it->second;
+        }
+        return variableLayout();
+      }
+
+      /**
+      \brief get the byte ranges written since the last call to clearDirtyRanges, sorted and merged
+      \param maxGap: ranges separated by at most maxGap untouched bytes are merged together
+      \return a list of ranges as pairs of offset and size in bytes
+      */
+      std::vector<std::pair<uint32_t, uint32_t>> dirtyRanges(uint32_t maxGap = 0) const {
+        std::vector<std::pair<uint32_t, uint32_t>> ranges(m_dirty);
+        std::sort(ranges.begin(), ranges.end());
+        std::vector<std::pair<uint32_t, uint32_t>> merged;
+        for (auto [begin, end] : ranges) {
+          if (!merged.empty() && begin <= merged.back().second + maxGap) {
+            merged.back().second = std::max(merged.back().second, end);
+          }
+          else {
+            merged.push_back({ begin, end });
+          }
+        }
+        for (auto& range : merged) {
+          range.second -= range.first;
+        }
+        return merged;
+      }
+
+      /**
+      \brief check if a variable was written since the last call to clearDirtyRanges
+      */
+      bool isDirty() const { return !m_dirty.empty(); };
+
+      /**
+      \brief forget the written ranges, to be called once they have been sent to the device
+      */
+      void clearDirtyRanges() { m_dirty.clear(); };
+
+      /**
+      \brief mark the whole dictionary as written, for instance when the memory it is sent to is recreated
+      */
+      void setAllDirty() {
+        m_dirty.clear();
+        if (!m_data.empty()) {
+          m_dirty.push_back({ 0, (uint32_t)m_data.size() });
+        }
+      };
 
     private:
-      std::map<std::string, std::pair<uint32_t, uint32_t>>       m_variableNames; // maybe use a struct to name attribute ?
+
+      static constexpr size_t maxDirtyRanges = 64;
+
+      void markDirty(uint32_t begin, uint32_t end) {
+        if (!m_dirty.empty() && begin <= m_dirty.back().second && end >= m_dirty.back().first) {
+          m_dirty.back().first = std::min(m_dirty.back().first, begin);
+          m_dirty.back().second = std::max(m_dirty.back().second, end);
+          return;
+        }
+        m_dirty.push_back({ begin, end });
+        // past a point tracking every range costs more than copying the bytes in between
+        if (m_dirty.size() > maxDirtyRanges) {
+          std::pair<uint32_t, uint32_t> all = m_dirty.front();
+          for (auto& range : m_dirty) {
+            all.first = std::min(all.first, range.first);
+            all.second = std::max(all.second, range.second);
+          }
+          m_dirty = { all };
+        }
+      }
+
+      static uint32_t roundUp(uint32_t value, uint32_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+      }
+
+      template<typename T>
+      variableLayout place(uint32_t count, bool array);
+
+      void write(const variableLayout& variable, const std::byte* source) {
+        if (variable.count == 0) {
+          return;
+        }
+        std::byte* destination = m_data.data() + variable.offset;
+        markDirty(variable.offset, variable.offset + (variable.count - 1) * variable.elementStride + (variable.columns - 1) * variable.columnStride + variable.columnSize);
+        if ((variable.count == 1 || variable.elementStride == variable.elementSize) && variable.columnStride == variable.columnSize) [[likely]] {
+          std::memcpy(destination, source, size_t(variable.count) * variable.elementSize);
+          return;
+        }
+        for (uint32_t e = 0; e < variable.count; e++) {
+          for (uint32_t c = 0; c < variable.columns; c++) {
+            std::memcpy(destination + e * variable.elementStride + c * variable.columnStride, source + e * variable.elementSize + c * variable.columnSize, variable.columnSize);
+          }
+        }
+      }
+
+      blockLayout                                               m_layout;
+      std::map<std::string, variableLayout>                     m_variableNames;
       std::vector<std::byte>                                    m_data;
+      std::vector<std::pair<uint32_t, uint32_t>>                m_dirty;
     };
 
+    template<typename T>
+    variableLayout ByteDictionary::place(uint32_t count, bool array) {
+      using type = glslType<T>;
+      variableLayout variable;
+      variable.count = count;
+      variable.elementSize = sizeof(T);
+      variable.columns = type::columns;
+      variable.columnSize = type::columnSize;
+
+      if (m_layout == PACKED) {
+        variable.offset = (uint32_t)m_data.size();
+        variable.elementStride = variable.elementSize;
+        variable.columnStride = variable.columnSize;
+        return variable;
+      }
+
+      variable.columnStride = type::columns > 1 ? type::alignment : type::columnSize;
+      uint32_t alignment = type::alignment;
+      // std140 rounds the alignment of arrays and structures up to the one of a vec4
+      if (m_layout == STD140 && (array || type::structure)) {
+        alignment = roundUp(alignment, 16);
+      }
+      variable.elementStride = roundUp(type::size, alignment);
+      variable.offset = roundUp((uint32_t)m_data.size(), alignment);
+      return variable;
+    }
+
     template<typename T, std::size_t TExtent>
-    void ByteDictionary::addVariableRange(const std::string& name, const std::span<const T, TExtent> data) {
-      uint32_t offset_data = (uint32_t)m_data.size();
-      auto [it, inserted] = m_variableNames.try_emplace(std::string(name), offset_data, data.size_bytes());
-      if (!inserted) [[unlikely]] {
+    variableHandle<std::remove_const_t<T>> ByteDictionary::addVariableRange(const std::string& name, const std::span<const T, TExtent> data) {
+      using type = std::remove_const_t<T>;
+      variableHandle<type> handle;
+      if (m_variableNames.find(name) != m_variableNames.end()) [[unlikely]] {
         ErrorCheck::setError("The variable allready exist in this UniformBuffer",1);
-        return;
+        return handle;
       }
 
-      m_data.resize(offset_data + data.size_bytes());
-      std::memcpy(m_data.data() + offset_data, data.data(), data.size_bytes());
+      handle.layout = place<type>((uint32_t)data.size(), TExtent != 1);
+      m_variableNames.emplace(name, handle.layout);
+
+      // a single scalar, vector or matrix only takes its own size, the member following an array or a structure
+      // starts after the padding of its last element
+      bool array = TExtent != 1 || glslType<type>::structure;
+      uint32_t end = handle.layout.offset + (m_layout == PACKED || array ? handle.layout.count * handle.layout.elementStride : glslType<type>::size);
+      m_data.resize(end);
+      write(handle.layout, reinterpret_cast<const std::byte*>(data.data()));
+      return handle;
     }
 
     template<typename T, std::size_t TExtent>
     void ByteDictionary::setVariableRange(const std::string& name, const std::span<T, TExtent> data) {
       if (auto it = m_variableNames.find(name); it != m_variableNames.end()) [[likely]] {
-        auto [offset_data, size_data] = it->second;
-        if (size_data != data.size_bytes()) [[unlikely]] {
+        const variableLayout& variable = it->second;
+        if (size_t(variable.count) * variable.elementSize != data.size_bytes()) [[unlikely]] {
           ErrorCheck::setError("The new value does not match the type of the one currently stored in this UniformBuffer",1);
           return;
         }
 
-        std::memcpy(m_data.data() + offset_data, data.data(), data.size_bytes());
-
-        //if (m_modified.size() > 0) {
-        //  m_modified[i] = true;
-        //}
+        write(variable, reinterpret_cast<const std::byte*>(data.data()));
         return;
       }
       ErrorCheck::setError("The variable does not exist in this UniformBuffer", 1);
     }
 
+    template<typename T, std::size_t TExtent>
+    void ByteDictionary::setVariableRange(const variableHandle<std::remove_const_t<T>>& variable, const std::span<T, TExtent> data) {
+      const variableLayout& layout = variable.layout;
+      if (layout.count == 0 || layout.count != data.size() ||
+        layout.offset + (layout.count - 1) * layout.elementStride + (layout.columns - 1) * layout.columnStride + layout.columnSize > m_data.size()) [[unlikely]] {
+        ErrorCheck::setError("The variable handle does not match the value or this UniformBuffer",1);
+        return;
+      }
+      write(layout, reinterpret_cast<const std::byte*>(data.data()));
+    }
 
   }
 }
@@ -3,6 +3,7 @@
 #include "AllHeaders.h"
 #include "Device.h"
 #include "ErrorCheck.h"
+#include "FrameStatistics.h"
 #include <cassert>
 
 namespace LavaCake {
@@ -86,6 +87,15 @@ namespace LavaCake {
       VkPipelineStageFlags  waitingStage;
     };
 
+    /**
+    \brief the barriers recorded in a command buffer since its last beginRecord
+    */
+    struct barrierStatistics {
+      uint32_t      pipelineBarriers = 0;     /*!< the number of vkCmdPipelineBarrier calls */
+      uint32_t      issued = 0;               /*!< the number of buffer and image barriers recorded */
+      uint32_t      elided = 0;               /*!< the number of transitions dropped because they were redundant */
+    };
+
     /**
     Class CommandBuffer :
     \brief Helps manage VkCommandBuffer and their synchornisation
@@ -174,6 +184,7 @@ namespace LavaCake {
         if (VK_SUCCESS != result) {
           ErrorCheck::setError("Could not begin command buffer recording operation.");
         }
+        m_barrierStatistics = {};
       }
 
       /**
@@ -241,6 +252,7 @@ namespace LavaCake {
           return;
         }
         m_submitted = true;
+        FrameStatistics::add(COUNTER_SUBMITS);
       }
 
 
@@ -257,6 +269,28 @@ namespace LavaCake {
         return false;
       }
 
+      /**
+      \brief Count the barriers recorded in the command buffer, called by the functions recording pipeline barriers
+      \param issued : the number of buffer and image barriers recorded by one vkCmdPipelineBarrier call, 0 if no call was made
+      \param elided : the number of redundant transitions that were dropped
+      */
+      void countBarriers(uint32_t issued, uint32_t elided) {
+        if (issued > 0) {
+          m_barrierStatistics.pipelineBarriers++;
+        }
+        m_barrierStatistics.issued += issued;
+        m_barrierStatistics.elided += elided;
+        FrameStatistics::add(COUNTER_BARRIERS, issued);
+      }
+
+      /**
+      \brief Returns the number of barriers issued and elided since the command buffer started recording
+      \return the barrier statistics of the command buffer
+      */
+      const barrierStatistics& getBarrierStatistics() const {
+        return m_barrierStatistics;
+      }
+
       ~CommandBuffer() {
 
         Device* d = Device::getDevice();
@@ -277,6 +311,7 @@ namespace LavaCake {
       VkFence                                   m_fence = VK_NULL_HANDLE;
 
       bool                                      m_submitted = false;
+      barrierStatistics                         m_barrierStatistics;
     };
   }
 }
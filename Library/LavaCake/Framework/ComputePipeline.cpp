@@ -1,18 +1,36 @@
 #include "ComputePipeline.h"
+#include <LavaCake/Helpers/Trace.h>
 
 namespace LavaCake {
   namespace Framework {
 
     void ComputePipeline::compile() {
+      LAVACAKE_TRACE_ZONE("ComputePipeline::compile");
       Device* d = Device::getDevice();
       VkDevice logical = d->getLogicalDevice();
       generateDescriptorLayout();
-      if (!CreatePipelineLayout(logical, { m_descriptorSet->getLayout() }, {}, m_pipelineLayout)) {
+
+      std::vector<VkPushConstantRange> constantRanges;
+      if (m_pushConstant) {
+        m_pushConstantRange = {
+          VK_SHADER_STAGE_COMPUTE_BIT,                    // VkShaderStageFlags     stageFlags
+          0,                                              // uint32_t               offset
+          m_pushConstant->size()                          // uint32_t               size
+        };
+        constantRanges.push_back(m_pushConstantRange);
+      }
+
+      if (!CreatePipelineLayout(logical, { m_descriptorSet->getLayout() }, constantRanges, m_pipelineLayout)) {
         ErrorCheck::setError("Can't create compute pipeline layout");
       }
 
+      shaderStageParameters computeModule = m_computeModule;
+      if (!m_specialization.empty()) {
+        computeModule.specializationInfo = m_specialization.getInfo();
+      }
+
       std::vector<VkPipelineShaderStageCreateInfo> shader_stage_create_infos;
-      SpecifyPipelineShaderStages({ m_computeModule }, shader_stage_create_infos);
+      SpecifyPipelineShaderStages({ computeModule }, shader_stage_create_infos);
 
 
       VkComputePipelineCreateInfo compute_pipeline_create_info = {
@@ -35,17 +53,43 @@ namespace LavaCake {
       m_computeModule = module.getStageParameter();
     }
 
-    void ComputePipeline::compute(CommandBuffer& buffer, uint32_t dimX, uint32_t dimY, uint32_t dimZ) {
+    void ComputePipeline::setSpecializationConstants(const SpecializationConstants& constants) {
+      m_specialization = constants;
+    }
+
+    void ComputePipeline::setPushConstant(std::shared_ptr<PushConstant> constant) {
+      m_pushConstant = constant;
+    }
+
+    void ComputePipeline::setProfiler(std::shared_ptr<GPUProfiler> profiler, const std::string& name) {
+      m_profiler = profiler;
+      m_profilerName = name;
+    }
+
+    void ComputePipeline::compute(CommandBuffer& buffer, uint32_t dimX, uint32_t dimY, uint32_t dimZ, const std::vector<uint32_t>& dynamicOffsets) {
+      LAVACAKE_TRACE_ZONE("ComputePipeline::compute");
+      GPUScope scope(m_profiler.get(), buffer, m_profilerName);
 
       if (!m_descriptorSet->isEmpty()) {
+        if (dynamicOffsets.size() != m_descriptorSet->getDynamicBufferCount()) [[unlikely]] {
+          ErrorCheck::setError("The number of dynamic offsets does not match the dynamic buffers of the descriptor set");
+          return;
+        }
         vkCmdBindDescriptorSets(buffer.getHandle(), VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0,
           static_cast<uint32_t>(1), &m_descriptorSet->getHandle(),
-          0, {});
+          static_cast<uint32_t>(dynamicOffsets.size()), dynamicOffsets.data());
+        FrameStatistics::add(COUNTER_DESCRIPTOR_BINDS);
       }
 
       vkCmdBindPipeline(buffer.getHandle(), VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
 
+      if (m_pushConstant) {
+        m_pushConstant->push(buffer.getHandle(), m_pipelineLayout, m_pushConstantRange);
+      }
+
       vkCmdDispatch(buffer.getHandle(), dimX, dimY, dimZ);
+      FrameStatistics::add(COUNTER_PIPELINE_BINDS);
+      FrameStatistics::add(COUNTER_DISPATCHES);
 
     }
 
@@ -2,6 +2,7 @@
 
 #include "AllHeaders.h"
 #include "Pipeline.h"
+#include "GPUProfiler.h"
 
 namespace LavaCake {
   namespace Framework {
@@ -25,6 +26,25 @@ namespace LavaCake {
       */
       void setComputeModule(const ComputeShaderModule& module);
 
+      /**
+      \brief set the specialization constants of the compute shader, they override the specialization info given to the module
+      \param constants the values of the constants, copied by the pipeline
+      */
+      void setSpecializationConstants(const SpecializationConstants& constants);
+
+      /**
+      \brief set the push constant sent to the compute shader at each dispatch, its variables must be added before the pipeline is compiled
+      \param constant the push constant, its current values are pushed each time compute is called
+      */
+      void setPushConstant(std::shared_ptr<PushConstant> constant);
+
+      /**
+      \brief measure the GPU time of each call to compute in a scope of a profiler
+      \param profiler the profiler, nullptr to stop measuring
+      \param name (optional) the name of the scope
+      */
+      void setProfiler(std::shared_ptr<GPUProfiler> profiler, const std::string& name = "compute");
+
       /**
       \brief Compile the pipeline
       */
@@ -37,8 +57,9 @@ namespace LavaCake {
       \param dimX : the number of work group for X dimention
       \param dimY : the number of work group for Y dimention
       \param dimZ : the number of work group for Z dimention
+      \param dynamicOffsets : the offsets of the dynamic buffers of the descriptor set, in the order of their bindings
       */
-      void compute(CommandBuffer& cmdBuff, uint32_t dimX, uint32_t dimY, uint32_t dimZ);
+      void compute(CommandBuffer& cmdBuff, uint32_t dimX, uint32_t dimY, uint32_t dimZ, const std::vector<uint32_t>& dynamicOffsets = {});
 
       ~ComputePipeline() {
 
@@ -46,6 +67,11 @@ namespace LavaCake {
     private:
 
       shaderStageParameters																	m_computeModule;
+      SpecializationConstants                               m_specialization;
+      std::shared_ptr<PushConstant>                         m_pushConstant;
+      VkPushConstantRange                                   m_pushConstantRange = {};
+      std::shared_ptr<GPUProfiler>                          m_profiler;
+      std::string                                           m_profilerName;
 
     };
   }
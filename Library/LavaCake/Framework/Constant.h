@@ -16,6 +16,12 @@ namespace LavaCake {
     */
     class PushConstant {
     public:
+      /**
+      \brief create an empty PushConstant
+      \param layout: the rules used to place the variables, std430 by default as for push constant blocks in GLSL
+      */
+      PushConstant(blockLayout layout = STD430) : m_variables(layout) {};
+
       ~PushConstant() = default;
 
       /**
@@ -24,27 +30,33 @@ namespace LavaCake {
       \param value: the variable, either a simple data type of a contiguous range of simple data type.
       */
       template<typename T>
-      void addVariable(const std::string& name, const T& value) {
-        //    if constexpr(std::ranges::sized_range<T> && std::ranges::contiguous_range<T>) {
-        //      m_variables.addVariableRange(name, std::span { value });
-        //    } else {
-        m_variables.addVariableRange(name, std::span<const T, 1> { &value, 1 });
-        //    }
+      variableHandle<T> addVariable(const std::string& name, const T& value) {
+        return m_variables.addVariableRange(name, std::span<const T, 1> { &value, 1 });
       }
 
       template<typename T>
-      void addVariable(const std::string& name, const std::vector<T>& value) {
-        m_variables.addVariableRange(name, std::span{ value });
+      variableHandle<T> addVariable(const std::string& name, const std::vector<T>& value) {
+        return m_variables.addVariableRange(name, std::span<const T>{ value });
       }
 
+      /**
+      \brief Add a std::array into the dictionary, an array of 2, 3, 4, 9 or 16 scalars is a single vector or matrix variable.
+      \param name: the name of constant.
+      \param value: the variable.
+      */
       template<typename T, std::size_t N>
-      void addVariable(const std::string& name, const std::array<T, N>& value) {
-        m_variables.addVariableRange(name, std::span{ value });
+      auto addVariable(const std::string& name, const std::array<T, N>& value) {
+        if constexpr (std::is_arithmetic_v<T> && (N == 2 || N == 3 || N == 4 || N == 9 || N == 16)) {
+          return m_variables.addVariableRange(name, std::span<const std::array<T, N>, 1> { &value, 1 });
+        }
+        else {
+          return m_variables.addVariableRange(name, std::span<const T, N>{ value });
+        }
       }
 
       template<typename T, std::size_t Extent>
-      void addVariable(const std::string& name, const std::span<T, Extent>& value) {
-        m_variables.addVariableRange(name, std::span{ value });
+      variableHandle<std::remove_const_t<T>> addVariable(const std::string& name, const std::span<T, Extent>& value) {
+        return m_variables.addVariableRange(name, std::span<const T, Extent>{ value });
       }
 
       /**
@@ -54,11 +66,7 @@ namespace LavaCake {
       */
       template<typename T>
       void setVariable(const std::string& name, const T& value) {
-        //    if constexpr(std::ranges::sized_range<T> && std::ranges::contiguous_range<T>) {
-        //      m_variables.setVariableRange(name, std::span{ value });
-        //    } else {
         m_variables.setVariableRange(name, std::span<const T, 1>{ &value, 1 });
-        //    }
       }
 
       template<typename T>
@@ -76,6 +84,26 @@ namespace LavaCake {
         m_variables.setVariableRange(name, std::span{ value });
       }
 
+      /**
+      \brief set a variable through the handle returned by addVariable, without any name lookup.
+      \param variable : the handle of the variable
+      \param value: the new value of the variable
+      */
+      template<typename T>
+      void setVariable(const variableHandle<T>& variable, const T& value) {
+        m_variables.setVariableRange(variable, std::span<const T, 1>{ &value, 1 });
+      }
+
+      template<typename T>
+      void setVariable(const variableHandle<T>& variable, const std::vector<T>& value) {
+        m_variables.setVariableRange(variable, std::span<const T>{ value });
+      }
+
+      template<typename T, std::size_t Extent>
+      void setVariable(const variableHandle<std::remove_const_t<T>>& variable, const std::span<T, Extent>& value) {
+        m_variables.setVariableRange(variable, value);
+      }
+
       void push(VkCommandBuffer buffer, VkPipelineLayout layout, VkPushConstantRange range);
 
       uint32_t size();
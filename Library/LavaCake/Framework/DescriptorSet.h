@@ -1,8 +1,11 @@
 
 #include "UniformBuffer.h"
+#include "UniformArena.h"
 #include "Texture.h"
 #include "Constant.h"
 #include <LavaCake/Raytracing/TopLevelAS.h>
+#include <LavaCake/Helpers/Trace.h>
+#include <algorithm>
 
 namespace LavaCake {
   namespace Framework {
@@ -54,6 +57,14 @@ namespace LavaCake {
       const VkShaderStageFlags      stage;
     };
 
+    struct dynamicBuffer {
+      const VkBuffer& handle;
+      const VkDeviceSize          range;
+      const VkDescriptorType      type;
+      const int                   binding;
+      const VkShaderStageFlags      stage;
+    };
+
 
     struct accelerationStructure {
       const VkAccelerationStructureKHR& handle;
@@ -61,6 +72,16 @@ namespace LavaCake {
       VkShaderStageFlags			             stage;
     };
 
+    struct bindlessArray {
+      VkDescriptorType            type;
+      uint32_t                    capacity;
+      int                         binding;
+      VkShaderStageFlags          stage;
+      uint32_t                    nextSlot = 0;
+      std::vector<uint32_t>       freeSlots;
+      std::vector<bool>           allocated;
+    };
+
     class DescriptorSet {
 
     public:
@@ -154,6 +175,25 @@ namespace LavaCake {
       };
 
 
+      /**
+      \brief Add the buffer of a UniformArena with a dynamic descriptor, the slice used by a draw or a dispatch is selected by a dynamic offset
+      when the descriptor set is bound. Dynamic offsets are given in the order of the bindings of the dynamic buffers.
+      \param arena the arena
+      \param stage the shader stage where the buffer is going to be used
+      \param binding the binding point of the buffer, 0 by default
+      */
+      void addDynamicBuffer(const UniformArena& arena, VkShaderStageFlags stage, int binding = 0) {
+        m_dynamicBuffers.push_back({ arena.getBuffer().getHandle(), arena.getSliceSize(),
+          arena.isStorage() ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, binding, stage });
+      };
+
+      /**
+      \brief get the number of dynamic offsets expected when the descriptor set is bound
+      */
+      uint32_t getDynamicBufferCount() const {
+        return static_cast<uint32_t>(m_dynamicBuffers.size());
+      }
+
       /**
       \brief Add an acceleration structure to the pipeline and scpecify it's binding and shader stage
       \param AS a pointer to the top level acceleration structure
@@ -164,11 +204,85 @@ namespace LavaCake {
         m_AS.push_back({ AS.getHandle() , binding, stage });
       }
 
+      /**
+      \brief Add a bindless array of textures, a partially bound array of combined image samplers filled after the generation of the
+      descriptor set with allocateTextureSlot. Shaders index it with the slots, given through push constants or buffers, so that draws using
+      different textures share the same descriptor set. The device must be created with Device::enableDescriptorIndexing.
+      \param capacity the number of elements of the array
+      \param stage the shader stage where the textures are going to be used
+      \param binding the binding point of the array, 0 by default
+      */
+      void addBindlessTextures(uint32_t capacity, VkShaderStageFlags stage, int binding = 0) {
+        m_bindless.push_back({ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, capacity, binding, stage });
+      }
+
+      /**
+      \brief Add a bindless array of storage buffers, a partially bound array filled after the generation of the descriptor set with
+      allocateBufferSlot. The device must be created with Device::enableDescriptorIndexing.
+      \param capacity the number of elements of the array
+      \param stage the shader stage where the buffers are going to be used
+      \param binding the binding point of the array, 0 by default
+      */
+      void addBindlessBuffers(uint32_t capacity, VkShaderStageFlags stage, int binding = 0) {
+        m_bindless.push_back({ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, capacity, binding, stage });
+      }
+
+      /**
+      \brief Write a texture in a free slot of a bindless array, the descriptor set may already be bound in command buffers that do not use the slot
+      \param texture the texture
+      \param binding the binding point of the bindless array, 0 by default
+      \return the index of the texture in the array, UINT32_MAX if the array is full
+      */
+      uint32_t allocateTextureSlot(const Image& texture, int binding = 0) {
+        VkDescriptorImageInfo info = {
+          texture.getSampler(),                           // VkSampler        sampler
+          texture.getImageView(),                         // VkImageView      imageView
+          texture.getLayout()                             // VkImageLayout    imageLayout
+        };
+        return writeSlot(binding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &info, nullptr);
+      }
+
+      /**
+      \brief Write a storage buffer in a free slot of a bindless array, the descriptor set may already be bound in command buffers that do not use the slot
+      \param buffer the buffer
+      \param binding the binding point of the bindless array, 0 by default
+      \return the index of the buffer in the array, UINT32_MAX if the array is full
+      */
+      uint32_t allocateBufferSlot(const Buffer& buffer, int binding = 0) {
+        VkDescriptorBufferInfo info = {
+          buffer.getHandle(),                             // VkBuffer         buffer
+          0,                                              // VkDeviceSize     offset
+          VK_WHOLE_SIZE                                   // VkDeviceSize     range
+        };
+        return writeSlot(binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &info);
+      }
+
+      /**
+      \brief Give a slot back to its bindless array, the command buffers using it must have completed before the slot is allocated again
+      \param slot the index returned by allocateTextureSlot or allocateBufferSlot
+      \param binding the binding point of the bindless array, 0 by default
+      */
+      void freeSlot(uint32_t slot, int binding = 0) {
+        for (auto& array : m_bindless) {
+          if (array.binding == binding && slot < array.nextSlot) {
+            if (!array.allocated[slot]) {
+              ErrorCheck::setError("This slot of the bindless array is already free", 1);
+              return;
+            }
+            array.allocated[slot] = false;
+            array.freeSlots.push_back(slot);
+            return;
+          }
+        }
+        ErrorCheck::setError("This slot was not allocated in a bindless array", 1);
+      }
+
       const std::vector<attachment>& getAttachments() const {
         return m_attachments;
       };
 
       void generateDescriptorLayout() {
+        LAVACAKE_TRACE_ZONE("DescriptorSet::generateDescriptorLayout");
 
         if (m_gernerated) return;
 
@@ -240,6 +354,15 @@ namespace LavaCake {
             nullptr
             });
         }
+        for (uint32_t i = 0; i < m_dynamicBuffers.size(); i++) {
+          descriptorSetLayoutBinding.push_back({
+            uint32_t(m_dynamicBuffers[i].binding),
+            m_dynamicBuffers[i].type,
+            1,
+            m_dynamicBuffers[i].stage,
+            nullptr
+            });
+        }
 
         for (uint32_t i = 0; i < m_AS.size(); i++) {
           descriptorSetLayoutBinding.push_back({
@@ -251,12 +374,36 @@ namespace LavaCake {
             });
         }
 
+        // the bindless arrays are written after the set is bound, every other binding is written once here
+        bool bindless = !m_bindless.empty();
+        if (bindless && !checkBindlessSupport()) {
+          return;
+        }
+        std::vector<VkDescriptorBindingFlags> bindingFlags(descriptorSetLayoutBinding.size(), 0);
+        for (uint32_t i = 0; i < m_bindless.size(); i++) {
+          descriptorSetLayoutBinding.push_back({
+            uint32_t(m_bindless[i].binding),
+            m_bindless[i].type,
+            m_bindless[i].capacity,
+            m_bindless[i].stage,
+            nullptr
+            });
+          bindingFlags.push_back(VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT);
+        }
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_create_info = {
+          VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,      // VkStructureType                      sType
+          nullptr,                                                                // const void                         * pNext
+          static_cast<uint32_t>(bindingFlags.size()),                             // uint32_t                             bindingCount
+          bindingFlags.data()                                                     // const VkDescriptorBindingFlags     * pBindingFlags
+        };
 
         //create descriptor
         VkDescriptorSetLayoutCreateInfo descriptor_set_layout_create_info = {
           VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,                    // VkStructureType                      sType
-          nullptr,                                                                // const void                         * pNext
-          0,                                                                      // VkDescriptorSetLayoutCreateFlags     flags
+          bindless ? &binding_flags_create_info : nullptr,                        // const void                         * pNext
+          bindless ?                                                              // VkDescriptorSetLayoutCreateFlags     flags
+            VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT : 0u,
           static_cast<uint32_t>(descriptorSetLayoutBinding.size()),               // uint32_t                             bindingCount
           descriptorSetLayoutBinding.data()                                       // const VkDescriptorSetLayoutBinding * pBindings
         };
@@ -266,7 +413,7 @@ namespace LavaCake {
           ErrorCheck::setError("Could not create a layout for descriptor sets.");
         }
 
-        uint32_t descriptorsNumber = static_cast<uint32_t>(m_uniforms.size() + m_textures.size() + m_storageImages.size() + m_attachments.size() + m_frameBuffers.size() + m_texelBuffers.size() + m_buffers.size() + m_AS.size());
+        uint32_t descriptorsNumber = static_cast<uint32_t>(m_uniforms.size() + m_textures.size() + m_storageImages.size() + m_attachments.size() + m_frameBuffers.size() + m_texelBuffers.size() + m_buffers.size() + m_dynamicBuffers.size() + m_AS.size() + m_bindless.size());
 
 
 
@@ -317,6 +464,16 @@ namespace LavaCake {
             });
         }
 
+        for (VkDescriptorType type : { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC }) {
+          uint32_t count = static_cast<uint32_t>(std::count_if(m_dynamicBuffers.begin(), m_dynamicBuffers.end(), [&](const dynamicBuffer& b) { return b.type == type; }));
+          if (count > 0) {
+            descriptorPoolSize.push_back({
+              type,
+              count
+              });
+          }
+        }
+
         if (m_AS.size() > 0) {
           descriptorPoolSize.push_back({
             VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR,
@@ -324,12 +481,20 @@ namespace LavaCake {
             });
         }
 
+        // the pool adds up the sizes given for the same type
+        for (auto& array : m_bindless) {
+          descriptorPoolSize.push_back({
+            array.type,
+            array.capacity
+            });
+        }
+
 
         VkDescriptorPoolCreateInfo descriptor_pool_create_info = {
           VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,                    // VkStructureType                sType
           nullptr,                                                          // const void                   * pNext
-          false ?                                                           // VkDescriptorPoolCreateFlags    flags
-            VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT : 0u,
+          bindless ?                                                        // VkDescriptorPoolCreateFlags    flags
+            VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT : 0u,
           descriptorsNumber,                                                // uint32_t                       maxSets
           static_cast<uint32_t>(descriptorPoolSize.size()),                 // uint32_t                       poolSizeCount
           descriptorPoolSize.data()                                         // const VkDescriptorPoolSize   * pPoolSizes
@@ -535,6 +700,32 @@ namespace LavaCake {
 
         }
 
+        std::vector< std::vector<VkDescriptorBufferInfo>> dynamicDescriptor;
+        for (uint32_t i = 0; i < m_dynamicBuffers.size(); i++) {
+
+          dynamicDescriptor.push_back({                       // std::vector<VkDescriptorBufferInfo>  BufferInfos
+              {
+              m_dynamicBuffers[i].handle,                                           // VkBuffer                             buffer
+              0,                                                                    // VkDeviceSize                         offset
+              m_dynamicBuffers[i].range                                             // VkDeviceSize                         range
+              }
+            });
+
+          write_descriptors.push_back({
+            VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,                                 // VkStructureType                  sType
+            nullptr,                                                                // const void                     * pNext
+            descriptorSets[descriptorCount],                                        // VkDescriptorSet                  dstSet
+            uint32_t(m_dynamicBuffers[i].binding),                                  // uint32_t                         dstBinding
+            0,                                                                      // uint32_t                         dstArrayElement
+            static_cast<uint32_t>(dynamicDescriptor[i].size()),                     // uint32_t                         descriptorCount
+            m_dynamicBuffers[i].type,                                               // VkDescriptorType                 descriptorType
+            nullptr,                                                                // const VkDescriptorImageInfo    * pImageInfo
+            dynamicDescriptor[i].data(),                                            // const VkDescriptorBufferInfo   * pBufferInfo
+            nullptr                                                                 // const VkBufferView             * pTexelBufferView
+            });
+
+        }
+
         std::vector<VkWriteDescriptorSetAccelerationStructureKHR> descriptorAccelerationStructureInfos{};
 
         for (auto& AS_descriptor : m_AS) {
@@ -584,6 +775,85 @@ namespace LavaCake {
 
     private:
 
+      bool checkBindlessSupport() const {
+        Device* d = Device::getDevice();
+        if (!d->descriptorIndexingAvailable()) {
+          ErrorCheck::setError("Bindless arrays need the descriptor indexing features, see Device::enableDescriptorIndexing");
+          return false;
+        }
+        // dynamic descriptors cannot be in a set allocated from an update after bind pool
+        if (!m_dynamicBuffers.empty()) {
+          ErrorCheck::setError("A descriptor set cannot have both bindless arrays and dynamic buffers");
+          return false;
+        }
+
+        VkPhysicalDeviceDescriptorIndexingProperties indexingProperties{};
+        indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+        VkPhysicalDeviceProperties2 properties{};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties.pNext = &indexingProperties;
+        vkGetPhysicalDeviceProperties2(d->getPhysicalDevice(), &properties);
+
+        uint64_t textures = 0;
+        uint64_t buffers = 0;
+        for (auto& array : m_bindless) {
+          (array.type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ? buffers : textures) += array.capacity;
+        }
+        if (textures > indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages ||
+          textures > indexingProperties.maxDescriptorSetUpdateAfterBindSamplers ||
+          buffers > indexingProperties.maxDescriptorSetUpdateAfterBindStorageBuffers) {
+          ErrorCheck::setError("The bindless arrays are larger than the limits of the device");
+          return false;
+        }
+        return true;
+      }
+
+      uint32_t writeSlot(int binding, VkDescriptorType type, const VkDescriptorImageInfo* imageInfo, const VkDescriptorBufferInfo* bufferInfo) {
+        if (m_descriptorSet == VK_NULL_HANDLE) {
+          ErrorCheck::setError("The descriptor set must be generated before its bindless arrays are filled");
+          return UINT32_MAX;
+        }
+
+        for (auto& array : m_bindless) {
+          if (array.binding != binding || array.type != type) {
+            continue;
+          }
+
+          uint32_t slot;
+          if (!array.freeSlots.empty()) {
+            slot = array.freeSlots.back();
+            array.freeSlots.pop_back();
+          }
+          else if (array.nextSlot < array.capacity) {
+            slot = array.nextSlot++;
+            array.allocated.resize(array.nextSlot, false);
+          }
+          else {
+            ErrorCheck::setError("The bindless array is full", 1);
+            return UINT32_MAX;
+          }
+          array.allocated[slot] = true;
+
+          VkWriteDescriptorSet write = {
+            VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,                                 // VkStructureType                  sType
+            nullptr,                                                                // const void                     * pNext
+            m_descriptorSet,                                                        // VkDescriptorSet                  dstSet
+            uint32_t(binding),                                                      // uint32_t                         dstBinding
+            slot,                                                                   // uint32_t                         dstArrayElement
+            1,                                                                      // uint32_t                         descriptorCount
+            type,                                                                   // VkDescriptorType                 descriptorType
+            imageInfo,                                                              // const VkDescriptorImageInfo    * pImageInfo
+            bufferInfo,                                                             // const VkDescriptorBufferInfo   * pBufferInfo
+            nullptr                                                                 // const VkBufferView             * pTexelBufferView
+          };
+          vkUpdateDescriptorSets(Device::getDevice()->getLogicalDevice(), 1, &write, 0, nullptr);
+          return slot;
+        }
+
+        ErrorCheck::setError("No bindless array of this type at this binding");
+        return UINT32_MAX;
+      }
+
       VkDescriptorSet                                                 m_descriptorSet = VK_NULL_HANDLE;
       VkDescriptorSetLayout                                           m_descriptorSetLayout = VK_NULL_HANDLE;
       VkDescriptorPool                                                m_descriptorPool = VK_NULL_HANDLE;
@@ -595,9 +865,11 @@ namespace LavaCake {
       std::vector<storageImage>                                       m_storageImages;
       std::vector<texelBuffer>                                        m_texelBuffers;
       std::vector<buffer>                                             m_buffers;
+      std::vector<dynamicBuffer>                                      m_dynamicBuffers;
 
 
       std::vector<accelerationStructure>                              m_AS;
+      std::vector<bindlessArray>                                      m_bindless;
 
       bool                                                            m_empty = true;
       bool                                                            m_gernerated = false;
@@ -1,4 +1,5 @@
 #include "Device.h"
+#include "SamplerCache.h"
 #include <algorithm>
 
 
@@ -30,6 +31,11 @@ namespace LavaCake {
       VK_NV_MESH_SHADER_EXTENSION_NAME
     };
 
+    const std::vector<const char*> descriptorIndexingExtension = {
+      VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME,
+      VK_KHR_MAINTENANCE3_EXTENSION_NAME
+    };
+
 
     bool CheckAvailableInstanceExtensions(std::vector<VkExtensionProperties>& available_extensions) {
       uint32_t extensions_count = 0;
@@ -215,6 +221,11 @@ namespace LavaCake {
       m_meshShaderOptional = optional;
     }
 
+    void Device::enableDescriptorIndexing(bool optional) {
+      m_descriptorIndexingEnabled = true;
+      m_descriptorIndexingOptional = optional;
+    }
+
 
 
     void Device::initDevices(
@@ -354,6 +365,20 @@ namespace LavaCake {
 
       }
 
+      if (m_descriptorIndexingEnabled) {
+        std::vector<char const*>& extension = m_descriptorIndexingOptional ? device_extensions_optional : device_extensions;
+
+        // the raytracing extensions already contain them
+        for (auto e : descriptorIndexingExtension) {
+          if (std::find_if(extension.begin(), extension.end(), [&](const char* other) { return std::string(other) == e; }) == extension.end()) {
+            extension.push_back(e);
+          }
+        }
+      }
+
+      // the memory budget is only queried when available, see MemoryBudget
+      device_extensions_optional.emplace_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
 
       for (int i = 0; i < nbComputeQueue; i++) {
         m_computeQueues.push_back(ComputeQueue());
@@ -522,6 +547,7 @@ namespace LavaCake {
 
           bool raytracingAvailable = m_raytracingEnabled;
           bool meshShaderAvailable = m_meshShaderEnabled;
+          bool descriptorIndexingAvailable = m_descriptorIndexingEnabled;
 
           for (auto e : missingOptionalExtension) {
             if (m_raytracingEnabled && m_raytracingOptional && raytracingAvailable) {
@@ -541,12 +567,21 @@ namespace LavaCake {
                 }
               }
             }
+            if (m_descriptorIndexingEnabled && m_descriptorIndexingOptional && descriptorIndexingAvailable) {
+              for (auto die : descriptorIndexingExtension) {
+                if (std::string(e) == die) {
+                  descriptorIndexingAvailable = false;
+                  break;
+                }
+              }
+            }
           }
 
           VkPhysicalDeviceBufferDeviceAddressFeatures enabledBufferDeviceAddresFeatures{};
           VkPhysicalDeviceRayTracingPipelineFeaturesKHR enabledRayTracingPipelineFeatures{};
           VkPhysicalDeviceAccelerationStructureFeaturesKHR enabledAccelerationStructureFeatures{};
           VkPhysicalDeviceMeshShaderFeaturesNV enabledMeshShaderFeatures{};
+          VkPhysicalDeviceDescriptorIndexingFeatures enabledDescriptorIndexingFeatures{};
 
           void* pNextChain = nullptr;
 
@@ -576,6 +611,37 @@ namespace LavaCake {
             pNextChain = &enabledMeshShaderFeatures;
           }
 
+          if (descriptorIndexingAvailable) {
+            VkPhysicalDeviceDescriptorIndexingFeatures supported{};
+            supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+            VkPhysicalDeviceFeatures2 supportedFeatures{};
+            supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            supportedFeatures.pNext = &supported;
+            vkGetPhysicalDeviceFeatures2(device.device, &supportedFeatures);
+
+            // the features used by the bindless arrays of DescriptorSet
+            descriptorIndexingAvailable = supported.runtimeDescriptorArray && supported.descriptorBindingPartiallyBound &&
+              supported.descriptorBindingUpdateUnusedWhilePending && supported.descriptorBindingSampledImageUpdateAfterBind &&
+              supported.descriptorBindingStorageBufferUpdateAfterBind && supported.shaderSampledImageArrayNonUniformIndexing;
+
+            if (descriptorIndexingAvailable) {
+              enabledDescriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+              enabledDescriptorIndexingFeatures.pNext = pNextChain;
+              enabledDescriptorIndexingFeatures.runtimeDescriptorArray = VK_TRUE;
+              enabledDescriptorIndexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+              enabledDescriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+              enabledDescriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+              enabledDescriptorIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+              enabledDescriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+              enabledDescriptorIndexingFeatures.shaderStorageBufferArrayNonUniformIndexing = supported.shaderStorageBufferArrayNonUniformIndexing;
+
+              pNextChain = &enabledDescriptorIndexingFeatures;
+            }
+            else if (!m_descriptorIndexingOptional) {
+              continue;
+            }
+          }
+
           VkPhysicalDeviceFeatures2 physicalDeviceFeatures2{};
           if (pNextChain) {
             physicalDeviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
@@ -596,6 +662,10 @@ namespace LavaCake {
 
             m_raytracingAvailable = raytracingAvailable;
             m_meshShaderAvailable = meshShaderAvailable;
+            m_descriptorIndexingAvailable = descriptorIndexingAvailable;
+            m_memoryBudgetAvailable = std::find_if(extensionToLoad.begin(), extensionToLoad.end(), [](const char* e) {
+              return std::string(e) == VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+              }) != extensionToLoad.end();
 
 
 
@@ -611,6 +681,9 @@ namespace LavaCake {
             if (!m_meshShaderAvailable && m_meshShaderEnabled) {
               ErrorCheck::setError("Mesh shader extensions not found on this device", 1);
             }
+            if (!m_descriptorIndexingAvailable && m_descriptorIndexingEnabled) {
+              ErrorCheck::setError("Descriptor indexing features not found on this device", 1);
+            }
 
             LavaCake::Core::LoadDeviceLevelFunctions(m_logical, extensionToLoad);
 
@@ -676,6 +749,9 @@ namespace LavaCake {
     void Device::end() {
       waitForAllCommands();
 
+      // samplers still used by images that outlive the device
+      SamplerCache::clear();
+
       if (VK_NULL_HANDLE != m_commandPool) {
         vkDestroyCommandPool(m_logical, m_commandPool, nullptr);
         m_commandPool = VK_NULL_HANDLE;
@@ -227,6 +227,12 @@ namespace LavaCake {
       */
       void enableMeshShader(bool optional = false);
 
+      /**
+      \brief Ask the device to enable the descriptor indexing features used by the bindless arrays of DescriptorSet
+      \param optional: a boolean indicating if the device creation can success even if descriptor indexing features are not found
+      */
+      void enableDescriptorIndexing(bool optional = false);
+
       /*
       \brief check if raytracing features have been successfuly loaded
       \return true if raytracing is available
@@ -243,6 +249,22 @@ namespace LavaCake {
         return m_meshShaderAvailable;
       }
 
+      /*
+      \brief check if descriptor indexing features have been successfuly loaded
+      \return true if the bindless arrays of DescriptorSet can be used
+      */
+      bool descriptorIndexingAvailable() const {
+        return m_descriptorIndexingAvailable;
+      }
+
+      /*
+      \brief check if VK_EXT_memory_budget has been loaded, MemoryBudget falls back to the heap sizes without it
+      \return true if the memory budget can be queried
+      */
+      bool memoryBudgetAvailable() const {
+        return m_memoryBudgetAvailable;
+      }
+
     private:
 
       void initDevices(
@@ -269,11 +291,15 @@ namespace LavaCake {
       bool                                      m_raytracingOptional = true;
       bool                                      m_meshShaderEnabled = false;
       bool                                      m_meshShaderOptional = true;
+      bool                                      m_descriptorIndexingEnabled = false;
+      bool                                      m_descriptorIndexingOptional = true;
 
       std::vector<const char*>                  m_missingOptionalExtension;
 
       bool                                      m_raytracingAvailable = false;
       bool                                      m_meshShaderAvailable = false;
+      bool                                      m_descriptorIndexingAvailable = false;
+      bool                                      m_memoryBudgetAvailable = false;
     };
   }
 }
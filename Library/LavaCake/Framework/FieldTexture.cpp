@@ -0,0 +1,317 @@
+#include "FieldTexture.h"
+
+namespace LavaCake {
+  namespace Framework {
+
+    // Field sampler compute shaders, assembled for SPIR-V 1.0 from:
+    /*
+    #version 450
+    layout(local_size_x = 64) in;
+    layout(set = 0, binding = 0) uniform sampler3D field;   // sampler2D and vec2 coordinates for fieldSampler2D
+    layout(std430, set = 0, binding = 1) readonly buffer Queries { vec4 scale; vec4 offset; uint count; vec4 positions[]; } queries;
+    layout(std430, set = 0, binding = 2) writeonly buffer Results { vec4 values[]; } results;
+
+    void main()
+    {
+      uint i = gl_GlobalInvocationID.x;
+      if (i < queries.count) {
+        vec4 uvw = queries.positions[i] * queries.scale + queries.offset;
+        results.values[i] = textureLod(field, uvw.xyz, 0.0);
+      }
+    }
+    */
+
+    static const uint32_t fieldSampler2D[] =
+    {
+        0x07230203,0x00010000,0x00000000,0x00000035,0x00000000,0x00020011,0x00000001,0x0003000e,
+        0x00000000,0x00000001,0x0006000f,0x00000005,0x00000001,0x6e69616d,0x00000000,0x00000002,
+        0x00060010,0x00000001,0x00000011,0x00000040,0x00000001,0x00000001,0x00040047,0x00000002,
+        0x0000000b,0x0000001c,0x00040047,0x00000003,0x00000022,0x00000000,0x00040047,0x00000003,
+        0x00000021,0x00000000,0x00040047,0x00000004,0x00000006,0x00000010,0x00050048,0x00000005,
+        0x00000000,0x00000023,0x00000000,0x00040048,0x00000005,0x00000000,0x00000018,0x00050048,
+        0x00000005,0x00000001,0x00000023,0x00000010,0x00040048,0x00000005,0x00000001,0x00000018,
+        0x00050048,0x00000005,0x00000002,0x00000023,0x00000020,0x00040048,0x00000005,0x00000002,
+        0x00000018,0x00050048,0x00000005,0x00000003,0x00000023,0x00000030,0x00040048,0x00000005,
+        0x00000003,0x00000018,0x00030047,0x00000005,0x00000003,0x00040047,0x00000006,0x00000022,
+        0x00000000,0x00040047,0x00000006,0x00000021,0x00000001,0x00050048,0x00000007,0x00000000,
+        0x00000023,0x00000000,0x00040048,0x00000007,0x00000000,0x00000019,0x00030047,0x00000007,
+        0x00000003,0x00040047,0x00000008,0x00000022,0x00000000,0x00040047,0x00000008,0x00000021,
+        0x00000002,0x00020013,0x00000009,0x00030021,0x0000000a,0x00000009,0x00020014,0x0000000b,
+        0x00040015,0x0000000c,0x00000020,0x00000000,0x00040015,0x0000000d,0x00000020,0x00000001,
+        0x00030016,0x0000000e,0x00000020,0x00040017,0x0000000f,0x0000000c,0x00000003,0x00040017,
+        0x00000010,0x0000000e,0x00000002,0x00040017,0x00000011,0x0000000e,0x00000004,0x00040020,
+        0x00000012,0x00000001,0x0000000f,0x00040020,0x00000013,0x00000001,0x0000000c,0x0004003b,
+        0x00000012,0x00000002,0x00000001,0x00090019,0x00000014,0x0000000e,0x00000001,0x00000000,
+        0x00000000,0x00000000,0x00000001,0x00000000,0x0003001b,0x00000015,0x00000014,0x00040020,
+        0x00000016,0x00000000,0x00000015,0x0004003b,0x00000016,0x00000003,0x00000000,0x0003001d,
+        0x00000004,0x00000011,0x0006001e,0x00000005,0x00000011,0x00000011,0x0000000c,0x00000004,
+        0x00040020,0x00000017,0x00000002,0x00000005,0x0004003b,0x00000017,0x00000006,0x00000002,
+        0x0003001e,0x00000007,0x00000004,0x00040020,0x00000018,0x00000002,0x00000007,0x0004003b,
+        0x00000018,0x00000008,0x00000002,0x00040020,0x00000019,0x00000002,0x00000011,0x00040020,
+        0x0000001a,0x00000002,0x0000000c,0x0004002b,0x0000000c,0x0000001b,0x00000000,0x0004002b,
+        0x0000000d,0x0000001c,0x00000000,0x0004002b,0x0000000d,0x0000001d,0x00000001,0x0004002b,
+        0x0000000d,0x0000001e,0x00000002,0x0004002b,0x0000000d,0x0000001f,0x00000003,0x0004002b,
+        0x0000000e,0x00000020,0x00000000,0x00050036,0x00000009,0x00000001,0x00000000,0x0000000a,
+        0x000200f8,0x00000021,0x00050041,0x00000013,0x00000022,0x00000002,0x0000001b,0x0004003d,
+        0x0000000c,0x00000023,0x00000022,0x00050041,0x0000001a,0x00000024,0x00000006,0x0000001e,
+        0x0004003d,0x0000000c,0x00000025,0x00000024,0x000500b0,0x0000000b,0x00000026,0x00000023,
+        0x00000025,0x000300f7,0x00000027,0x00000000,0x000400fa,0x00000026,0x00000028,0x00000027,
+        0x000200f8,0x00000028,0x00060041,0x00000019,0x00000029,0x00000006,0x0000001f,0x00000023,
+        0x0004003d,0x00000011,0x0000002a,0x00000029,0x00050041,0x00000019,0x0000002b,0x00000006,
+        0x0000001c,0x0004003d,0x00000011,0x0000002c,0x0000002b,0x00050041,0x00000019,0x0000002d,
+        0x00000006,0x0000001d,0x0004003d,0x00000011,0x0000002e,0x0000002d,0x00050085,0x00000011,
+        0x0000002f,0x0000002a,0x0000002c,0x00050081,0x00000011,0x00000030,0x0000002f,0x0000002e,
+        0x0007004f,0x00000010,0x00000031,0x00000030,0x00000030,0x00000000,0x00000001,0x0004003d,
+        0x00000015,0x00000032,0x00000003,0x00070058,0x00000011,0x00000033,0x00000032,0x00000031,
+        0x00000002,0x00000020,0x00060041,0x00000019,0x00000034,0x00000008,0x0000001c,0x00000023,
+        0x0003003e,0x00000034,0x00000033,0x000200f9,0x00000027,0x000200f8,0x00000027,0x000100fd,
+        0x00010038
+    };
+
+    static const uint32_t fieldSampler3D[] =
+    {
+        0x07230203,0x00010000,0x00000000,0x00000035,0x00000000,0x00020011,0x00000001,0x0003000e,
+        0x00000000,0x00000001,0x0006000f,0x00000005,0x00000001,0x6e69616d,0x00000000,0x00000002,
+        0x00060010,0x00000001,0x00000011,0x00000040,0x00000001,0x00000001,0x00040047,0x00000002,
+        0x0000000b,0x0000001c,0x00040047,0x00000003,0x00000022,0x00000000,0x00040047,0x00000003,
+        0x00000021,0x00000000,0x00040047,0x00000004,0x00000006,0x00000010,0x00050048,0x00000005,
+        0x00000000,0x00000023,0x00000000,0x00040048,0x00000005,0x00000000,0x00000018,0x00050048,
+        0x00000005,0x00000001,0x00000023,0x00000010,0x00040048,0x00000005,0x00000001,0x00000018,
+        0x00050048,0x00000005,0x00000002,0x00000023,0x00000020,0x00040048,0x00000005,0x00000002,
+        0x00000018,0x00050048,0x00000005,0x00000003,0x00000023,0x00000030,0x00040048,0x00000005,
+        0x00000003,0x00000018,0x00030047,0x00000005,0x00000003,0x00040047,0x00000006,0x00000022,
+        0x00000000,0x00040047,0x00000006,0x00000021,0x00000001,0x00050048,0x00000007,0x00000000,
+        0x00000023,0x00000000,0x00040048,0x00000007,0x00000000,0x00000019,0x00030047,0x00000007,
+        0x00000003,0x00040047,0x00000008,0x00000022,0x00000000,0x00040047,0x00000008,0x00000021,
+        0x00000002,0x00020013,0x00000009,0x00030021,0x0000000a,0x00000009,0x00020014,0x0000000b,
+        0x00040015,0x0000000c,0x00000020,0x00000000,0x00040015,0x0000000d,0x00000020,0x00000001,
+        0x00030016,0x0000000e,0x00000020,0x00040017,0x0000000f,0x0000000c,0x00000003,0x00040017,
+        0x00000010,0x0000000e,0x00000003,0x00040017,0x00000011,0x0000000e,0x00000004,0x00040020,
+        0x00000012,0x00000001,0x0000000f,0x00040020,0x00000013,0x00000001,0x0000000c,0x0004003b,
+        0x00000012,0x00000002,0x00000001,0x00090019,0x00000014,0x0000000e,0x00000002,0x00000000,
+        0x00000000,0x00000000,0x00000001,0x00000000,0x0003001b,0x00000015,0x00000014,0x00040020,
+        0x00000016,0x00000000,0x00000015,0x0004003b,0x00000016,0x00000003,0x00000000,0x0003001d,
+        0x00000004,0x00000011,0x0006001e,0x00000005,0x00000011,0x00000011,0x0000000c,0x00000004,
+        0x00040020,0x00000017,0x00000002,0x00000005,0x0004003b,0x00000017,0x00000006,0x00000002,
+        0x0003001e,0x00000007,0x00000004,0x00040020,0x00000018,0x00000002,0x00000007,0x0004003b,
+        0x00000018,0x00000008,0x00000002,0x00040020,0x00000019,0x00000002,0x00000011,0x00040020,
+        0x0000001a,0x00000002,0x0000000c,0x0004002b,0x0000000c,0x0000001b,0x00000000,0x0004002b,
+        0x0000000d,0x0000001c,0x00000000,0x0004002b,0x0000000d,0x0000001d,0x00000001,0x0004002b,
+        0x0000000d,0x0000001e,0x00000002,0x0004002b,0x0000000d,0x0000001f,0x00000003,0x0004002b,
+        0x0000000e,0x00000020,0x00000000,0x00050036,0x00000009,0x00000001,0x00000000,0x0000000a,
+        0x000200f8,0x00000021,0x00050041,0x00000013,0x00000022,0x00000002,0x0000001b,0x0004003d,
+        0x0000000c,0x00000023,0x00000022,0x00050041,0x0000001a,0x00000024,0x00000006,0x0000001e,
+        0x0004003d,0x0000000c,0x00000025,0x00000024,0x000500b0,0x0000000b,0x00000026,0x00000023,
+        0x00000025,0x000300f7,0x00000027,0x00000000,0x000400fa,0x00000026,0x00000028,0x00000027,
+        0x000200f8,0x00000028,0x00060041,0x00000019,0x00000029,0x00000006,0x0000001f,0x00000023,
+        0x0004003d,0x00000011,0x0000002a,0x00000029,0x00050041,0x00000019,0x0000002b,0x00000006,
+        0x0000001c,0x0004003d,0x00000011,0x0000002c,0x0000002b,0x00050041,0x00000019,0x0000002d,
+        0x00000006,0x0000001d,0x0004003d,0x00000011,0x0000002e,0x0000002d,0x00050085,0x00000011,
+        0x0000002f,0x0000002a,0x0000002c,0x00050081,0x00000011,0x00000030,0x0000002f,0x0000002e,
+        0x0008004f,0x00000010,0x00000031,0x00000030,0x00000030,0x00000000,0x00000001,0x00000002,
+        0x0004003d,0x00000015,0x00000032,0x00000003,0x00070058,0x00000011,0x00000033,0x00000032,
+        0x00000031,0x00000002,0x00000020,0x00060041,0x00000019,0x00000034,0x00000008,0x0000001c,
+        0x00000023,0x0003003e,0x00000034,0x00000033,0x000200f9,0x00000027,0x000200f8,0x00000027,
+        0x000100fd,0x00010038
+    };
+
+    static const uint64_t queriesHeaderSize = 48;
+
+    Image createFieldTexture(
+      const Queue& queue,
+      CommandBuffer& cmdBuff,
+      uint32_t width,
+      uint32_t height,
+      uint32_t depth,
+      uint32_t channels,
+      const std::function<void(uint32_t first, uint32_t count, float* texels)>& fill,
+      bool storage,
+      VkPipelineStageFlags stageFlag,
+      uint64_t maxStagingSize) {
+
+      VkFormat format = VK_FORMAT_R32G32B32A32_SFLOAT;
+      if (channels == 1) {
+        format = VK_FORMAT_R32_SFLOAT;
+      }
+      else if (channels == 2) {
+        format = VK_FORMAT_R32G32_SFLOAT;
+      }
+
+      VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+      if (storage) {
+        usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+      }
+
+      Image image(width, height, depth, format, VK_IMAGE_ASPECT_COLOR_BIT, usage);
+
+      // linear filtering of 32 bits float formats is optional
+      VkFormatProperties properties;
+      vkGetPhysicalDeviceFormatProperties(Device::getDevice()->getPhysicalDevice(), format, &properties);
+      if (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) {
+        image.createSampler(VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE);
+      }
+      else {
+        ErrorCheck::setError("The field format does not support linear filtering, a nearest sampler is used instead", 1);
+        image.createSampler(VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE);
+      }
+
+      // 3D images are copied by z planes, 2D images by rows
+      uint32_t sliceCount = depth > 1 ? depth : height;
+      uint64_t sliceSize = uint64_t(width) * channels * sizeof(float) * (depth > 1 ? height : 1);
+      uint32_t slicesPerCopy = uint32_t(std::max<uint64_t>(1, std::min<uint64_t>(sliceCount, maxStagingSize / sliceSize)));
+
+      Buffer stagingBuffer(sliceSize * slicesPerCopy, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+      std::vector<float> texels(size_t(sliceSize / sizeof(float)) * slicesPerCopy);
+
+      VkImageSubresourceRange subresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+      VkImageSubresourceLayers image_subresource_layer = {
+        VK_IMAGE_ASPECT_COLOR_BIT,    // VkImageAspectFlags     aspectMask
+        0,                            // uint32_t               mipLevel
+        0,                            // uint32_t               baseArrayLayer
+        1                             // uint32_t               layerCount
+      };
+
+      for (uint32_t first = 0; first < sliceCount; first += slicesPerCopy) {
+        uint32_t count = std::min(slicesPerCopy, sliceCount - first);
+        fill(first, count, texels.data());
+        stagingBuffer.write(texels);
+
+        VkBufferImageCopy region = {
+          0,                                                                    // VkDeviceSize               bufferOffset
+          0,                                                                    // uint32_t                   bufferRowLength
+          0,                                                                    // uint32_t                   bufferImageHeight
+          image_subresource_layer,                                              // VkImageSubresourceLayers   imageSubresource
+          { 0, depth > 1 ? 0 : int32_t(first), depth > 1 ? int32_t(first) : 0 },// VkOffset3D                 imageOffset
+          { width, depth > 1 ? height : count, depth > 1 ? count : 1 }          // VkExtent3D                 imageExtent
+        };
+
+        cmdBuff.beginRecord();
+        if (first == 0) {
+          image.setLayout(cmdBuff, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, subresourceRange);
+        }
+        stagingBuffer.copyToImage(cmdBuff, image, region);
+        if (first + count == sliceCount) {
+          image.setLayout(cmdBuff, storage ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, stageFlag, subresourceRange);
+        }
+        cmdBuff.endRecord();
+        cmdBuff.submit(queue, {}, {});
+        cmdBuff.wait(UINT32_MAX);
+        cmdBuff.resetFence();
+      }
+
+      return image;
+    }
+
+
+    FieldSampler::FieldSampler(const Image& field, const Helpers::ABBox<2>& boundingbox, uint32_t batchSize) {
+      vec2f A = boundingbox.A();
+      vec2f extent = boundingbox.B() - boundingbox.A();
+      float n[2] = { float(field.width()), float(field.height()) };
+
+      // maps the bounding box corners to the centers of the first and last texels, as Field2DGrid does
+      for (int u = 0; u < 2; u++) {
+        m_scale[u] = (n[u] - 1.0f) / (n[u] * extent[u]);
+        m_offset[u] = 0.5f / n[u] - A[u] * m_scale[u];
+      }
+      m_scale[2] = m_scale[3] = 0.0f;
+      m_offset[2] = m_offset[3] = 0.0f;
+
+      if (field.depth() > 1) {
+        ErrorCheck::setError("A 2D field sampler needs a 2D image");
+      }
+      init(field, 2, batchSize);
+    }
+
+    FieldSampler::FieldSampler(const Image& field, const Helpers::ABBox<3>& boundingbox, uint32_t batchSize) {
+      vec3f A = boundingbox.A();
+      vec3f extent = boundingbox.B() - boundingbox.A();
+      float n[3] = { float(field.width()), float(field.height()), float(field.depth()) };
+
+      // maps the bounding box corners to the centers of the first and last texels, as Field3DGrid does
+      for (int u = 0; u < 3; u++) {
+        m_scale[u] = (n[u] - 1.0f) / (n[u] * extent[u]);
+        m_offset[u] = 0.5f / n[u] - A[u] * m_scale[u];
+      }
+      m_scale[3] = 0.0f;
+      m_offset[3] = 0.0f;
+
+      if (field.depth() <= 1) {
+        ErrorCheck::setError("A 3D field sampler needs a 3D image");
+      }
+      init(field, 3, batchSize);
+    }
+
+    void FieldSampler::init(const Image& field, uint32_t dimension, uint32_t batchSize) {
+      m_dimension = dimension;
+      // the dispatch size is limited to 65535 work groups of 64 invocations
+      m_batchSize = std::max(1u, std::min(batchSize, 65535u * 64u));
+
+      VkMemoryPropertyFlags hostMemory = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+      m_queries = std::make_unique<Buffer>(queriesHeaderSize + uint64_t(m_batchSize) * sizeof(vec4f), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostMemory, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+      m_results = std::make_unique<Buffer>(uint64_t(m_batchSize) * sizeof(vec4f), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostMemory, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+      m_descriptorSet = std::make_shared<DescriptorSet>();
+      m_descriptorSet->addTextureBuffer(field, VK_SHADER_STAGE_COMPUTE_BIT, 0);
+      m_descriptorSet->addBuffer(*m_queries, VK_SHADER_STAGE_COMPUTE_BIT, 1);
+      m_descriptorSet->addBuffer(*m_results, VK_SHADER_STAGE_COMPUTE_BIT, 2);
+
+      std::vector<unsigned char> spirv;
+      if (dimension == 2) {
+        spirv.resize(sizeof(fieldSampler2D));
+        memcpy(&spirv[0], fieldSampler2D, sizeof(fieldSampler2D));
+      }
+      else {
+        spirv.resize(sizeof(fieldSampler3D));
+        memcpy(&spirv[0], fieldSampler3D, sizeof(fieldSampler3D));
+      }
+      m_shader = std::make_unique<ComputeShaderModule>(spirv);
+
+      m_pipeline = std::make_unique<ComputePipeline>();
+      m_pipeline->setDescriptorSet(m_descriptorSet);
+      m_pipeline->setComputeModule(*m_shader);
+      m_pipeline->compile();
+    }
+
+    void FieldSampler::run(
+      const Queue& queue,
+      CommandBuffer& cmdBuff,
+      size_t count,
+      const std::function<void(size_t first, uint32_t count, float* positions)>& write,
+      const std::function<void(size_t first, uint32_t count, const float* results)>& read) {
+
+      for (size_t first = 0; first < count; first += m_batchSize) {
+        uint32_t batch = uint32_t(std::min<size_t>(m_batchSize, count - first));
+
+        float* queries = static_cast<float*>(m_queries->map());
+        memcpy(queries, &m_scale, sizeof(vec4f));
+        memcpy(queries + 4, &m_offset, sizeof(vec4f));
+        memcpy(queries + 8, &batch, sizeof(uint32_t));
+        write(first, batch, queries + queriesHeaderSize / sizeof(float));
+        m_queries->unmap();
+
+        cmdBuff.beginRecord();
+        m_pipeline->compute(cmdBuff, (batch + 63) / 64, 1, 1);
+
+        // make the results visible to the host once the fence is signaled
+        VkMemoryBarrier barrier = {
+          VK_STRUCTURE_TYPE_MEMORY_BARRIER,     // VkStructureType    sType
+          nullptr,                              // const void       * pNext
+          VK_ACCESS_SHADER_WRITE_BIT,           // VkAccessFlags      srcAccessMask
+          VK_ACCESS_HOST_READ_BIT               // VkAccessFlags      dstAccessMask
+        };
+        vkCmdPipelineBarrier(cmdBuff.getHandle(), VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        cmdBuff.endRecord();
+        cmdBuff.submit(queue, {}, {});
+        cmdBuff.wait(UINT32_MAX);
+        cmdBuff.resetFence();
+
+        const float* results = static_cast<const float*>(m_results->map());
+        read(first, batch, results);
+        m_results->unmap();
+      }
+    }
+
+  }
+}
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <functional>
+#include "Texture.h"
+#include "ComputePipeline.h"
+#include "ShaderModule.h"
+#include <LavaCake/Helpers/Field.h>
+
+namespace LavaCake {
+  namespace Framework {
+
+    /**
+      \brief describe how a field value is stored in an image texel, specialized for float, vec2f, vec3f and vec4f.
+      vec3f values are padded to 4 channels since 3 channels formats are rarely supported for sampling.
+    */
+    template<typename T>
+    struct fieldTexel;
+
+    template<>
+    struct fieldTexel<float> {
+      static constexpr uint32_t channels = 1;
+      static void pack(const float& value, float* texel) { texel[0] = value; }
+      static float unpack(const float* texel) { return texel[0]; }
+    };
+
+    template<>
+    struct fieldTexel<vec2f> {
+      static constexpr uint32_t channels = 2;
+      static void pack(const vec2f& value, float* texel) { texel[0] = value[0]; texel[1] = value[1]; }
+      static vec2f unpack(const float* texel) { return vec2f({ texel[0], texel[1] }); }
+    };
+
+    template<>
+    struct fieldTexel<vec3f> {
+      static constexpr uint32_t channels = 4;
+      static void pack(const vec3f& value, float* texel) { texel[0] = value[0]; texel[1] = value[1]; texel[2] = value[2]; texel[3] = 0.0f; }
+      static vec3f unpack(const float* texel) { return vec3f({ texel[0], texel[1], texel[2] }); }
+    };
+
+    template<>
+    struct fieldTexel<vec4f> {
+      static constexpr uint32_t channels = 4;
+      static void pack(const vec4f& value, float* texel) { texel[0] = value[0]; texel[1] = value[1]; texel[2] = value[2]; texel[3] = value[3]; }
+      static vec4f unpack(const float* texel) { return vec4f({ texel[0], texel[1], texel[2], texel[3] }); }
+    };
+
+
+    /**
+      \brief create a 32 bits float image and fill it through a staging buffer of bounded size, the image is copied in several submissions when it does not fit in the staging buffer.
+      The image gets a clamp to edge sampler, linear if the format supports linear filtering.
+      \param queue: the queue that will be used to copy data to the image
+      \param cmdBuff: the command buffer used for this operation, must not be in a recording state
+      \param width: the with of the image
+      \param height: the height of the image
+      \param depth: the depth of the image, 1 for a 2D image
+      \param channels: the number of channels of a texel, 1, 2 or 4
+      \param fill: a function writing the texels of count slices starting at first, slices are the z planes of a 3D image or the rows of a 2D image
+      \param storage: if true the image can also be used as a storage image and is left in the general layout
+      \param stageFlag: the stage in which the image will be used
+      \param maxStagingSize: the maximum size in bytes of the staging buffer
+    */
+    Image createFieldTexture(
+      const Queue& queue,
+      CommandBuffer& cmdBuff,
+      uint32_t width,
+      uint32_t height,
+      uint32_t depth,
+      uint32_t channels,
+      const std::function<void(uint32_t first, uint32_t count, float* texels)>& fill,
+      bool storage = false,
+      VkPipelineStageFlags stageFlag = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      uint64_t maxStagingSize = 64 << 20);
+
+    /**
+      \brief create an image holding the values of a 2D field
+      \param queue: the queue that will be used to copy data to the image
+      \param cmdBuff: the command buffer used for this operation, must not be in a recording state
+      \param field: the field to upload
+      \param storage: if true the image can also be used as a storage image and is left in the general layout
+      \param stageFlag: the stage in which the image will be used
+      \param maxStagingSize: the maximum size in bytes of the staging buffer
+    */
+    template<typename T>
+    Image createFieldTexture(
+      const Queue& queue,
+      CommandBuffer& cmdBuff,
+      const Helpers::Field2DGrid<T>& field,
+      bool storage = false,
+      VkPipelineStageFlags stageFlag = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      uint64_t maxStagingSize = 64 << 20) {
+
+      vec2u dim = field.getDimension();
+      const std::vector<T>& values = field.getRawField();
+      return createFieldTexture(queue, cmdBuff, dim[0], dim[1], 1, fieldTexel<T>::channels,
+        [&](uint32_t first, uint32_t count, float* texels) {
+          for (size_t i = size_t(first) * dim[0]; i < size_t(first + count) * dim[0]; i++) {
+            fieldTexel<T>::pack(values[i], texels);
+            texels += fieldTexel<T>::channels;
+          }
+        }, storage, stageFlag, maxStagingSize);
+    }
+
+    /**
+      \brief create an image holding the values of a 3D field, whatever its memory layout
+      \param queue: the queue that will be used to copy data to the image
+      \param cmdBuff: the command buffer used for this operation, must not be in a recording state
+      \param field: the field to upload
+      \param storage: if true the image can also be used as a storage image and is left in the general layout
+      \param stageFlag: the stage in which the image will be used
+      \param maxStagingSize: the maximum size in bytes of the staging buffer
+    */
+    template<typename T>
+    Image createFieldTexture(
+      const Queue& queue,
+      CommandBuffer& cmdBuff,
+      const Helpers::Field3DGrid<T>& field,
+      bool storage = false,
+      VkPipelineStageFlags stageFlag = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      uint64_t maxStagingSize = 64 << 20) {
+
+      vec3u dim = field.getDimension();
+      return createFieldTexture(queue, cmdBuff, dim[0], dim[1], dim[2], fieldTexel<T>::channels,
+        [&](uint32_t first, uint32_t count, float* texels) {
+          for (uint32_t z = first; z < first + count; z++) {
+            for (uint32_t y = 0; y < dim[1]; y++) {
+              for (uint32_t x = 0; x < dim[0]; x++) {
+                fieldTexel<T>::pack(field.at(x, y, z), texels);
+                texels += fieldTexel<T>::channels;
+              }
+            }
+          }
+        }, storage, stageFlag, maxStagingSize);
+    }
+
+
+    /**
+      Class FieldSampler :
+      \brief Sample a field uploaded with createFieldTexture at many positions with a compute shader.
+      Positions are streamed in batches through host visible buffers, the hardware trilinear filtering is used so the
+      interpolation weights have the precision of the device sampler (usually 8 bits), the same clamping as Field2DGrid
+      and Field3DGrid is applied outside of the bounding box.
+    */
+    class FieldSampler {
+    public:
+
+      /**
+        \brief create a sampler for a 2D field image
+        \param field: the image created by createFieldTexture, it must outlive the sampler
+        \param boundingbox: the bounding box of the field in the domain
+        \param batchSize: the maximum number of positions sampled in one submission
+      */
+      FieldSampler(const Image& field, const Helpers::ABBox<2>& boundingbox, uint32_t batchSize = 1 << 20);
+
+      /**
+        \brief create a sampler for a 3D field image
+        \param field: the image created by createFieldTexture, it must outlive the sampler
+        \param boundingbox: the bounding box of the field in the domain
+        \param batchSize: the maximum number of positions sampled in one submission
+      */
+      FieldSampler(const Image& field, const Helpers::ABBox<3>& boundingbox, uint32_t batchSize = 1 << 20);
+
+      FieldSampler(const FieldSampler&) = delete;
+      FieldSampler& operator=(const FieldSampler&) = delete;
+
+      /**
+        \brief sample a 2D field, the results are converted to the field value type
+        \param queue: the queue used for the computation, it must support compute operations
+        \param cmdBuff: the command buffer used for this operation, must not be in a recording state
+        \param positions: the sample positions
+        \param results: the sampled values, must be as large as positions
+      */
+      template<typename T>
+      void sample(const Queue& queue, CommandBuffer& cmdBuff, std::span<const vec2f> positions, std::span<T> results) {
+        if (m_dimension != 2) {
+          ErrorCheck::setError("The field sampler was not created for a 2D field");
+          return;
+        }
+        run(queue, cmdBuff, positions.size(),
+          [&](size_t first, uint32_t count, float* dst) {
+            for (uint32_t i = 0; i < count; i++) {
+              dst[4 * i] = positions[first + i][0];
+              dst[4 * i + 1] = positions[first + i][1];
+              dst[4 * i + 2] = 0.0f;
+              dst[4 * i + 3] = 0.0f;
+            }
+          },
+          [&](size_t first, uint32_t count, const float* src) {
+            for (uint32_t i = 0; i < count; i++) {
+              results[first + i] = fieldTexel<T>::unpack(src + 4 * i);
+            }
+          });
+      }
+
+      /**
+        \brief sample a 3D field, the results are converted to the field value type
+        \param queue: the queue used for the computation, it must support compute operations
+        \param cmdBuff: the command buffer used for this operation, must not be in a recording state
+        \param positions: the sample positions
+        \param results: the sampled values, must be as large as positions
+      */
+      template<typename T>
+      void sample(const Queue& queue, CommandBuffer& cmdBuff, std::span<const vec3f> positions, std::span<T> results) {
+        if (m_dimension != 3) {
+          ErrorCheck::setError("The field sampler was not created for a 3D field");
+          return;
+        }
+        run(queue, cmdBuff, positions.size(),
+          [&](size_t first, uint32_t count, float* dst) {
+            for (uint32_t i = 0; i < count; i++) {
+              dst[4 * i] = positions[first + i][0];
+              dst[4 * i + 1] = positions[first + i][1];
+              dst[4 * i + 2] = positions[first + i][2];
+              dst[4 * i + 3] = 0.0f;
+            }
+          },
+          [&](size_t first, uint32_t count, const float* src) {
+            for (uint32_t i = 0; i < count; i++) {
+              results[first + i] = fieldTexel<T>::unpack(src + 4 * i);
+            }
+          });
+      }
+
+    private:
+
+      void init(const Image& field, uint32_t dimension, uint32_t batchSize);
+
+      void run(
+        const Queue& queue,
+        CommandBuffer& cmdBuff,
+        size_t count,
+        const std::function<void(size_t first, uint32_t count, float* positions)>& write,
+        const std::function<void(size_t first, uint32_t count, const float* results)>& read);
+
+      uint32_t                                          m_dimension = 0;
+      uint32_t                                          m_batchSize = 0;
+      vec4f                                             m_scale;
+      vec4f                                             m_offset;
+
+      std::unique_ptr<Buffer>                           m_queries;
+      std::unique_ptr<Buffer>                           m_results;
+
+      std::shared_ptr<DescriptorSet>                    m_descriptorSet;
+      std::unique_ptr<ComputeShaderModule>              m_shader;
+      std::unique_ptr<ComputePipeline>                  m_pipeline;
+    };
+
+  }
+}
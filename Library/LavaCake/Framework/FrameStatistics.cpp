@@ -0,0 +1,98 @@
+#include "FrameStatistics.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace LavaCake {
+  namespace Framework {
+
+    namespace {
+      typedef std::array<std::atomic<uint64_t>, COUNTER_COUNT> threadCounterArray;
+
+      // the counters are shared with the registry so the work of a thread is still counted after it ends
+      struct counterRegistry {
+        std::mutex                                          mutex;
+        std::vector<std::shared_ptr<threadCounterArray>>    threads;
+        frameStatistics                                     previousTotal;
+        frameStatistics                                     lastFrame;
+        uint64_t                                            frameCount = 0;
+      };
+
+      counterRegistry& registry() {
+        static counterRegistry r;
+        return r;
+      }
+
+      std::shared_ptr<threadCounterArray> registerThread() {
+        auto counters = std::make_shared<threadCounterArray>();
+        for (auto& c : *counters) {
+          c.store(0, std::memory_order_relaxed);
+        }
+        counterRegistry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.threads.push_back(counters);
+        return counters;
+      }
+
+      frameStatistics sum(const counterRegistry& r) {
+        frameStatistics total;
+        for (auto& counters : r.threads) {
+          for (size_t i = 0; i < COUNTER_COUNT; i++) {
+            total.counters[i] += (*counters)[i].load(std::memory_order_relaxed);
+          }
+        }
+        return total;
+      }
+    }
+
+    std::array<std::atomic<uint64_t>, COUNTER_COUNT>& FrameStatistics::threadCounters() {
+      thread_local std::shared_ptr<threadCounterArray> counters = registerThread();
+      return *counters;
+    }
+
+    void FrameStatistics::endFrame() {
+      counterRegistry& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      frameStatistics total = sum(r);
+      for (size_t i = 0; i < COUNTER_COUNT; i++) {
+        r.lastFrame.counters[i] = total.counters[i] - r.previousTotal.counters[i];
+      }
+      r.previousTotal = total;
+      r.frameCount++;
+    }
+
+    frameStatistics FrameStatistics::getLastFrame() {
+      counterRegistry& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      return r.lastFrame;
+    }
+
+    frameStatistics FrameStatistics::getTotal() {
+      counterRegistry& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      return sum(r);
+    }
+
+    uint64_t FrameStatistics::getFrameCount() {
+      counterRegistry& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      return r.frameCount;
+    }
+
+    const char* FrameStatistics::getName(frameCounter counter) {
+      switch (counter) {
+      case COUNTER_DRAW_CALLS:        return "draw calls";
+      case COUNTER_DISPATCHES:        return "dispatches";
+      case COUNTER_PIPELINE_BINDS:    return "pipeline binds";
+      case COUNTER_DESCRIPTOR_BINDS:  return "descriptor binds";
+      case COUNTER_BARRIERS:          return "barriers";
+      case COUNTER_UPLOADED_BYTES:    return "uploaded bytes";
+      case COUNTER_ALLOCATIONS:       return "allocations";
+      case COUNTER_FREES:             return "frees";
+      case COUNTER_SUBMITS:           return "submits";
+      default:                        return "unknown";
+      }
+    }
+
+  }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace LavaCake {
+  namespace Framework {
+
+    /**
+    \brief the events counted by FrameStatistics
+    */
+    enum frameCounter {
+      COUNTER_DRAW_CALLS,             /*!< the draw commands recorded */
+      COUNTER_DISPATCHES,             /*!< the compute dispatches and ray tracing launches recorded */
+      COUNTER_PIPELINE_BINDS,         /*!< the pipelines bound */
+      COUNTER_DESCRIPTOR_BINDS,       /*!< the vkCmdBindDescriptorSets calls */
+      COUNTER_BARRIERS,               /*!< the buffer and image barriers recorded */
+      COUNTER_UPLOADED_BYTES,         /*!< the bytes written by the host in mapped buffers, staging buffers included */
+      COUNTER_ALLOCATIONS,            /*!< the device memory allocations */
+      COUNTER_FREES,                  /*!< the device memory frees */
+      COUNTER_SUBMITS,                /*!< the command buffers submitted */
+      COUNTER_COUNT
+    };
+
+    /**
+    \brief the value of every counter over a frame or since the start of the application
+    */
+    struct frameStatistics {
+      std::array<uint64_t, COUNTER_COUNT>   counters = {};    /*!< the value of each counter, indexed by frameCounter */
+
+      uint64_t operator[](frameCounter counter) const {
+        return counters[counter];
+      }
+    };
+
+    /**
+      Class FrameStatistics :
+      \brief Count the work recorded and the resources created by the framework.
+      Each thread increments its own counters without locking, endFrame sums the counters of every thread and keeps the
+      difference with the previous call as the statistics of the frame.
+    */
+    class FrameStatistics {
+    public:
+
+      /**
+        \brief add a value to a counter of the calling thread
+        \param counter : the counter
+        \param value : (optional) the value added
+      */
+      static void add(frameCounter counter, uint64_t value = 1) {
+        // only the calling thread writes its counters, endFrame reads them
+        std::atomic<uint64_t>& c = threadCounters()[counter];
+        c.store(c.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+      }
+
+      /**
+        \brief get the counters of the calling thread, created on the first call of each thread
+      */
+      static std::array<std::atomic<uint64_t>, COUNTER_COUNT>& threadCounters();
+
+      /**
+        \brief close the current frame, the work counted since the previous call becomes the statistics of the last frame
+      */
+      static void endFrame();
+
+      /**
+        \brief get the statistics of the frame closed by the last call to endFrame
+      */
+      static frameStatistics getLastFrame();
+
+      /**
+        \brief get the counters summed over every thread since the start of the application
+      */
+      static frameStatistics getTotal();
+
+      /**
+        \brief get the number of frames closed by endFrame
+      */
+      static uint64_t getFrameCount();
+
+      /**
+        \brief get a readable name of a counter
+        \param counter : the counter
+      */
+      static const char* getName(frameCounter counter);
+    };
+
+  }
+}
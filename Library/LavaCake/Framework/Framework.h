@@ -1,6 +1,8 @@
 #pragma once
 #include "Device.h"
 #include "Buffer.h"
+#include "Barrier.h"
+#include "Readback.h"
 #include "Common.h"
 #include "AllHeaders.h"
 #include "SwapChain.h"
@@ -10,9 +12,16 @@
 #include "GraphicPipeline.h"
 #include "ComputePipeline.h"
 #include "RenderPass.h"
+#include "RenderGraph.h"
 #include "ErrorCheck.h"
 #include "UniformBuffer.h"
+#include "UniformArena.h"
 #include "Texture.h"
+#include "FieldTexture.h"
+#include "FrameStatistics.h"
+#include "MemoryBudget.h"
+#include "SamplerCache.h"
 #include "Constant.h"
 #include "CommandBuffer.h"
 #include "ImGuiWrapper.h"
+#include "GPUProfiler.h"
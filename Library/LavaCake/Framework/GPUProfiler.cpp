@@ -0,0 +1,221 @@
+#include "GPUProfiler.h"
+#include <LavaCake/Helpers/Trace.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace LavaCake {
+  namespace Framework {
+
+    GPUProfiler::GPUProfiler(const Queue& queue, uint32_t maxScopes, uint32_t frameLatency, uint32_t historySize) {
+      Device* d = Device::getDevice();
+      VkDevice logical = d->getLogicalDevice();
+      VkPhysicalDevice physical = d->getPhysicalDevice();
+
+      m_maxScopes = std::max(maxScopes, 1u);
+      m_frameLatency = std::max(frameLatency, 1u);
+      m_historySize = std::max(historySize, 1u);
+      m_pending.resize(m_frameLatency);
+
+      VkPhysicalDeviceProperties properties;
+      vkGetPhysicalDeviceProperties(physical, &properties);
+      m_period = properties.limits.timestampPeriod;
+
+      uint32_t queueFamiliesCount = 0;
+      vkGetPhysicalDeviceQueueFamilyProperties(physical, &queueFamiliesCount, nullptr);
+      std::vector<VkQueueFamilyProperties> queueFamilies(queueFamiliesCount);
+      vkGetPhysicalDeviceQueueFamilyProperties(physical, &queueFamiliesCount, queueFamilies.data());
+
+      uint32_t validBits = queue.getIndex() < queueFamiliesCount ? queueFamilies[queue.getIndex()].timestampValidBits : 0;
+      if (validBits == 0) {
+        ErrorCheck::setError("The queue of the GPUProfiler does not support timestamps", 1);
+        return;
+      }
+      m_validMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+      VkQueryPoolCreateInfo query_pool_create_info = {
+        VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,         // VkStructureType                  sType
+        nullptr,                                          // const void                     * pNext
+        0,                                                // VkQueryPoolCreateFlags           flags
+        VK_QUERY_TYPE_TIMESTAMP,                          // VkQueryType                      queryType
+        m_frameLatency * m_maxScopes * 2,                 // uint32_t                         queryCount
+        0                                                 // VkQueryPipelineStatisticFlags    pipelineStatistics
+      };
+
+      VkResult result = vkCreateQueryPool(logical, &query_pool_create_info, nullptr, &m_queryPool);
+      if (VK_SUCCESS != result) {
+        ErrorCheck::setError("Could not create the query pool of the GPUProfiler");
+        m_queryPool = VK_NULL_HANDLE;
+        return;
+      }
+      m_enabled = true;
+    }
+
+    void GPUProfiler::beginFrame(CommandBuffer& cmdBuff) {
+      if (!m_enabled) {
+        return;
+      }
+      if (m_frameStarted) {
+        m_frame = (m_frame + 1) % m_frameLatency;
+      }
+      m_frameStarted = true;
+      m_depth = 0;
+
+      collect(m_frame);
+      m_pending[m_frame].clear();
+      vkCmdResetQueryPool(cmdBuff.getHandle(), m_queryPool, m_frame * m_maxScopes * 2, m_maxScopes * 2);
+    }
+
+    uint32_t GPUProfiler::beginScope(CommandBuffer& cmdBuff, const std::string& name, VkPipelineStageFlagBits stage) {
+      if (!m_enabled || !m_frameStarted) {
+        return UINT32_MAX;
+      }
+      std::vector<scopeRecord>& scopes = m_pending[m_frame];
+      if (scopes.size() >= m_maxScopes) [[unlikely]] {
+        ErrorCheck::setError("Too many scopes in a frame of the GPUProfiler", 1);
+        return UINT32_MAX;
+      }
+
+      uint32_t scope = static_cast<uint32_t>(scopes.size());
+      vkCmdWriteTimestamp(cmdBuff.getHandle(), stage, m_queryPool, (m_frame * m_maxScopes + scope) * 2);
+      scopes.push_back({ name, m_depth, false });
+      m_depth++;
+      return scope;
+    }
+
+    void GPUProfiler::endScope(CommandBuffer& cmdBuff, uint32_t scope, VkPipelineStageFlagBits stage) {
+      if (!m_enabled || scope >= m_pending[m_frame].size()) {
+        return;
+      }
+      vkCmdWriteTimestamp(cmdBuff.getHandle(), stage, m_queryPool, (m_frame * m_maxScopes + scope) * 2 + 1);
+      m_pending[m_frame][scope].closed = true;
+      if (m_depth > 0) {
+        m_depth--;
+      }
+    }
+
+    void GPUProfiler::collect(uint32_t frame) {
+      const std::vector<scopeRecord>& scopes = m_pending[frame];
+      if (scopes.empty()) {
+        return;
+      }
+
+      Device* d = Device::getDevice();
+      VkDevice logical = d->getLogicalDevice();
+
+      // each query gives its value followed by its availability
+      uint32_t queryCount = static_cast<uint32_t>(scopes.size()) * 2;
+      std::vector<uint64_t> results(queryCount * 2);
+      VkResult result = vkGetQueryPoolResults(logical, m_queryPool, frame * m_maxScopes * 2, queryCount,
+        results.size() * sizeof(uint64_t), results.data(), 2 * sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+      if (result != VK_SUCCESS && result != VK_NOT_READY) {
+        ErrorCheck::setError("Could not read the queries of the GPUProfiler", 1);
+        return;
+      }
+
+      std::vector<gpuTiming> timings;
+      timings.reserve(scopes.size());
+      for (size_t i = 0; i < scopes.size(); i++) {
+        // a scope left open has no end, the other ones must all be available or the frame is still executing
+        if (!scopes[i].closed) {
+          continue;
+        }
+        uint64_t begin = results[i * 4];
+        uint64_t end = results[i * 4 + 2];
+        if (results[i * 4 + 1] == 0 || results[i * 4 + 3] == 0) {
+          m_droppedFrames++;
+          return;
+        }
+        begin &= m_validMask;
+        end &= m_validMask;
+        if (!m_hasOrigin) {
+          m_origin = begin;
+          m_hasOrigin = true;
+        }
+
+        gpuTiming timing;
+        timing.name = scopes[i].name;
+        timing.depth = scopes[i].depth;
+        timing.start = (double(begin) - double(m_origin)) * m_period / 1e6;
+        timing.duration = double((end - begin) & m_validMask) * m_period / 1e6;
+        timings.push_back(timing);
+      }
+
+      m_history.push_back(std::move(timings));
+      while (m_history.size() > m_historySize) {
+        m_history.pop_front();
+      }
+    }
+
+    const std::vector<gpuTiming>& GPUProfiler::getLastFrame() const {
+      if (m_history.empty()) {
+        return m_empty;
+      }
+      return m_history.back();
+    }
+
+    std::vector<gpuScopeStatistics> GPUProfiler::summary() const {
+      std::vector<std::string> names;
+      std::vector<std::vector<double>> durations;
+      for (auto& frame : m_history) {
+        for (auto& timing : frame) {
+          size_t i = std::find(names.begin(), names.end(), timing.name) - names.begin();
+          if (i == names.size()) {
+            names.push_back(timing.name);
+            durations.push_back({});
+          }
+          durations[i].push_back(timing.duration);
+        }
+      }
+
+      std::vector<gpuScopeStatistics> statistics(names.size());
+      for (size_t i = 0; i < names.size(); i++) {
+        std::vector<double>& values = durations[i];
+        std::sort(values.begin(), values.end());
+        double sum = 0.0;
+        for (double v : values) {
+          sum += v;
+        }
+        size_t p99 = size_t(std::ceil(0.99 * double(values.size()))) - 1;
+
+        statistics[i].name = names[i];
+        statistics[i].count = static_cast<uint32_t>(values.size());
+        statistics[i].min = values.front();
+        statistics[i].avg = sum / double(values.size());
+        statistics[i].p99 = values[p99];
+      }
+      return statistics;
+    }
+
+    void GPUProfiler::writeChromeTrace(std::ostream& out) const {
+      Helpers::ChromeTraceWriter writer(out);
+      for (auto& frame : m_history) {
+        for (auto& timing : frame) {
+          // the timings are in milliseconds, the trace in microseconds
+          writer.complete(timing.name, "gpu", 0, timing.start * 1000.0, timing.duration * 1000.0);
+        }
+      }
+    }
+
+    bool GPUProfiler::exportChromeTrace(const std::string& filename) const {
+      std::ofstream ofs;
+      ofs.open(filename, std::ofstream::out | std::ofstream::trunc);
+      if (!ofs.is_open()) {
+        ErrorCheck::setError("Could not open the file of the GPU trace", 1);
+        return false;
+      }
+      writeChromeTrace(ofs);
+      return ofs.good();
+    }
+
+    GPUProfiler::~GPUProfiler() {
+      if (m_queryPool != VK_NULL_HANDLE) {
+        Device* d = Device::getDevice();
+        VkDevice logical = d->getLogicalDevice();
+        vkDestroyQueryPool(logical, m_queryPool, nullptr);
+      }
+    }
+
+  }
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <deque>
+#include <ostream>
+#include <string>
+#include "CommandBuffer.h"
+#include "Queue.h"
+
+namespace LavaCake {
+  namespace Framework {
+
+    /**
+    \brief the GPU time spent in a named scope during one frame
+    */
+    struct gpuTiming {
+      std::string   name;                     /*!< the name of the scope */
+      uint32_t      depth = 0;                /*!< the number of scopes opened around this one */
+      double        start = 0.0;              /*!< the beginning of the scope in milliseconds, relative to the first timestamp of the profiler */
+      double        duration = 0.0;           /*!< the duration of the scope in milliseconds */
+    };
+
+    /**
+    \brief the GPU time spent in a named scope over the frames kept by the profiler
+    */
+    struct gpuScopeStatistics {
+      std::string   name;                     /*!< the name of the scope */
+      uint32_t      count = 0;                /*!< the number of times the scope was measured */
+      double        min = 0.0;                /*!< the shortest duration in milliseconds */
+      double        avg = 0.0;                /*!< the average duration in milliseconds */
+      double        p99 = 0.0;                /*!< the 99th percentile of the duration in milliseconds */
+    };
+
+    /**
+      Class GPUProfiler :
+      \brief Measure the GPU time of named scopes with timestamp queries.
+      Each frame writes its timestamps in its own part of a query pool, the results of a frame are read when its part is
+      reused frameLatency frames later, without waiting for the device: a frame whose results are not available yet is dropped.
+      The measured frames are kept to be exported as a Chrome trace or summarized per scope.
+    */
+    class GPUProfiler {
+    public:
+
+      /**
+        \brief create a profiler
+        \param queue : the queue the profiled command buffers are submitted to, it must support timestamps
+        \param maxScopes : (optional) the maximum number of scopes measured in a frame
+        \param frameLatency : (optional) the number of frames between the recording of the timestamps and their reading
+        \param historySize : (optional) the number of measured frames kept for the summary and the trace
+      */
+      GPUProfiler(const Queue& queue, uint32_t maxScopes = 256, uint32_t frameLatency = 3, uint32_t historySize = 240);
+
+      GPUProfiler(const GPUProfiler&) = delete;
+      GPUProfiler& operator=(const GPUProfiler&) = delete;
+
+      /**
+        \brief start a new frame, collect the results of the frame recorded frameLatency frames ago and reset its queries
+        \param cmdBuff : the command buffer of the frame, must be in a recording state and outside of a render pass
+      */
+      void beginFrame(CommandBuffer& cmdBuff);
+
+      /**
+        \brief open a named scope
+        \param cmdBuff : the command buffer used for this operation, must be in a recording state
+        \param name : the name of the scope
+        \param stage : (optional) the stage the timestamp is written at
+        \return the index of the scope to close, UINT32_MAX if the scope is not measured
+      */
+      uint32_t beginScope(CommandBuffer& cmdBuff, const std::string& name, VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+
+      /**
+        \brief close a scope opened by beginScope
+        \param cmdBuff : the command buffer used for this operation, must be in a recording state
+        \param scope : the index returned by beginScope
+        \param stage : (optional) the stage the timestamp is written at
+      */
+      void endScope(CommandBuffer& cmdBuff, uint32_t scope, VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+      /**
+        \brief enable or disable the profiler, a disabled profiler records no command
+      */
+      void setEnabled(bool enabled) {
+        m_enabled = enabled && m_queryPool != VK_NULL_HANDLE;
+      }
+
+      /**
+        \brief check if the profiler records timestamps
+      */
+      bool isEnabled() const {
+        return m_enabled;
+      }
+
+      /**
+        \brief get the timings of the last frame whose results were read
+      */
+      const std::vector<gpuTiming>& getLastFrame() const;
+
+      /**
+        \brief get the number of frames dropped because their results were not available in time
+      */
+      uint32_t getDroppedFrames() const {
+        return m_droppedFrames;
+      }
+
+      /**
+        \brief compute the min, average and 99th percentile duration of every scope over the kept frames
+        \return the statistics of each scope, in the order the scopes first appear
+      */
+      std::vector<gpuScopeStatistics> summary() const;
+
+      /**
+        \brief write the kept frames in the Chrome trace event format, readable by chrome://tracing or Perfetto
+        \param out : the stream the JSON is written to
+      */
+      void writeChromeTrace(std::ostream& out) const;
+
+      /**
+        \brief write the kept frames in a Chrome trace file
+        \param filename : the path of the file
+        \return true if the file was written
+      */
+      bool exportChromeTrace(const std::string& filename) const;
+
+      ~GPUProfiler();
+
+    private:
+
+      struct scopeRecord {
+        std::string   name;
+        uint32_t      depth;
+        bool          closed;
+      };
+
+      void collect(uint32_t frame);
+
+      VkQueryPool                                               m_queryPool = VK_NULL_HANDLE;
+      uint32_t                                                  m_maxScopes = 0;
+      uint32_t                                                  m_frameLatency = 0;
+      uint32_t                                                  m_historySize = 0;
+      double                                                    m_period = 1.0;
+      uint64_t                                                  m_validMask = ~0ull;
+      uint64_t                                                  m_origin = 0;
+      bool                                                      m_hasOrigin = false;
+      bool                                                      m_enabled = false;
+
+      uint32_t                                                  m_frame = 0;
+      bool                                                      m_frameStarted = false;
+      uint32_t                                                  m_depth = 0;
+      // the scopes recorded in each part of the pool, waiting for their results
+      std::vector<std::vector<scopeRecord>>                     m_pending;
+      std::deque<std::vector<gpuTiming>>                        m_history;
+      std::vector<gpuTiming>                                    m_empty;
+      uint32_t                                                  m_droppedFrames = 0;
+    };
+
+    /**
+      Class GPUScope :
+      \brief open a scope of a GPUProfiler for the lifetime of the object
+    */
+    class GPUScope {
+    public:
+
+      /**
+        \brief open a scope, nothing is recorded if the profiler is null or disabled
+        \param profiler : the profiler
+        \param cmdBuff : the command buffer used for this operation, must be in a recording state until the scope is destroyed
+        \param name : the name of the scope
+      */
+      GPUScope(GPUProfiler* profiler, CommandBuffer& cmdBuff, const std::string& name) : m_profiler(profiler), m_commandBuffer(cmdBuff) {
+        if (m_profiler != nullptr && m_profiler->isEnabled()) {
+          m_scope = m_profiler->beginScope(cmdBuff, name);
+        }
+      }
+
+      GPUScope(const GPUScope&) = delete;
+      GPUScope& operator=(const GPUScope&) = delete;
+
+      ~GPUScope() {
+        if (m_scope != UINT32_MAX) {
+          m_profiler->endScope(m_commandBuffer, m_scope);
+        }
+      }
+
+    private:
+      GPUProfiler*                                              m_profiler;
+      CommandBuffer&                                            m_commandBuffer;
+      uint32_t                                                  m_scope = UINT32_MAX;
+    };
+
+  }
+}
@@ -1,4 +1,5 @@
 #include "GraphicPipeline.h"
+#include <LavaCake/Helpers/Trace.h>
 
 namespace LavaCake {
   namespace Framework {
@@ -138,6 +139,7 @@ namespace LavaCake {
     }
 
     void GraphicPipeline::compile(VkRenderPass& renderpass, uint16_t nbColorAttachments) {
+      LAVACAKE_TRACE_ZONE("GraphicPipeline::compile");
       Device* d = Device::getDevice();
       const VkDevice& logical = d->getLogicalDevice();
       generateDescriptorLayout();
@@ -317,6 +319,7 @@ namespace LavaCake {
       if (!m_vertexInfoSet) {
           setVerticesInfo(buffer[0]->getBindingDescriptions(), buffer[0]->getAttributeDescriptions(), buffer[0]->primitiveTopology());
       }
+      updateBounds();
     }
 
 
@@ -325,11 +328,30 @@ namespace LavaCake {
       if (!m_vertexInfoSet) {
           setVerticesInfo(vertexBufferConstants[0].buffer->getBindingDescriptions(), vertexBufferConstants[0].buffer->getAttributeDescriptions(), vertexBufferConstants[0].buffer->primitiveTopology());
       }
+      updateBounds();
+    }
+
+    void GraphicPipeline::setFrustum(const mat4& viewProjection) {
+      m_frustum = Helpers::Frustum(viewProjection);
+      m_frustumCulling = true;
+    }
+
+    void GraphicPipeline::updateBounds() {
+      std::vector<Helpers::ABBox<3>> boxes;
+      m_hierarchyIndices.assign(m_vertexBuffers.size(), UINT32_MAX);
+      for (size_t i = 0; i < m_vertexBuffers.size(); i++) {
+        if (m_vertexBuffers[i].buffer && m_vertexBuffers[i].buffer->hasABBox()) {
+          m_hierarchyIndices[i] = (uint32_t)boxes.size();
+          boxes.push_back(Helpers::TransformBox(m_vertexBuffers[i].buffer->getABBox(), m_vertexBuffers[i].model));
+        }
+      }
+      m_sceneHierarchy.build(boxes);
     }
 
 
 
     void GraphicPipeline::draw(CommandBuffer& buffer) {
+      LAVACAKE_TRACE_ZONE("GraphicPipeline::draw");
       vkCmdSetViewport(buffer.getHandle(), 0, 1, &m_viewports[0]);
 
       vkCmdSetScissor(buffer.getHandle(), 0, 1, &m_scissors[0]);
@@ -338,8 +360,21 @@ namespace LavaCake {
         vkCmdSetLineWidth(buffer.getHandle(), m_lineWidth);
       }
 
+      m_visibleCount = 0;
+      m_culledCount = 0;
+      if (m_frustumCulling) {
+        m_sceneHierarchy.cull(m_frustum, m_visibility, m_cullScratch);
+      }
+
+      uint32_t draws = 0;
+      uint32_t descriptorBinds = 0;
       for (uint32_t i = 0; i < m_vertexBuffers.size(); i++) {
-        if (!m_vertexBuffers[i].buffer->getVertexBuffer() || m_vertexBuffers[i].buffer->getVertexBuffer()->getHandle() == VK_NULL_HANDLE)return;
+        if (!m_vertexBuffers[i].buffer->getVertexBuffer() || m_vertexBuffers[i].buffer->getVertexBuffer()->getHandle() == VK_NULL_HANDLE)break;
+        if (m_frustumCulling && m_hierarchyIndices[i] != UINT32_MAX && !m_visibility[m_hierarchyIndices[i]]) {
+          m_culledCount++;
+          continue;
+        }
+        m_visibleCount++;
         VkDeviceSize size(0);
         vkCmdBindVertexBuffers(buffer.getHandle(), 0, static_cast<uint32_t>(1), &m_vertexBuffers[i].buffer->getVertexBuffer()->getHandle(), &size);
         if (m_vertexBuffers[i].buffer->isIndexed()) {
@@ -348,12 +383,19 @@ namespace LavaCake {
 
         std::vector<VkDescriptorSet> descriptorSets = { m_descriptorSet->getHandle() };
         if (!m_descriptorSet->isEmpty()) {
+          const std::vector<uint32_t>& dynamicOffsets = m_vertexBuffers[i].dynamic_offsets;
+          if (dynamicOffsets.size() != m_descriptorSet->getDynamicBufferCount()) [[unlikely]] {
+            ErrorCheck::setError("The number of dynamic offsets of a vertex buffer does not match the dynamic buffers of the descriptor set");
+            continue;
+          }
           vkCmdBindDescriptorSets(buffer.getHandle(), VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0,
             static_cast<uint32_t>(descriptorSets.size()), descriptorSets.data(),
-            0, {});
+            static_cast<uint32_t>(dynamicOffsets.size()), dynamicOffsets.data());
+          descriptorBinds++;
         }
 
         vkCmdBindPipeline(buffer.getHandle(), VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline);
+        draws++;
 
         for (auto& constant_range : m_vertexBuffers[i].constant_ranges) {
           if (constant_range.constant) {
@@ -381,6 +423,11 @@ namespace LavaCake {
         }
 
       }
+
+      // every drawn vertex buffer binds the pipeline and records one draw
+      FrameStatistics::add(COUNTER_DRAW_CALLS, draws);
+      FrameStatistics::add(COUNTER_PIPELINE_BINDS, draws);
+      FrameStatistics::add(COUNTER_DESCRIPTOR_BINDS, descriptorBinds);
     }
 
     void GraphicPipeline::setCullMode(VkCullModeFlagBits cullMode) {
@@ -1,6 +1,7 @@
 #pragma once
 #include "AllHeaders.h"
 #include "Pipeline.h"
+#include <LavaCake/Helpers/Culling.h>
 
 
 namespace LavaCake {
@@ -14,6 +15,10 @@ namespace LavaCake {
     struct vertexBufferConstant {
       std::shared_ptr<VertexBuffer> buffer;
       std::vector<constantRange> constant_ranges;
+      // object to world transformation of the vertex buffer, only used for frustum culling
+      mat4 model = Identity();
+      // offsets of the dynamic buffers of the descriptor set, in the order of their bindings
+      std::vector<uint32_t> dynamic_offsets;
     };
 
     /**
@@ -111,6 +116,39 @@ namespace LavaCake {
       */
       void draw(CommandBuffer& cmdBuff);
 
+      /**
+      \brief Enable frustum culling, vertex buffers whose bounding box is outside the frustum are not drawn
+      \param viewProjection the projection matrix multiplied by the view matrix used to render the vertex buffers
+      */
+      void setFrustum(const mat4& viewProjection);
+
+      /**
+      \brief Disable frustum culling, every vertex buffer will be drawn
+      */
+      void disableFrustumCulling() {
+        m_frustumCulling = false;
+      }
+
+      /**
+      \brief Rebuild the scene hierarchy used for frustum culling from the vertex buffers bounding boxes and models,
+      it is called by setVertices
+      */
+      void updateBounds();
+
+      /**
+      \brief get the number of vertex buffers drawn by the last call to draw
+      */
+      uint32_t getVisibleCount() const {
+        return m_visibleCount;
+      }
+
+      /**
+      \brief get the number of vertex buffers skipped by frustum culling during the last call to draw
+      */
+      uint32_t getCulledCount() const {
+        return m_culledCount;
+      }
+
       /**
       \brief Set the cull mode for the pipeline, if not set the pipeline cull the back faces
       */
@@ -216,6 +254,16 @@ namespace LavaCake {
       bool                                                  m_compiled = false;
       pipelineType                                          m_type = Undefined;
 
+      bool                                                  m_frustumCulling = false;
+      Helpers::Frustum                                      m_frustum;
+      Helpers::SceneHierarchy                               m_sceneHierarchy;
+      // index of each vertex buffer in the scene hierarchy, UINT32_MAX if it has no bounding box
+      std::vector<uint32_t>                                 m_hierarchyIndices;
+      std::vector<uint8_t>                                  m_visibility;
+      Helpers::cullScratch                                  m_cullScratch;
+      uint32_t                                              m_visibleCount = 0;
+      uint32_t                                              m_culledCount = 0;
+
 
 
     };
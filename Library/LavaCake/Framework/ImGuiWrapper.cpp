@@ -244,6 +244,73 @@ namespace LavaCake {
 
 
 
+    void ImGuiWrapper::showFrameStatistics(bool* open) const {
+      if (!ImGui::Begin("Frame statistics", open)) {
+        ImGui::End();
+        return;
+      }
+
+      frameStatistics frame = FrameStatistics::getLastFrame();
+      frameStatistics total = FrameStatistics::getTotal();
+      ImGui::Text("frame %llu", (unsigned long long)FrameStatistics::getFrameCount());
+      ImGui::Separator();
+      ImGui::Columns(3);
+      ImGui::Text("counter");
+      ImGui::NextColumn();
+      ImGui::Text("last frame");
+      ImGui::NextColumn();
+      ImGui::Text("total");
+      ImGui::NextColumn();
+      for (uint32_t i = 0; i < COUNTER_COUNT; i++) {
+        ImGui::Text("%s", FrameStatistics::getName(frameCounter(i)));
+        ImGui::NextColumn();
+        ImGui::Text("%llu", (unsigned long long)frame.counters[i]);
+        ImGui::NextColumn();
+        ImGui::Text("%llu", (unsigned long long)total.counters[i]);
+        ImGui::NextColumn();
+      }
+      ImGui::Columns(1);
+      ImGui::Separator();
+      // memory still allocated, a value growing every frame is a leak
+      ImGui::Text("live allocations %lld", (long long)(total[COUNTER_ALLOCATIONS] - total[COUNTER_FREES]));
+      ImGui::End();
+    }
+
+    void ImGuiWrapper::showMemoryBudget(bool* open) const {
+      if (!ImGui::Begin("Memory budget", open)) {
+        ImGui::End();
+        return;
+      }
+
+      const float mb = 1024.0f * 1024.0f;
+      std::vector<heapBudget> heaps = MemoryBudget::getHeapBudgets();
+      for (uint32_t i = 0; i < heaps.size(); i++) {
+        const heapBudget& h = heaps[i];
+        ImGui::Text("heap %u%s : %.1f / %.1f MB, %.1f MB allocated by LavaCake", i, h.deviceLocal ? " (device local)" : "",
+          float(h.usage) / mb, float(h.budget) / mb, float(h.allocated) / mb);
+        ImGui::ProgressBar(h.budget > 0 ? float(double(h.usage) / double(h.budget)) : 0.0f);
+      }
+      ImGui::Separator();
+      ImGui::Columns(3);
+      ImGui::Text("category");
+      ImGui::NextColumn();
+      ImGui::Text("allocations");
+      ImGui::NextColumn();
+      ImGui::Text("MB");
+      ImGui::NextColumn();
+      for (uint32_t i = 0; i < MEMORY_CATEGORY_COUNT; i++) {
+        categoryUsage usage = MemoryBudget::getCategoryUsage(memoryCategory(i));
+        ImGui::Text("%s", MemoryBudget::getName(memoryCategory(i)));
+        ImGui::NextColumn();
+        ImGui::Text("%llu", (unsigned long long)usage.allocations);
+        ImGui::NextColumn();
+        ImGui::Text("%.1f", float(usage.bytes) / mb);
+        ImGui::NextColumn();
+      }
+      ImGui::Columns(1);
+      ImGui::End();
+    }
+
     void ImGuiWrapper::resizeGui(const vec2i& windowSize, const vec2i& frameBufferSize) {
 
 
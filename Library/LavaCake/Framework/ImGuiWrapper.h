@@ -40,6 +40,20 @@ namespace LavaCake {
        */
       void resizeGui(const vec2i& windowSize, const vec2i& frameBufferSize);
 
+      /**
+       \brief Show the FrameStatistics counters of the last frame and since the start of the application in an ImGui window,
+       must be called between ImGui::NewFrame and prepareGui
+       \param open : (optional) a pointer to a boolean closing the window when the user clicks its close button
+       */
+      void showFrameStatistics(bool* open = nullptr) const;
+
+      /**
+       \brief Show the budget and the usage of each memory heap and the live allocations of each MemoryBudget category in an ImGui window,
+       must be called between ImGui::NewFrame and prepareGui
+       \param open : (optional) a pointer to a boolean closing the window when the user clicks its close button
+       */
+      void showMemoryBudget(bool* open = nullptr) const;
+
       /**
        \brief Return the graphic pipelin for the gui
        \return a pointer to the graphic pipeline
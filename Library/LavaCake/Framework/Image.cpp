@@ -1,47 +1,38 @@
 #include "Image.h"
+#include "Barrier.h"
+#include <LavaCake/Helpers/Trace.h>
 
 namespace LavaCake {
   namespace Framework {
 
 
     Image::Image(uint32_t width, uint32_t height, uint32_t depth, VkFormat f, VkImageAspectFlagBits aspect, VkImageUsageFlags usage,
-      VkMemoryPropertyFlagBits memPropertyFlag, bool cubemap) {
+      VkMemoryPropertyFlagBits memPropertyFlag, bool cubemap, uint32_t layers, bool array) {
+      LAVACAKE_TRACE_ZONE("Image::Image");
       m_width = width;
       m_height = height;
       m_depth = depth;
       m_format = f;
       m_aspect = aspect;
       m_cubemap = cubemap;
+      m_layers = cubemap ? 6 : layers;
+      m_array = !cubemap && (array || layers > 1);
 
       Framework::Device* d = LavaCake::Framework::Device::getDevice();
       VkDevice logical = d->getLogicalDevice();
 
       VkPhysicalDevice physical = d->getPhysicalDevice();
 
-      VkImageType type = VK_IMAGE_TYPE_1D;
-      VkImageViewType view = VK_IMAGE_VIEW_TYPE_1D;
-      if (m_height > 1) { type = VK_IMAGE_TYPE_2D; view = VK_IMAGE_VIEW_TYPE_2D; }
-      if (m_depth > 1) { type = VK_IMAGE_TYPE_3D; view = VK_IMAGE_VIEW_TYPE_3D; }
-      if (m_cubemap) { type = VK_IMAGE_TYPE_2D; view = VK_IMAGE_VIEW_TYPE_CUBE; }
+      if (m_array) {
+        VkPhysicalDeviceProperties p;
+        vkGetPhysicalDeviceProperties(physical, &p);
+        if (m_depth > 1 || m_layers > p.limits.maxImageArrayLayers) {
+          ErrorCheck::setError("The number of array layers is not supported for this image.");
+        }
+      }
 
       // image creation
-      VkImageCreateInfo image_create_info = {
-        VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,                // VkStructureType          sType
-        nullptr,                                            // const void             * pNext
-        cubemap ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0u, // VkImageCreateFlags       flags
-        type,                                               // VkImageType              imageType
-        m_format,                                           // VkFormat                 format
-        { m_width, m_height, m_depth },                     // VkExtent3D               extent
-        1,																									// uint32_t                 mipLevels
-        cubemap ? (uint32_t)6 : (uint32_t)1,								// uint32_t                 arrayLayers
-        VK_SAMPLE_COUNT_1_BIT,                              // VkSampleCountFlagBits    samples
-        VK_IMAGE_TILING_OPTIMAL,                            // VkImageTiling            tiling
-        usage,																							// VkImageUsageFlags        usage
-        VK_SHARING_MODE_EXCLUSIVE,                          // VkSharingMode            sharingMode
-        0,                                                  // uint32_t                 queueFamilyIndexCount
-        nullptr,                                            // const uint32_t         * pQueueFamilyIndices
-        VK_IMAGE_LAYOUT_UNDEFINED                           // VkImageLayout            initialLayout
-      };
+      VkImageCreateInfo image_create_info = createInfo(m_width, m_height, m_depth, m_format, usage, m_cubemap, m_layers);
 
       VkResult result = vkCreateImage(logical, &image_create_info, nullptr, &m_image);
       if (VK_SUCCESS != result) {
@@ -70,6 +61,9 @@ namespace LavaCake {
 
           VkResult result = vkAllocateMemory(logical, &image_memory_allocate_info, nullptr, &m_imageMemory);
           if (VK_SUCCESS == result) {
+            FrameStatistics::add(COUNTER_ALLOCATIONS);
+            MemoryBudget::registerAllocation(m_imageMemory, memory_requirements.size, physical_device_memory_properties.memoryTypes[type].heapIndex,
+              MemoryBudget::imageCategory(usage));
             break;
           }
         }
@@ -86,6 +80,95 @@ namespace LavaCake {
         ErrorCheck::setError("Could not bind memory object to an image.");
       }
 
+      createView();
+
+      m_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+      m_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+
+    }
+
+    Image::Image(uint32_t width, uint32_t height, uint32_t depth, VkFormat f, VkImageAspectFlagBits aspect, VkImageUsageFlags usage,
+      VkDeviceMemory memory, VkDeviceSize offset) {
+      LAVACAKE_TRACE_ZONE("Image::Image");
+      m_width = width;
+      m_height = height;
+      m_depth = depth;
+      m_format = f;
+      m_aspect = aspect;
+      m_ownMemory = false;
+
+      Framework::Device* d = LavaCake::Framework::Device::getDevice();
+      VkDevice logical = d->getLogicalDevice();
+
+      VkImageCreateInfo image_create_info = createInfo(m_width, m_height, m_depth, m_format, usage, false, 1);
+
+      VkResult result = vkCreateImage(logical, &image_create_info, nullptr, &m_image);
+      if (VK_SUCCESS != result) {
+        ErrorCheck::setError("Could not create an image.");
+      }
+
+      m_imageMemory = memory;
+      result = vkBindImageMemory(logical, m_image, m_imageMemory, offset);
+      if (VK_SUCCESS != result) {
+        ErrorCheck::setError("Could not bind memory object to an image.");
+      }
+
+      createView();
+
+      m_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+      m_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    }
+
+    VkMemoryRequirements Image::getMemoryRequirements(uint32_t width, uint32_t height, uint32_t depth, VkFormat format, VkImageUsageFlags usage) {
+      Framework::Device* d = LavaCake::Framework::Device::getDevice();
+      VkDevice logical = d->getLogicalDevice();
+
+      VkMemoryRequirements memory_requirements = {};
+      VkImageCreateInfo image_create_info = createInfo(width, height, depth, format, usage, false, 1);
+      VkImage image = VK_NULL_HANDLE;
+      if (VK_SUCCESS != vkCreateImage(logical, &image_create_info, nullptr, &image)) {
+        ErrorCheck::setError("Could not create an image.");
+        return memory_requirements;
+      }
+      vkGetImageMemoryRequirements(logical, image, &memory_requirements);
+      vkDestroyImage(logical, image, nullptr);
+      return memory_requirements;
+    }
+
+    VkImageCreateInfo Image::createInfo(uint32_t width, uint32_t height, uint32_t depth, VkFormat format, VkImageUsageFlags usage, bool cubemap, uint32_t layers) {
+      VkImageType type = VK_IMAGE_TYPE_1D;
+      if (height > 1) { type = VK_IMAGE_TYPE_2D; }
+      if (depth > 1) { type = VK_IMAGE_TYPE_3D; }
+      if (cubemap) { type = VK_IMAGE_TYPE_2D; }
+
+      return {
+        VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,                // VkStructureType          sType
+        nullptr,                                            // const void             * pNext
+        cubemap ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0u, // VkImageCreateFlags       flags
+        type,                                               // VkImageType              imageType
+        format,                                             // VkFormat                 format
+        { width, height, depth },                           // VkExtent3D               extent
+        1,																									// uint32_t                 mipLevels
+        cubemap ? (uint32_t)6 : layers,											// uint32_t                 arrayLayers
+        VK_SAMPLE_COUNT_1_BIT,                              // VkSampleCountFlagBits    samples
+        VK_IMAGE_TILING_OPTIMAL,                            // VkImageTiling            tiling
+        usage,																							// VkImageUsageFlags        usage
+        VK_SHARING_MODE_EXCLUSIVE,                          // VkSharingMode            sharingMode
+        0,                                                  // uint32_t                 queueFamilyIndexCount
+        nullptr,                                            // const uint32_t         * pQueueFamilyIndices
+        VK_IMAGE_LAYOUT_UNDEFINED                           // VkImageLayout            initialLayout
+      };
+    }
+
+    void Image::createView() {
+      Framework::Device* d = LavaCake::Framework::Device::getDevice();
+      VkDevice logical = d->getLogicalDevice();
+
+      VkImageViewType view = VK_IMAGE_VIEW_TYPE_1D;
+      if (m_height > 1) { view = VK_IMAGE_VIEW_TYPE_2D; }
+      if (m_depth > 1) { view = VK_IMAGE_VIEW_TYPE_3D; }
+      if (m_array) { view = m_height > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_1D_ARRAY; }
+      if (m_cubemap) { view = VK_IMAGE_VIEW_TYPE_CUBE; }
 
       // image view creation
       VkImageViewCreateInfo image_view_create_info = {
@@ -110,33 +193,24 @@ namespace LavaCake {
       }
       };
 
-      result = vkCreateImageView(logical, &image_view_create_info, nullptr, &m_imageView);
+      VkResult result = vkCreateImageView(logical, &image_view_create_info, nullptr, &m_imageView);
       if (VK_SUCCESS != result) {
         ErrorCheck::setError("Can't create Image View");
       }
-
-
-      m_layout = VK_IMAGE_LAYOUT_UNDEFINED;
-      m_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-
     }
 
 
-    void Image::createSampler() {
-      auto device = Device::getDevice();
-      auto logical = device->getLogicalDevice();
-
-
+    void Image::createSampler(VkFilter filter, VkSamplerAddressMode addressMode) {
       VkSamplerCreateInfo sampler_create_info = {
         VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,    // VkStructureType          sType
         nullptr,                                  // const void             * pNext
         0,                                        // VkSamplerCreateFlags     flags
-        VK_FILTER_LINEAR,                         // VkFilter                 magFilter
-        VK_FILTER_LINEAR,                         // VkFilter                 minFilter
+        filter,                                   // VkFilter                 magFilter
+        filter,                                   // VkFilter                 minFilter
         VK_SAMPLER_MIPMAP_MODE_NEAREST,           // VkSamplerMipmapMode      mipmapMode
-        VK_SAMPLER_ADDRESS_MODE_REPEAT,           // VkSamplerAddressMode     addressModeU
-        VK_SAMPLER_ADDRESS_MODE_REPEAT,           // VkSamplerAddressMode     addressModeV
-        VK_SAMPLER_ADDRESS_MODE_REPEAT,           // VkSamplerAddressMode     addressModeW
+        addressMode,                              // VkSamplerAddressMode     addressModeU
+        addressMode,                              // VkSamplerAddressMode     addressModeV
+        addressMode,                              // VkSamplerAddressMode     addressModeW
         0.0f,																			// float                    mipLodBias
         false,																		// VkBool32                 anisotropyEnable
         1.0f,																			// float                    maxAnisotropy
@@ -148,10 +222,8 @@ namespace LavaCake {
         false																			// VkBool32                 unnormalizedCoordinates
       };
 
-      VkResult result = vkCreateSampler(logical, &sampler_create_info, nullptr, &m_sampler);
-      if (VK_SUCCESS != result) {
-        ErrorCheck::setError("Could not create sampler.");;
-      }
+      SamplerCache::release(m_sampler);
+      m_sampler = SamplerCache::acquire(sampler_create_info);
     }
 
     void Image::map() {
@@ -167,10 +239,32 @@ namespace LavaCake {
     }
 
 
-    void Image::setLayout(CommandBuffer& cmdbuff, VkImageLayout newLayout, VkPipelineStageFlags dstStage, VkImageSubresourceRange subresourceRange) {
+    void Image::setLayout(CommandBuffer& cmdbuff, VkImageLayout newLayout, VkPipelineStageFlags dstStage, VkImageSubresourceRange subresourceRange, VkAccessFlags dstAccess) {
+
+      VkImageMemoryBarrier imageMemoryBarrier;
+      VkPipelineStageFlags srcStage;
+      if (!transition(newLayout, dstStage, subresourceRange, dstAccess, imageMemoryBarrier, srcStage)) {
+        cmdbuff.countBarriers(0, 1);
+        return;
+      }
+
+      // Put barrier inside setup command buffer
+      vkCmdPipelineBarrier(
+        cmdbuff.getHandle(),
+        srcStage,
+        dstStage,
+        0,
+        0, nullptr,
+        0, nullptr,
+        1, &imageMemoryBarrier);
+      cmdbuff.countBarriers(1, 0);
+    }
+
+    bool Image::transition(VkImageLayout newLayout, VkPipelineStageFlags dstStage, VkImageSubresourceRange subresourceRange, VkAccessFlags dstAccess,
+      VkImageMemoryBarrier& imageMemoryBarrier, VkPipelineStageFlags& srcStage) {
 
       // Create an image barrier object
-      VkImageMemoryBarrier imageMemoryBarrier{};
+      imageMemoryBarrier = {};
       imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
       imageMemoryBarrier.oldLayout = m_layout;
       imageMemoryBarrier.newLayout = newLayout;
@@ -225,11 +319,22 @@ namespace LavaCake {
         // Make sure any shader reads from the image have been finished
         imageMemoryBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
         break;
+
+      case VK_IMAGE_LAYOUT_GENERAL:
+        // Image is a storage image
+        // Make sure any shader reads and writes to the image have been finished
+        imageMemoryBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        break;
       default:
         // Other source layouts aren't handled (yet)
         break;
       }
 
+      // The accesses given to the previous transition are more precise than the ones deduced from its layout
+      if (m_access != 0) {
+        imageMemoryBarrier.srcAccessMask = m_access;
+      }
+
       // Target layouts (new)
       // Destination access mask controls the dependency for the new image layout
       switch (newLayout)
@@ -267,24 +372,39 @@ namespace LavaCake {
         }
         imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
         break;
+
+      case VK_IMAGE_LAYOUT_GENERAL:
+        // Image will be read or written as a storage image
+        // Make sure any writes to the image have been finished
+        imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        break;
       default:
         // Other source layouts aren't handled (yet)
         break;
       }
 
-      // Put barrier inside setup command buffer
-      vkCmdPipelineBarrier(
-        cmdbuff.getHandle(),
-        m_stage,
-        dstStage,
-        0,
-        0, nullptr,
-        0, nullptr,
-        1, &imageMemoryBarrier);
+      if (dstAccess != 0) {
+        imageMemoryBarrier.dstAccessMask = dstAccess;
+      }
+
+      // Reading again in a read only layout what has already been made visible needs no barrier
+      if (newLayout == m_layout && isReadOnlyAccess(imageMemoryBarrier.srcAccessMask) &&
+        imageMemoryBarrier.srcAccessMask == imageMemoryBarrier.dstAccessMask && (dstStage & ~m_stage) == 0) {
+        return false;
+      }
+
+      srcStage = m_stage != 0 ? m_stage : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
 
       m_layout = newLayout;
       m_stage = dstStage;
+      m_access = dstAccess;
+      return true;
+    }
 
+    void Image::assumeLayout(VkImageLayout layout, VkPipelineStageFlags stage, VkAccessFlags access) {
+      m_layout = layout;
+      m_stage = stage;
+      m_access = access;
     }
 
     void Image::copyToImage(CommandBuffer& cmdBuff, Image& image, std::vector<VkImageCopy> regions) {
@@ -331,6 +451,14 @@ namespace LavaCake {
       return m_depth;
     }
 
+    uint32_t Image::layers() const {
+      return m_layers;
+    }
+
+    VkImageAspectFlagBits Image::aspect() const {
+      return m_aspect;
+    }
+
 
   }
 }
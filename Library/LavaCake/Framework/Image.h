@@ -3,6 +3,8 @@
 #include "CommandBuffer.h"
 #include "Queue.h"
 #include "Buffer.h"
+#include "MemoryBudget.h"
+#include "SamplerCache.h"
 
 
 
@@ -29,6 +31,8 @@ namespace LavaCake {
        \param usage the usage of the image, see more <a href="https://www.khronos.org/registry/vulkan/specs/1.2-extensions/man/html/VkImageUsageFlags.html">here</a>
        \param memPropertyFlag : the memory property of the image, see more <a href="https://www.khronos.org/registry/vulkan/specs/1.2-extensions/man/html/VkMemoryPropertyFlagBits.html">here</a>
        \param cubemap [otpional] weither or not the image is a cubemap, false by defalt
+       \param layers [optional] the number of array layers of a 1D or 2D image, viewed as an array when greater than 1, ignored for cubemaps
+       \param array [optional] view the image as an array even if it has a single layer, for shaders sampling it as an array
        */
       Image(
         uint32_t width,
@@ -38,9 +42,43 @@ namespace LavaCake {
         VkImageAspectFlagBits aspect,
         VkImageUsageFlags usage,
         VkMemoryPropertyFlagBits memPropertyFlag = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        bool cubemap = false);
+        bool cubemap = false,
+        uint32_t layers = 1,
+        bool array = false);
 
 
+      /**
+       \brief Create a 2D or 3D image bound to a memory it does not own, used to alias the memory of images that are not used at the same time
+       \param witdh the witdth of the image
+       \param height the height of the image
+       \param depth the depth of the image
+       \param format the format of the Image
+       \param aspect the aspect of the image
+       \param usage the usage of the image
+       \param memory the memory the image is bound to, it must outlive the image and match its memory requirements, see getMemoryRequirements
+       \param offset the offset of the image in the memory
+       */
+      Image(
+        uint32_t width,
+        uint32_t height,
+        uint32_t depth,
+        VkFormat format,
+        VkImageAspectFlagBits aspect,
+        VkImageUsageFlags usage,
+        VkDeviceMemory memory,
+        VkDeviceSize offset);
+
+      /**
+       \brief Get the memory requirements of an image without creating it
+       \param witdh the witdth of the image
+       \param height the height of the image
+       \param depth the depth of the image
+       \param format the format of the Image
+       \param usage the usage of the image
+       \return the size, alignment and compatible memory types of the image memory
+       */
+      static VkMemoryRequirements getMemoryRequirements(uint32_t width, uint32_t height, uint32_t depth, VkFormat format, VkImageUsageFlags usage);
+
       Image(const Image&) = delete;
 
       Image& operator=(const Image&) = delete;
@@ -50,10 +88,12 @@ namespace LavaCake {
         m_width = i.m_width;
         m_height = i.m_height;
         m_depth = i.m_depth;
+        m_layers = i.m_layers;
         m_format = i.m_format;
 
         m_layout = i.m_layout;
         m_stage = i.m_stage;
+        m_access = i.m_access;
         m_aspect = i.m_aspect;
 
         m_image = i.m_image;
@@ -61,7 +101,9 @@ namespace LavaCake {
         m_imageView = i.m_imageView;
         m_sampler = i.m_sampler;
         m_cubemap = i.m_cubemap;
+        m_array = i.m_array;
         m_mappedMemory = i.m_mappedMemory;
+        m_ownMemory = i.m_ownMemory;
 
         i.m_image = VK_NULL_HANDLE;
         i.m_imageMemory = VK_NULL_HANDLE;
@@ -72,7 +114,12 @@ namespace LavaCake {
       };
 
 
-      void createSampler();
+      /**
+       \brief Create a sampler for the image, shared with the images using the same parameters through the SamplerCache
+       \param filter [optional] the magnification and minification filter, linear by default
+       \param addressMode [optional] the addressing mode outside of [0,1], repeat by default
+       */
+      void createSampler(VkFilter filter = VK_FILTER_LINEAR, VkSamplerAddressMode addressMode = VK_SAMPLER_ADDRESS_MODE_REPEAT);
 
       /**
        \brief Map the memory of the Image
@@ -92,11 +139,38 @@ namespace LavaCake {
        \param newLayout the new layout of the image
        \param dstStage the new stage flag
        \param subresourceRange the range of the memory that will be affected by the operation
+       \param dstAccess [optional] the accesses of the new stage, deduced from the new layout when 0
        */
       void setLayout(CommandBuffer& cmdbuff,
         VkImageLayout newLayout,
         VkPipelineStageFlags dstStage,
-        VkImageSubresourceRange subresourceRange);
+        VkImageSubresourceRange subresourceRange,
+        VkAccessFlags dstAccess = 0);
+
+      /**
+       \brief Compute the barrier changing the layout of the image and update its state, nothing is recorded, see BarrierBatch
+       \param newLayout the new layout of the image
+       \param dstStage the new stage flag
+       \param subresourceRange the range of the memory that will be affected by the operation
+       \param dstAccess the accesses of the new stage, deduced from the new layout when 0
+       \param barrier filled with the barrier to record
+       \param srcStage filled with the stage the barrier must wait for
+       \return false if the image is already in a read only layout readable in this stage and no barrier is needed
+       */
+      bool transition(VkImageLayout newLayout,
+        VkPipelineStageFlags dstStage,
+        VkImageSubresourceRange subresourceRange,
+        VkAccessFlags dstAccess,
+        VkImageMemoryBarrier& barrier,
+        VkPipelineStageFlags& srcStage);
+
+      /**
+       \brief Set the layout and stage of the image after they were changed outside of setLayout, by a render pass or a barrier recorded by hand
+       \param layout the current layout of the image, VK_IMAGE_LAYOUT_UNDEFINED to discard its content
+       \param stage the stage the next layout change will wait for
+       \param access [optional] the accesses the next layout change will make available, deduced from the layout when 0
+       */
+      void assumeLayout(VkImageLayout layout, VkPipelineStageFlags stage, VkAccessFlags access = 0);
 
       /**
        \brief Copy the content of the image to another image
@@ -136,10 +210,8 @@ namespace LavaCake {
         Device* d = Device::getDevice();
         VkDevice logical = d->getLogicalDevice();
 
-        if (VK_NULL_HANDLE != m_sampler) {
-          vkDestroySampler(logical, m_sampler, nullptr);
-          m_sampler = VK_NULL_HANDLE;
-        }
+        SamplerCache::release(m_sampler);
+        m_sampler = VK_NULL_HANDLE;
 
         if (VK_NULL_HANDLE != m_image) {
           vkDestroyImage(logical, m_image, nullptr);
@@ -151,10 +223,12 @@ namespace LavaCake {
           m_imageView = VK_NULL_HANDLE;
         }
 
-        if (VK_NULL_HANDLE != m_imageMemory) {
+        if (VK_NULL_HANDLE != m_imageMemory && m_ownMemory) {
+          MemoryBudget::releaseAllocation(m_imageMemory);
           vkFreeMemory(logical, m_imageMemory, nullptr);
-          m_imageMemory = VK_NULL_HANDLE;
+          FrameStatistics::add(COUNTER_FREES);
         }
+        m_imageMemory = VK_NULL_HANDLE;
 
       }
 
@@ -185,15 +259,29 @@ namespace LavaCake {
        */
       uint32_t depth() const;
 
+      /**
+       \brief Get the number of array layers of the image
+       \return uint32_t the number of array layers, 6 for a cubemap
+       */
+      uint32_t layers() const;
+
+      /**
+       \brief Get the aspect of the image
+       \return VkImageAspectFlagBits the aspect of the image
+       */
+      VkImageAspectFlagBits aspect() const;
+
     private:
 
       uint32_t														m_width = 0;
       uint32_t														m_height = 0;
       uint32_t														m_depth = 0;
+      uint32_t														m_layers = 1;
       VkFormat														m_format;
 
       VkImageLayout												m_layout = VK_IMAGE_LAYOUT_UNDEFINED;
       VkPipelineStageFlags								m_stage = VK_PIPELINE_STAGE_NONE_KHR;
+      VkAccessFlags												m_access = 0;
       VkImageAspectFlagBits								m_aspect;
 
       VkImage                             m_image = VK_NULL_HANDLE;
@@ -202,8 +290,14 @@ namespace LavaCake {
       VkSampler             							m_sampler = VK_NULL_HANDLE;
 
       bool																m_cubemap = false;
+      bool																m_array = false;
+      bool																m_ownMemory = true;
 
       void* m_mappedMemory = nullptr;
+
+      static VkImageCreateInfo createInfo(uint32_t width, uint32_t height, uint32_t depth, VkFormat format, VkImageUsageFlags usage, bool cubemap, uint32_t layers);
+
+      void createView();
     };
 
   }
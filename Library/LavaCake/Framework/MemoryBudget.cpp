@@ -0,0 +1,192 @@
+#include "MemoryBudget.h"
+#include "Device.h"
+#include <mutex>
+#include <unordered_map>
+
+namespace LavaCake {
+  namespace Framework {
+
+    namespace {
+      struct allocation {
+        VkDeviceSize        size;
+        uint32_t            heap;
+        memoryCategory      category;
+      };
+
+      struct memoryRegistry {
+        std::mutex                                                  mutex;
+        std::unordered_map<VkDeviceMemory, allocation>              allocations;
+        std::array<categoryUsage, MEMORY_CATEGORY_COUNT>            categories;
+        std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS>               heapAllocated = {};
+        std::array<bool, VK_MAX_MEMORY_HEAPS>                       overThreshold = {};
+        float                                                       threshold = 0.9f;
+        budgetCallback                                              callback;
+      };
+
+      memoryRegistry& registry() {
+        static memoryRegistry r;
+        return r;
+      }
+    }
+
+    void MemoryBudget::registerAllocation(VkDeviceMemory memory, VkDeviceSize size, uint32_t heap, memoryCategory category) {
+      memoryRegistry& r = registry();
+      bool check;
+      {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.allocations[memory] = { size, heap, category };
+        r.categories[category].allocations++;
+        r.categories[category].bytes += size;
+        r.heapAllocated[heap] += size;
+        check = bool(r.callback);
+      }
+      if (check) {
+        checkBudget();
+      }
+    }
+
+    void MemoryBudget::releaseAllocation(VkDeviceMemory memory) {
+      memoryRegistry& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      auto it = r.allocations.find(memory);
+      if (it == r.allocations.end()) {
+        return;
+      }
+      const allocation& a = it->second;
+      r.categories[a.category].allocations--;
+      r.categories[a.category].bytes -= a.size;
+      r.heapAllocated[a.heap] -= a.size;
+      r.allocations.erase(it);
+    }
+
+    std::vector<heapBudget> MemoryBudget::getHeapBudgets() {
+      Device* d = Device::getDevice();
+
+      VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties = {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,   // VkStructureType    sType
+        nullptr,                                                          // void             * pNext
+        {},                                                               // VkDeviceSize       heapBudget[VK_MAX_MEMORY_HEAPS]
+        {}                                                                // VkDeviceSize       heapUsage[VK_MAX_MEMORY_HEAPS]
+      };
+
+      VkPhysicalDeviceMemoryProperties2 properties = {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,            // VkStructureType                      sType
+        d->memoryBudgetAvailable() ? &budgetProperties : nullptr,         // void                               * pNext
+        {}                                                                // VkPhysicalDeviceMemoryProperties     memoryProperties
+      };
+      vkGetPhysicalDeviceMemoryProperties2(d->getPhysicalDevice(), &properties);
+
+      memoryRegistry& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      std::vector<heapBudget> budgets(properties.memoryProperties.memoryHeapCount);
+      for (uint32_t i = 0; i < budgets.size(); i++) {
+        const VkMemoryHeap& heap = properties.memoryProperties.memoryHeaps[i];
+        heapBudget& b = budgets[i];
+        b.size = heap.size;
+        b.allocated = r.heapAllocated[i];
+        b.deviceLocal = (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+        if (d->memoryBudgetAvailable()) {
+          b.budget = budgetProperties.heapBudget[i];
+          b.usage = budgetProperties.heapUsage[i];
+        }
+        else {
+          b.budget = heap.size;
+          b.usage = b.allocated;
+        }
+      }
+      return budgets;
+    }
+
+    categoryUsage MemoryBudget::getCategoryUsage(memoryCategory category) {
+      memoryRegistry& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      return r.categories[category];
+    }
+
+    void MemoryBudget::setBudgetCallback(float threshold, budgetCallback callback) {
+      memoryRegistry& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      r.threshold = threshold;
+      r.callback = callback;
+      r.overThreshold = {};
+    }
+
+    void MemoryBudget::checkBudget() {
+      memoryRegistry& r = registry();
+      {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (!r.callback) {
+          return;
+        }
+      }
+
+      std::vector<heapBudget> budgets = getHeapBudgets();
+      std::vector<uint32_t> crossed;
+      budgetCallback callback;
+      {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (uint32_t i = 0; i < budgets.size(); i++) {
+          bool over = double(budgets[i].usage) >= double(r.threshold) * double(budgets[i].budget);
+          if (over && !r.overThreshold[i]) {
+            crossed.push_back(i);
+          }
+          r.overThreshold[i] = over;
+        }
+        callback = r.callback;
+      }
+
+      // called without the lock so that the callback can release memory
+      for (uint32_t heap : crossed) {
+        callback(heap, budgets[heap]);
+      }
+    }
+
+    memoryCategory MemoryBudget::bufferCategory(VkBufferUsageFlags usage, VkMemoryPropertyFlags memoryFlags) {
+      if (usage & VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR) {
+        return MEMORY_ACCELERATION_STRUCTURE;
+      }
+      if (usage & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT) {
+        return MEMORY_VERTEX;
+      }
+      if (usage & VK_BUFFER_USAGE_INDEX_BUFFER_BIT) {
+        return MEMORY_INDEX;
+      }
+      if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) {
+        return MEMORY_UNIFORM;
+      }
+      if ((memoryFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(usage & ~(VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT))) {
+        return MEMORY_STAGING;
+      }
+      if (usage & (VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT)) {
+        return MEMORY_STORAGE;
+      }
+      return MEMORY_OTHER;
+    }
+
+    memoryCategory MemoryBudget::imageCategory(VkImageUsageFlags usage) {
+      if (usage & (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT)) {
+        return MEMORY_ATTACHMENT;
+      }
+      if (usage & (VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT)) {
+        return MEMORY_TEXTURE;
+      }
+      return MEMORY_OTHER;
+    }
+
+    const char* MemoryBudget::getName(memoryCategory category) {
+      switch (category) {
+      case MEMORY_VERTEX:                   return "vertex";
+      case MEMORY_INDEX:                    return "index";
+      case MEMORY_UNIFORM:                  return "uniform";
+      case MEMORY_STORAGE:                  return "storage";
+      case MEMORY_TEXTURE:                  return "texture";
+      case MEMORY_ATTACHMENT:               return "attachment";
+      case MEMORY_ACCELERATION_STRUCTURE:   return "acceleration structure";
+      case MEMORY_STAGING:                  return "staging";
+      case MEMORY_OTHER:                    return "other";
+      default:                              return "unknown";
+      }
+    }
+
+  }
+}
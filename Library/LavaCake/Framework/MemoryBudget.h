@@ -0,0 +1,120 @@
+#pragma once
+
+#include "AllHeaders.h"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace LavaCake {
+  namespace Framework {
+
+    /**
+    \brief the categories of the device memory allocated by the framework
+    */
+    enum memoryCategory {
+      MEMORY_VERTEX,                  /*!< the vertex buffers */
+      MEMORY_INDEX,                   /*!< the index buffers */
+      MEMORY_UNIFORM,                 /*!< the uniform buffers */
+      MEMORY_STORAGE,                 /*!< the storage and texel buffers */
+      MEMORY_TEXTURE,                 /*!< the sampled and storage images */
+      MEMORY_ATTACHMENT,              /*!< the color and depth attachments, transient images of a RenderGraph included */
+      MEMORY_ACCELERATION_STRUCTURE,  /*!< the buffers holding acceleration structures */
+      MEMORY_STAGING,                 /*!< the host visible buffers only used by transfers */
+      MEMORY_OTHER,                   /*!< every other allocation */
+      MEMORY_CATEGORY_COUNT
+    };
+
+    /**
+    \brief the budget and the usage of a memory heap
+    */
+    struct heapBudget {
+      VkDeviceSize      size = 0;           /*!< the size of the heap */
+      VkDeviceSize      budget = 0;         /*!< the memory the process can use before the driver starts paging, the size of the heap without VK_EXT_memory_budget */
+      VkDeviceSize      usage = 0;          /*!< the memory used by the process, the memory allocated by the framework without VK_EXT_memory_budget */
+      VkDeviceSize      allocated = 0;      /*!< the memory allocated by the framework */
+      bool              deviceLocal = false;
+    };
+
+    /**
+    \brief the live allocations of a memory category
+    */
+    struct categoryUsage {
+      uint64_t          allocations = 0;    /*!< the number of live allocations */
+      VkDeviceSize      bytes = 0;          /*!< the bytes of the live allocations */
+    };
+
+    /**
+    \brief called when the usage of a heap crosses the threshold of its budget
+    */
+    typedef std::function<void(uint32_t heap, const heapBudget& budget)> budgetCallback;
+
+    /**
+      Class MemoryBudget :
+      \brief Keep a registry of the device memory allocated by the framework and query the budget of each heap with
+      VK_EXT_memory_budget when the device supports it, so that an application can release memory before the driver starts paging.
+    */
+    class MemoryBudget {
+    public:
+
+      /**
+        \brief register an allocation, called by the classes allocating device memory
+        \param memory : the allocated memory
+        \param size : the size of the allocation
+        \param heap : the heap of the memory type used
+        \param category : the category of the allocation
+      */
+      static void registerAllocation(VkDeviceMemory memory, VkDeviceSize size, uint32_t heap, memoryCategory category);
+
+      /**
+        \brief remove an allocation from the registry, must be called before the memory is freed
+        \param memory : the memory about to be freed
+      */
+      static void releaseAllocation(VkDeviceMemory memory);
+
+      /**
+        \brief query the budget and the usage of every heap of the device
+      */
+      static std::vector<heapBudget> getHeapBudgets();
+
+      /**
+        \brief get the live allocations of a category
+        \param category : the category
+      */
+      static categoryUsage getCategoryUsage(memoryCategory category);
+
+      /**
+        \brief set the function called when the usage of a heap goes above a fraction of its budget, it is called again once
+        the usage went back below the threshold and crosses it again
+        \param threshold : the fraction of the budget, between 0 and 1
+        \param callback : the function, called from the thread allocating memory or calling checkBudget, an empty function removes it
+      */
+      static void setBudgetCallback(float threshold, budgetCallback callback);
+
+      /**
+        \brief query the budgets and call the budget callback for the heaps crossing the threshold, called on each allocation and each frame
+      */
+      static void checkBudget();
+
+      /**
+        \brief get the category of a buffer from its usage
+        \param usage : the usage of the buffer
+        \param memoryFlags : the memory properties requested for the buffer
+      */
+      static memoryCategory bufferCategory(VkBufferUsageFlags usage, VkMemoryPropertyFlags memoryFlags);
+
+      /**
+        \brief get the category of an image from its usage
+        \param usage : the usage of the image
+      */
+      static memoryCategory imageCategory(VkImageUsageFlags usage);
+
+      /**
+        \brief get a readable name of a category
+        \param category : the category
+      */
+      static const char* getName(memoryCategory category);
+    };
+
+  }
+}
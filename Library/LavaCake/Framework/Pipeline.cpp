@@ -1,4 +1,5 @@
 #include "Pipeline.h"
+#include <LavaCake/Helpers/Trace.h>
 namespace LavaCake {
   namespace Framework {
 
@@ -57,6 +58,7 @@ namespace LavaCake {
     }
 
     void Pipeline::generateDescriptorLayout() {
+      LAVACAKE_TRACE_ZONE("Pipeline::generateDescriptorLayout");
       if (!m_descriptorSet) {
         m_descriptorSet = std::make_shared < DescriptorSet >();
         ErrorCheck::setError("No Descripor was provided for this pipeline, a default one will be used instead", 1);
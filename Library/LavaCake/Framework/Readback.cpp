@@ -0,0 +1,147 @@
+#include "Readback.h"
+
+namespace LavaCake {
+  namespace Framework {
+
+    ReadbackRing::ReadbackRing(uint64_t capacity) {
+      Device* d = Device::getDevice();
+      VkPhysicalDevice physical = d->getPhysicalDevice();
+
+      VkPhysicalDeviceProperties p;
+      vkGetPhysicalDeviceProperties(physical, &p);
+      // each readback starts on its own non coherent atom so that invalidating it does not touch its neighbours
+      m_alignment = std::max<uint64_t>(p.limits.nonCoherentAtomSize, 16);
+      m_capacity = (std::max<uint64_t>(capacity, 1) + m_alignment - 1) / m_alignment * m_alignment;
+
+      // reading uncached memory is very slow, use cached memory when the device has some
+      VkPhysicalDeviceMemoryProperties memoryProperties;
+      vkGetPhysicalDeviceMemoryProperties(physical, &memoryProperties);
+      VkMemoryPropertyFlags memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+      for (uint32_t type = 0; type < memoryProperties.memoryTypeCount; ++type) {
+        VkMemoryPropertyFlags cached = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+        if ((memoryProperties.memoryTypes[type].propertyFlags & cached) == cached) {
+          memoryFlags = cached;
+          break;
+        }
+      }
+
+      m_buffer = std::move(Buffer(m_capacity, VK_BUFFER_USAGE_TRANSFER_DST_BIT, memoryFlags));
+      m_mapped = static_cast<const std::byte*>(m_buffer.map());
+    }
+
+    bool ReadbackRing::allocate(uint64_t size, uint64_t& offset) {
+      size = (size + m_alignment - 1) / m_alignment * m_alignment;
+      if (m_allocations.empty()) {
+        if (size > m_capacity) {
+          return false;
+        }
+        offset = 0;
+        return true;
+      }
+
+      uint64_t head = m_allocations.back().end;
+      uint64_t tail = m_allocations.front().offset;
+      bool wrapped = m_allocations.back().offset < tail;
+      if (wrapped) {
+        if (head + size > tail) {
+          return false;
+        }
+        offset = head;
+        return true;
+      }
+      if (head + size <= m_capacity) {
+        offset = head;
+        return true;
+      }
+      if (size <= tail) {
+        offset = 0;
+        return true;
+      }
+      return false;
+    }
+
+    readbackTicket ReadbackRing::record(CommandBuffer& cmdBuff, Buffer& source, uint64_t offset, uint64_t size) {
+      readbackTicket ticket;
+      uint64_t slot;
+      if (size == 0 || !allocate(size, slot)) {
+        ErrorCheck::setError("The readback ring is full");
+        return ticket;
+      }
+
+      ticket.id = m_nextId++;
+      ticket.offset = slot;
+      ticket.size = size;
+      ticket.fence = cmdBuff.getFence();
+      m_allocations.push_back({ ticket.id, slot, slot + (size + m_alignment - 1) / m_alignment * m_alignment, false });
+
+      VkPipelineStageFlags stage = source.getStage();
+      VkAccessFlags access = source.getAccess();
+      source.setAccess(cmdBuff, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+
+      source.copyToBuffer(cmdBuff, m_buffer, { offset, slot, size });
+
+      source.setAccess(cmdBuff, stage, access);
+
+      // make the copy visible to the host once the fence is signaled
+      VkMemoryBarrier barrier = {
+        VK_STRUCTURE_TYPE_MEMORY_BARRIER,     // VkStructureType    sType
+        nullptr,                              // const void       * pNext
+        VK_ACCESS_TRANSFER_WRITE_BIT,         // VkAccessFlags      srcAccessMask
+        VK_ACCESS_HOST_READ_BIT               // VkAccessFlags      dstAccessMask
+      };
+      vkCmdPipelineBarrier(cmdBuff.getHandle(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+      return ticket;
+    }
+
+    bool ReadbackRing::ready(const readbackTicket& ticket) const {
+      if (!ticket.valid()) {
+        return false;
+      }
+      VkDevice logical = Device::getDevice()->getLogicalDevice();
+      return vkGetFenceStatus(logical, ticket.fence) == VK_SUCCESS;
+    }
+
+    bool ReadbackRing::wait(const readbackTicket& ticket, uint64_t waitingTime) const {
+      if (!ticket.valid()) {
+        return false;
+      }
+      VkDevice logical = Device::getDevice()->getLogicalDevice();
+      return vkWaitForFences(logical, 1, &ticket.fence, VK_TRUE, waitingTime) == VK_SUCCESS;
+    }
+
+    std::span<const std::byte> ReadbackRing::data(const readbackTicket& ticket) {
+      auto it = std::find_if(m_allocations.begin(), m_allocations.end(), [&](const allocation& a) { return a.id == ticket.id; });
+      if (it == m_allocations.end() || it->released) {
+        ErrorCheck::setError("The readback ticket was already released");
+        return {};
+      }
+      if (!ready(ticket)) {
+        return {};
+      }
+      m_buffer.invalidate(ticket.offset, ticket.size);
+      return std::span<const std::byte>(m_mapped + ticket.offset, ticket.size);
+    }
+
+    void ReadbackRing::release(const readbackTicket& ticket) {
+      auto it = std::find_if(m_allocations.begin(), m_allocations.end(), [&](const allocation& a) { return a.id == ticket.id; });
+      if (it == m_allocations.end()) {
+        return;
+      }
+      it->released = true;
+      while (!m_allocations.empty() && m_allocations.front().released) {
+        m_allocations.pop_front();
+      }
+    }
+
+    uint64_t ReadbackRing::getUsedSize() const {
+      if (m_allocations.empty()) {
+        return 0;
+      }
+      uint64_t head = m_allocations.back().end;
+      uint64_t tail = m_allocations.front().offset;
+      return head > tail ? head - tail : m_capacity - tail + head;
+    }
+
+  }
+}
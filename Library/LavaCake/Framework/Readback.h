@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <span>
+#include <type_traits>
+#include "Buffer.h"
+
+namespace LavaCake {
+  namespace Framework {
+
+    /**
+    \brief a pending readback, returned by ReadbackRing::record
+    */
+    struct readbackTicket {
+      uint64_t      id = 0;                   /*!< the identifier of the readback, 0 if the readback could not be recorded */
+      uint64_t      offset = 0;               /*!< the offset of the data in the ring */
+      uint64_t      size = 0;                 /*!< the size of the data in bytes */
+      VkFence       fence = VK_NULL_HANDLE;   /*!< the fence of the command buffer the copy was recorded in */
+
+      /**
+      \brief check if the ticket refers to a recorded readback
+      */
+      bool valid() const { return id != 0; }
+    };
+
+    /**
+      Class ReadbackRing :
+      \brief Read buffers back to the host without blocking, the copies are recorded in the caller's command buffers into a
+      ring of host visible memory (host cached when the device has some) and the results are consumed once the command buffer
+      has been executed, directly from the mapped memory or copied into a caller's container.
+      A ticket is tied to the fence of the command buffer it was recorded in, it must be consumed or released before that
+      command buffer is reset and submitted again.
+    */
+    class ReadbackRing {
+    public:
+
+      /**
+        \brief create a readback ring
+        \param capacity: the size in bytes of the ring, the total size of the readbacks pending at the same time
+      */
+      ReadbackRing(uint64_t capacity);
+
+      ReadbackRing(const ReadbackRing&) = delete;
+      ReadbackRing& operator=(const ReadbackRing&) = delete;
+
+      /**
+        \brief record the copy of a region of a buffer into the ring
+        \param cmdBuff: the command buffer used for this operation, must be in a recording state and submitted with a reset fence
+        \param source: the buffer to read
+        \param offset: the offset in bytes of the region to read
+        \param size: the size in bytes of the region to read
+        \return a ticket to get the data back, invalid if the ring is full
+      */
+      readbackTicket record(CommandBuffer& cmdBuff, Buffer& source, uint64_t offset, uint64_t size);
+
+      /**
+        \brief check without blocking if the data of a readback is available
+        \param ticket: the ticket of the readback
+      */
+      bool ready(const readbackTicket& ticket) const;
+
+      /**
+        \brief wait for the data of a readback to be available
+        \param ticket: the ticket of the readback
+        \param waitingTime (optional) the maximum waiting time allowed to this function in nanoseconds
+        \return true if the data is available
+      */
+      bool wait(const readbackTicket& ticket, uint64_t waitingTime = UINT64_MAX) const;
+
+      /**
+        \brief get the data of a completed readback in the mapped memory of the ring, valid until the ticket is released
+        \param ticket: the ticket of the readback, it must be ready
+        \return a span over the data, empty if the readback is not ready
+      */
+      std::span<const std::byte> data(const readbackTicket& ticket);
+
+      /**
+        \brief copy the data of a completed readback into a caller's container and release the ticket
+        \param ticket: the ticket of the readback, it must be ready
+        \param destination: where the data is copied, at most ticket.size bytes are copied
+        \return true if the data was copied
+      */
+      template<typename T>
+      bool read(const readbackTicket& ticket, std::span<T> destination) {
+        static_assert(std::is_trivially_copyable_v<T>, "readback data is copied as bytes");
+        std::span<const std::byte> source = data(ticket);
+        if (source.empty()) {
+          return false;
+        }
+        std::memcpy(destination.data(), source.data(), std::min<size_t>(source.size(), destination.size_bytes()));
+        release(ticket);
+        return true;
+      }
+
+      /**
+        \brief give the memory of a readback back to the ring, its data must not be used afterward
+        \param ticket: the ticket of the readback
+      */
+      void release(const readbackTicket& ticket);
+
+      /**
+        \brief get the number of bytes currently reserved by pending readbacks
+      */
+      uint64_t getUsedSize() const;
+
+    private:
+
+      struct allocation {
+        uint64_t    id;
+        uint64_t    offset;
+        uint64_t    end;
+        bool        released;
+      };
+
+      bool allocate(uint64_t size, uint64_t& offset);
+
+      Buffer                                                    m_buffer;
+      const std::byte*                                          m_mapped = nullptr;
+      uint64_t                                                  m_capacity = 0;
+      uint64_t                                                  m_alignment = 1;
+      uint64_t                                                  m_nextId = 1;
+      // allocations in ring order, the oldest first
+      std::deque<allocation>                                    m_allocations;
+    };
+
+  }
+}
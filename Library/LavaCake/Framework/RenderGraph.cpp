@@ -0,0 +1,371 @@
+#include "RenderGraph.h"
+#include <LavaCake/Helpers/Trace.h>
+#include <algorithm>
+
+namespace LavaCake {
+  namespace Framework {
+
+    uint32_t RenderGraph::importImage(std::shared_ptr<Image> image, bool output) {
+      resource r;
+      r.image = image;
+      r.output = output;
+      m_resources.push_back(r);
+      m_compiled = false;
+      return static_cast<uint32_t>(m_resources.size() - 1);
+    }
+
+    uint32_t RenderGraph::importBuffer(std::shared_ptr<Buffer> buffer, bool output) {
+      resource r;
+      r.buffer = buffer;
+      r.output = output;
+      m_resources.push_back(r);
+      m_compiled = false;
+      return static_cast<uint32_t>(m_resources.size() - 1);
+    }
+
+    uint32_t RenderGraph::createImage(const transientImageInfo& info) {
+      resource r;
+      r.transient = true;
+      r.info = info;
+      m_resources.push_back(r);
+      m_compiled = false;
+      return static_cast<uint32_t>(m_resources.size() - 1);
+    }
+
+    uint32_t RenderGraph::addPass(const std::string& name, std::function<void(CommandBuffer&)> record, bool sideEffect) {
+      pass p;
+      p.name = name;
+      p.record = record;
+      p.sideEffect = sideEffect;
+      m_passes.push_back(p);
+      m_compiled = false;
+      return static_cast<uint32_t>(m_passes.size() - 1);
+    }
+
+    void RenderGraph::addAccess(uint32_t p, const resourceAccess& access, bool image) {
+      if (p >= m_passes.size() || access.resource >= m_resources.size()) {
+        ErrorCheck::setError("Unknown pass or resource in the RenderGraph");
+        return;
+      }
+      const resource& r = m_resources[access.resource];
+      bool isImage = r.transient || r.image != nullptr;
+      if (isImage != image) {
+        ErrorCheck::setError(image ? "The resource is not an image of the RenderGraph" : "The resource is not a buffer of the RenderGraph");
+        return;
+      }
+      m_passes[p].accesses.push_back(access);
+      m_compiled = false;
+    }
+
+    void RenderGraph::readImage(uint32_t p, uint32_t image, VkImageLayout layout, VkPipelineStageFlags stage, VkAccessFlags access) {
+      addAccess(p, { image, stage, access, layout, VK_IMAGE_LAYOUT_UNDEFINED, false }, true);
+    }
+
+    void RenderGraph::writeImage(uint32_t p, uint32_t image, VkImageLayout layout, VkPipelineStageFlags stage, VkAccessFlags access, VkImageLayout finalLayout) {
+      addAccess(p, { image, stage, access, layout, finalLayout, true }, true);
+    }
+
+    void RenderGraph::readBuffer(uint32_t p, uint32_t buffer, VkPipelineStageFlags stage, VkAccessFlags access) {
+      addAccess(p, { buffer, stage, access, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED, false }, false);
+    }
+
+    void RenderGraph::writeBuffer(uint32_t p, uint32_t buffer, VkPipelineStageFlags stage, VkAccessFlags access) {
+      addAccess(p, { buffer, stage, access, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED, true }, false);
+    }
+
+    void RenderGraph::cull() {
+      // walk the passes backward, a pass is kept if it has side effects or writes a resource a kept pass reads afterward
+      std::vector<bool> needed(m_resources.size());
+      for (size_t i = 0; i < m_resources.size(); i++) {
+        needed[i] = m_resources[i].output;
+      }
+
+      for (size_t p = m_passes.size(); p-- > 0;) {
+        pass& current = m_passes[p];
+        current.active = current.sideEffect;
+        for (auto& access : current.accesses) {
+          if (access.write && needed[access.resource]) {
+            current.active = true;
+          }
+        }
+        if (!current.active) {
+          continue;
+        }
+        // the passes writing before a full write are overwritten, unless this pass reads what they wrote
+        for (auto& access : current.accesses) {
+          if (access.write) {
+            needed[access.resource] = m_resources[access.resource].output;
+          }
+        }
+        for (auto& access : current.accesses) {
+          if (!access.write) {
+            needed[access.resource] = true;
+          }
+        }
+      }
+    }
+
+    void RenderGraph::allocateTransients() {
+      Device* d = Device::getDevice();
+      VkDevice logical = d->getLogicalDevice();
+      VkPhysicalDeviceMemoryProperties memoryProperties;
+      vkGetPhysicalDeviceMemoryProperties(d->getPhysicalDevice(), &memoryProperties);
+
+      std::vector<uint32_t> transients;
+      for (uint32_t i = 0; i < m_resources.size(); i++) {
+        resource& r = m_resources[i];
+        if (!r.transient || r.firstPass == UINT32_MAX) {
+          continue;
+        }
+        r.requirements = Image::getMemoryRequirements(r.info.width, r.info.height, 1, r.info.format, r.info.usage);
+        r.memoryType = UINT32_MAX;
+        for (uint32_t type = 0; type < memoryProperties.memoryTypeCount; type++) {
+          if ((r.requirements.memoryTypeBits & (1 << type)) &&
+            (memoryProperties.memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) {
+            r.memoryType = type;
+            break;
+          }
+        }
+        if (r.memoryType == UINT32_MAX) {
+          ErrorCheck::setError("No device local memory type for a transient image of the RenderGraph");
+          continue;
+        }
+        m_unaliasedMemorySize += r.requirements.size;
+        transients.push_back(i);
+      }
+
+      // place the largest images first, each one at the lowest offset free of the images living at the same time
+      std::sort(transients.begin(), transients.end(), [this](uint32_t a, uint32_t b) {
+        return m_resources[a].requirements.size > m_resources[b].requirements.size;
+      });
+
+      auto liveTogether = [](const resource& a, const resource& b) {
+        return a.firstPass <= b.lastPass && b.firstPass <= a.lastPass;
+      };
+      auto overlap = [](const resource& a, const resource& b) {
+        return a.offset < b.offset + b.requirements.size && b.offset < a.offset + a.requirements.size;
+      };
+
+      std::vector<VkDeviceSize> memorySizes(memoryProperties.memoryTypeCount, 0);
+      std::vector<uint32_t> placed;
+      for (uint32_t i : transients) {
+        resource& r = m_resources[i];
+        std::vector<VkDeviceSize> candidates = { 0 };
+        for (uint32_t j : placed) {
+          const resource& other = m_resources[j];
+          if (other.memoryType == r.memoryType && liveTogether(r, other)) {
+            VkDeviceSize end = other.offset + other.requirements.size;
+            candidates.push_back((end + r.requirements.alignment - 1) / r.requirements.alignment * r.requirements.alignment);
+          }
+        }
+        std::sort(candidates.begin(), candidates.end());
+        for (VkDeviceSize offset : candidates) {
+          r.offset = offset;
+          bool free = std::none_of(placed.begin(), placed.end(), [&](uint32_t j) {
+            const resource& other = m_resources[j];
+            return other.memoryType == r.memoryType && liveTogether(r, other) && overlap(r, other);
+          });
+          if (free) {
+            break;
+          }
+        }
+        memorySizes[r.memoryType] = std::max(memorySizes[r.memoryType], r.offset + r.requirements.size);
+        placed.push_back(i);
+      }
+
+      // the first use of an image waits for the last use of every image sharing its memory, in this frame or the previous one,
+      // and makes their last writes available so the writes to the aliased memory are ordered
+      for (uint32_t i : placed) {
+        resource& r = m_resources[i];
+        r.waitStage = 0;
+        r.waitAccess = 0;
+        for (uint32_t j : placed) {
+          const resource& other = m_resources[j];
+          if (other.memoryType == r.memoryType && overlap(r, other)) {
+            r.waitStage |= other.lastStage;
+            r.waitAccess |= other.lastAccess;
+          }
+        }
+      }
+
+      for (uint32_t type = 0; type < memorySizes.size(); type++) {
+        if (memorySizes[type] == 0) {
+          continue;
+        }
+        VkMemoryAllocateInfo memory_allocate_info = {
+          VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,   // VkStructureType    sType
+          nullptr,                                  // const void       * pNext
+          memorySizes[type],                        // VkDeviceSize       allocationSize
+          type                                      // uint32_t           memoryTypeIndex
+        };
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkResult result = vkAllocateMemory(logical, &memory_allocate_info, nullptr, &memory);
+        if (VK_SUCCESS != result) {
+          ErrorCheck::setError("Could not allocate the memory of the transient images of the RenderGraph");
+          continue;
+        }
+        m_memories.push_back({ type, memory });
+        FrameStatistics::add(COUNTER_ALLOCATIONS);
+        MemoryBudget::registerAllocation(memory, memorySizes[type], memoryProperties.memoryTypes[type].heapIndex, MEMORY_ATTACHMENT);
+        m_memorySize += memorySizes[type];
+      }
+
+      for (uint32_t i : placed) {
+        resource& r = m_resources[i];
+        for (auto& memory : m_memories) {
+          if (memory.first == r.memoryType) {
+            r.image = std::make_shared<Image>(r.info.width, r.info.height, 1, r.info.format, r.info.aspect, r.info.usage, memory.second, r.offset);
+          }
+        }
+      }
+    }
+
+    void RenderGraph::compile() {
+      LAVACAKE_TRACE_ZONE("RenderGraph::compile");
+      release();
+
+      for (uint32_t p = 0; p < m_passes.size(); p++) {
+        for (auto& access : m_passes[p].accesses) {
+          resource& r = m_resources[access.resource];
+          if (r.transient && !access.write && r.firstPass == UINT32_MAX) {
+            ErrorCheck::setError("A transient image of the RenderGraph is read before being written");
+          }
+          if (r.transient && r.firstPass == UINT32_MAX) {
+            r.firstPass = p;
+          }
+        }
+      }
+
+      cull();
+
+      for (auto& r : m_resources) {
+        r.firstPass = UINT32_MAX;
+        r.lastPass = 0;
+        r.lastStage = 0;
+        r.lastAccess = 0;
+      }
+      for (uint32_t p = 0; p < m_passes.size(); p++) {
+        if (!m_passes[p].active) {
+          continue;
+        }
+        for (auto& access : m_passes[p].accesses) {
+          resource& r = m_resources[access.resource];
+          if (!r.transient) {
+            continue;
+          }
+          if (r.firstPass == UINT32_MAX) {
+            r.firstPass = p;
+          }
+          if (r.lastPass != p) {
+            r.lastStage = 0;
+            r.lastAccess = 0;
+          }
+          r.lastPass = p;
+          r.lastStage |= access.stage;
+          if (access.write) {
+            r.lastAccess |= access.access;
+          }
+        }
+      }
+
+      allocateTransients();
+      m_compiled = true;
+    }
+
+    void RenderGraph::execute(CommandBuffer& cmdBuff) {
+      LAVACAKE_TRACE_ZONE("RenderGraph::execute");
+      if (!m_compiled) {
+        ErrorCheck::setError("The RenderGraph must be compiled before being executed");
+        return;
+      }
+
+      for (uint32_t p = 0; p < m_passes.size(); p++) {
+        pass& current = m_passes[p];
+        if (!current.active) {
+          continue;
+        }
+
+        GPUScope scope(m_profiler.get(), cmdBuff, current.name);
+
+        BarrierBatch barriers(cmdBuff);
+        for (auto& access : current.accesses) {
+          resource& r = m_resources[access.resource];
+          if (r.buffer) {
+            barriers.setAccess(*r.buffer, access.stage, access.access);
+          }
+          else if (r.image) {
+            if (r.transient && r.firstPass == p) {
+              // the content of a transient image does not survive between frames, nor the images aliasing its memory
+              r.image->assumeLayout(VK_IMAGE_LAYOUT_UNDEFINED, r.waitStage, r.waitAccess);
+            }
+            VkImageSubresourceRange range = { (VkImageAspectFlags)r.image->aspect(), 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
+            barriers.setLayout(*r.image, access.layout, access.stage, range, access.access);
+          }
+        }
+        barriers.flush();
+
+        if (current.record) {
+          current.record(cmdBuff);
+        }
+
+        for (auto& access : current.accesses) {
+          resource& r = m_resources[access.resource];
+          if (r.image && access.finalLayout != VK_IMAGE_LAYOUT_UNDEFINED) {
+            r.image->assumeLayout(access.finalLayout, access.stage, access.access);
+          }
+        }
+      }
+    }
+
+    std::shared_ptr<Image> RenderGraph::getImage(uint32_t image) const {
+      if (image >= m_resources.size()) {
+        return nullptr;
+      }
+      return m_resources[image].image;
+    }
+
+    std::shared_ptr<Buffer> RenderGraph::getBuffer(uint32_t buffer) const {
+      if (buffer >= m_resources.size()) {
+        return nullptr;
+      }
+      return m_resources[buffer].buffer;
+    }
+
+    bool RenderGraph::isActive(uint32_t p) const {
+      return m_compiled && p < m_passes.size() && m_passes[p].active;
+    }
+
+    VkDeviceSize RenderGraph::getMemorySize() const {
+      return m_memorySize;
+    }
+
+    VkDeviceSize RenderGraph::getUnaliasedMemorySize() const {
+      return m_unaliasedMemorySize;
+    }
+
+    void RenderGraph::release() {
+      // the images are destroyed before the memory they are bound to
+      for (auto& r : m_resources) {
+        if (r.transient) {
+          r.image = nullptr;
+        }
+        r.firstPass = UINT32_MAX;
+      }
+
+      if (!m_memories.empty()) {
+        Device* d = Device::getDevice();
+        VkDevice logical = d->getLogicalDevice();
+        for (auto& memory : m_memories) {
+          MemoryBudget::releaseAllocation(memory.second);
+          vkFreeMemory(logical, memory.second, nullptr);
+          FrameStatistics::add(COUNTER_FREES);
+        }
+        m_memories.clear();
+      }
+      m_memorySize = 0;
+      m_unaliasedMemorySize = 0;
+      m_compiled = false;
+    }
+
+  }
+}
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include "Barrier.h"
+#include "GPUProfiler.h"
+
+namespace LavaCake {
+  namespace Framework {
+
+    /**
+    \brief the description of an image created and owned by a RenderGraph
+    */
+    struct transientImageInfo {
+      uint32_t                  width = 1;                                /*!< the width of the image */
+      uint32_t                  height = 1;                               /*!< the height of the image */
+      VkFormat                  format = VK_FORMAT_R8G8B8A8_UNORM;        /*!< the format of the image */
+      VkImageAspectFlagBits     aspect = VK_IMAGE_ASPECT_COLOR_BIT;       /*!< the aspect of the image */
+      VkImageUsageFlags         usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT; /*!< the usage of the image */
+    };
+
+    /**
+      Class RenderGraph :
+      \brief Schedule the passes of a frame from the resources they read and write.
+      The passes are recorded in the order they were added, a pass can only read what the passes added before it wrote.
+      At compile time the passes whose results are never read by a pass with side effects or written to an output resource
+      are culled, and the transient images are created in shared memory, images that are not used during the same passes
+      being bound to the same memory.
+      At execution the barriers and layout transitions needed by each pass are recorded in a single BarrierBatch before it.
+    */
+    class RenderGraph {
+    public:
+
+      RenderGraph() {};
+
+      RenderGraph(const RenderGraph&) = delete;
+      RenderGraph& operator=(const RenderGraph&) = delete;
+
+      /**
+        \brief add an image created outside of the graph, its content is kept between frames
+        \param image : the image
+        \param output : (optional) if true the passes writing the image are never culled
+        \return the handle of the resource in the graph
+      */
+      uint32_t importImage(std::shared_ptr<Image> image, bool output = true);
+
+      /**
+        \brief add a buffer created outside of the graph, its content is kept between frames
+        \param buffer : the buffer
+        \param output : (optional) if true the passes writing the buffer are never culled
+        \return the handle of the resource in the graph
+      */
+      uint32_t importBuffer(std::shared_ptr<Buffer> buffer, bool output = true);
+
+      /**
+        \brief add a 2D image created by the graph, its content only lives from the first pass writing it to the last pass reading it in a frame
+        \param info : the description of the image
+        \return the handle of the resource in the graph
+      */
+      uint32_t createImage(const transientImageInfo& info);
+
+      /**
+        \brief add a pass to the graph
+        \param name : the name of the pass
+        \param record : the function recording the commands of the pass, called by execute with the command buffer of the frame
+        \param sideEffect : (optional) if true the pass is never culled, for passes presenting or reading back their results
+        \return the handle of the pass in the graph
+      */
+      uint32_t addPass(const std::string& name, std::function<void(CommandBuffer&)> record, bool sideEffect = false);
+
+      /**
+        \brief declare that a pass reads an image
+        \param pass : the handle of the pass
+        \param image : the handle of the image
+        \param layout : the layout the image must be in during the pass
+        \param stage : the stages of the pass reading the image
+        \param access : the access mode of the pass
+      */
+      void readImage(uint32_t pass, uint32_t image, VkImageLayout layout, VkPipelineStageFlags stage, VkAccessFlags access);
+
+      /**
+        \brief declare that a pass writes an image
+        \param pass : the handle of the pass
+        \param image : the handle of the image
+        \param layout : the layout the image must be in at the beginning of the pass
+        \param stage : the stages of the pass writing the image
+        \param access : the access mode of the pass
+        \param finalLayout : (optional) the layout the pass leaves the image in, for render passes changing the layout of their attachments
+      */
+      void writeImage(uint32_t pass, uint32_t image, VkImageLayout layout, VkPipelineStageFlags stage, VkAccessFlags access, VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED);
+
+      /**
+        \brief declare that a pass reads a buffer
+        \param pass : the handle of the pass
+        \param buffer : the handle of the buffer
+        \param stage : the stages of the pass reading the buffer
+        \param access : the access mode of the pass
+      */
+      void readBuffer(uint32_t pass, uint32_t buffer, VkPipelineStageFlags stage, VkAccessFlags access);
+
+      /**
+        \brief declare that a pass writes a buffer
+        \param pass : the handle of the pass
+        \param buffer : the handle of the buffer
+        \param stage : the stages of the pass writing the buffer
+        \param access : the access mode of the pass
+      */
+      void writeBuffer(uint32_t pass, uint32_t buffer, VkPipelineStageFlags stage, VkAccessFlags access);
+
+      /**
+        \brief cull the passes, compute the lifetime of the transient images and create them, must be called again after the graph is modified.
+        The transient images of the previous compilation are destroyed, they must not be used by the device anymore
+      */
+      void compile();
+
+      /**
+        \brief record the passes that were not culled and the barriers between them
+        \param cmdBuff : the command buffer of the frame, must be in a recording state
+      */
+      void execute(CommandBuffer& cmdBuff);
+
+      /**
+        \brief measure the GPU time of each pass in a scope of a profiler named after the pass
+        \param profiler : the profiler, nullptr to stop measuring
+      */
+      void setProfiler(std::shared_ptr<GPUProfiler> profiler) {
+        m_profiler = profiler;
+      }
+
+      /**
+        \brief get an image of the graph, transient images only exist once the graph is compiled and if a pass uses them
+        \param image : the handle of the image
+      */
+      std::shared_ptr<Image> getImage(uint32_t image) const;
+
+      /**
+        \brief get a buffer imported in the graph
+        \param buffer : the handle of the buffer
+      */
+      std::shared_ptr<Buffer> getBuffer(uint32_t buffer) const;
+
+      /**
+        \brief check if a pass is recorded by execute, false if it was culled
+        \param pass : the handle of the pass
+      */
+      bool isActive(uint32_t pass) const;
+
+      /**
+        \brief get the memory allocated for the transient images
+      */
+      VkDeviceSize getMemorySize() const;
+
+      /**
+        \brief get the memory the transient images would need without aliasing
+      */
+      VkDeviceSize getUnaliasedMemorySize() const;
+
+      ~RenderGraph() {
+        release();
+      }
+
+    private:
+
+      struct resourceAccess {
+        uint32_t                resource;
+        VkPipelineStageFlags    stage;
+        VkAccessFlags           access;
+        VkImageLayout           layout;
+        VkImageLayout           finalLayout;
+        bool                    write;
+      };
+
+      struct pass {
+        std::string                           name;
+        std::function<void(CommandBuffer&)>   record;
+        std::vector<resourceAccess>           accesses;
+        bool                                  sideEffect = false;
+        bool                                  active = false;
+      };
+
+      struct resource {
+        std::shared_ptr<Image>    image;
+        std::shared_ptr<Buffer>   buffer;
+        bool                      output = false;
+        bool                      transient = false;
+        transientImageInfo        info;
+
+        // lifetime and placement of a transient image, set by compile
+        uint32_t                  firstPass = UINT32_MAX;
+        uint32_t                  lastPass = 0;
+        VkPipelineStageFlags      lastStage = 0;
+        VkAccessFlags             lastAccess = 0;
+        VkPipelineStageFlags      waitStage = 0;
+        VkAccessFlags             waitAccess = 0;
+        VkMemoryRequirements      requirements = {};
+        uint32_t                  memoryType = 0;
+        VkDeviceSize              offset = 0;
+      };
+
+      void addAccess(uint32_t pass, const resourceAccess& access, bool image);
+
+      void cull();
+
+      void allocateTransients();
+
+      void release();
+
+      std::vector<pass>                                         m_passes;
+      std::vector<resource>                                     m_resources;
+      // one memory per memory type shared by the transient images
+      std::vector<std::pair<uint32_t, VkDeviceMemory>>          m_memories;
+      VkDeviceSize                                              m_memorySize = 0;
+      VkDeviceSize                                              m_unaliasedMemorySize = 0;
+      bool                                                      m_compiled = false;
+      std::shared_ptr<GPUProfiler>                              m_profiler;
+    };
+
+  }
+}
@@ -1,4 +1,6 @@
 #include "RenderPass.h"
+#include "Barrier.h"
+#include <LavaCake/Helpers/Trace.h>
 namespace LavaCake {
   namespace Framework {
 
@@ -200,6 +202,7 @@ namespace LavaCake {
     }
 
     void RenderPass::compile() {
+      LAVACAKE_TRACE_ZONE("RenderPass::compile");
       Device* d = Device::getDevice();
       VkDevice logicalDevice = d->getLogicalDevice();
 
@@ -246,6 +249,7 @@ namespace LavaCake {
     }
 
     void RenderPass::draw(CommandBuffer& commandBuffer, FrameBuffer& frameBuffer, vec2u viewportMin, vec2u viewportMax, std::vector<VkClearValue> const& clear_values) {
+      LAVACAKE_TRACE_ZONE("RenderPass::draw");
 
       VkRenderPassBeginInfo renderPassBeginInfo = {
         VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,																																														 // VkStructureType        sType
@@ -257,6 +261,9 @@ namespace LavaCake {
         clear_values.data()																																																									 // const VkClearValue   * pClearValues
       };
 
+      GPUScope scope(m_profiler.get(), commandBuffer, m_profilerName);
+      bool profile = m_profiler != nullptr && m_profiler->isEnabled();
+
       vkCmdBeginRenderPass(commandBuffer.getHandle(), &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
       for (uint32_t i = 0; i < m_subpass.size(); i++) {
 
@@ -264,20 +271,30 @@ namespace LavaCake {
           vkCmdNextSubpass(commandBuffer.getHandle(), VK_SUBPASS_CONTENTS_INLINE);
         }
 
+        uint32_t subpassScope = profile ? m_profiler->beginScope(commandBuffer, m_profilerName + "/subpass " + std::to_string(i)) : UINT32_MAX;
         for (uint32_t j = 0; j < m_subpass[i].size(); j++) {
           m_subpass[i][j]->draw(commandBuffer);
         }
+        if (profile) {
+          m_profiler->endScope(commandBuffer, subpassScope);
+        }
       }
 
       vkCmdEndRenderPass(commandBuffer.getHandle());
     }
 
+    void RenderPass::setProfiler(std::shared_ptr<GPUProfiler> profiler, const std::string& name) {
+      m_profiler = profiler;
+      m_profilerName = name;
+    }
+
 
     const VkRenderPass& RenderPass::getHandle() const {
       return m_renderPass;
     }
 
     void RenderPass::prepareOutputFrameBuffer(const Queue& queue, CommandBuffer& commandBuffer, FrameBuffer& frameBuffer) {
+      LAVACAKE_TRACE_ZONE("RenderPass::prepareOutputFrameBuffer");
       Device* d = Device::getDevice();
       VkDevice logical = d->getLogicalDevice();
 
@@ -302,10 +319,8 @@ namespace LavaCake {
         false																			// VkBool32                 unnormalizedCoordinates
       };
 
-      VkResult result = vkCreateSampler(logical, &sampler_create_info, nullptr, &frameBuffer.m_sampler);
-      if (VK_SUCCESS != result) {
-        ErrorCheck::setError("Could not create sampler for this FrameBuffer.");
-      }
+      SamplerCache::release(frameBuffer.m_sampler);
+      frameBuffer.m_sampler = SamplerCache::acquire(sampler_create_info);
 
       VkImageUsageFlagBits usage;
       VkImageAspectFlagBits aspect;
@@ -318,6 +333,7 @@ namespace LavaCake {
 
 
       commandBuffer.beginRecord();
+      BarrierBatch layoutBarriers(commandBuffer);
       for (size_t i = 0; i < m_attachmentype.size(); i++) {
 
 
@@ -377,9 +393,10 @@ namespace LavaCake {
 
         VkImageSubresourceRange subresourceRange{ (VkImageAspectFlags)aspect, 0, 1, 0, 1 };
 
-        frameBuffer.m_images[i]->setLayout(commandBuffer, layout, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, subresourceRange);
+        layoutBarriers.setLayout(*frameBuffer.m_images[i], layout, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, subresourceRange);
 
       }
+      layoutBarriers.flush();
 
       commandBuffer.endRecord();
       commandBuffer.submit(queue, {}, {});
@@ -2,6 +2,7 @@
 #include "AllHeaders.h"
 #include "GraphicPipeline.h"
 #include "SwapChain.h"
+#include "GPUProfiler.h"
 
 namespace LavaCake {
   namespace Framework {
@@ -107,6 +108,13 @@ namespace LavaCake {
       */
       void draw(CommandBuffer& commandBuffer, FrameBuffer& frameBuffer, vec2u viewportMin, vec2u viewportMax, std::vector<VkClearValue> const& clear_values = { { 1.0f, 0 } });
 
+      /*
+      \brief measure the GPU time of each draw and of each of its subpasses in scopes of a profiler
+      \param profiler the profiler, nullptr to stop measuring
+      \param name (optional) the name of the scope, the subpasses are named after it
+      */
+      void setProfiler(std::shared_ptr<GPUProfiler> profiler, const std::string& name = "renderpass");
+
       /*
       \return the handle of the render pass
       */
@@ -162,6 +170,9 @@ namespace LavaCake {
 
       int																										m_khr_attachement = -1;
 
+      std::shared_ptr<GPUProfiler>                          m_profiler;
+      std::string                                           m_profilerName;
+
 
     };
   }
@@ -0,0 +1,115 @@
+#include "SamplerCache.h"
+#include "Device.h"
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace LavaCake {
+  namespace Framework {
+
+    namespace {
+      struct cachedSampler {
+        VkSamplerCreateInfo         info;
+        VkSampler                   sampler;
+        uint32_t                    references;
+        bool                        shared;
+      };
+
+      // there are few distinct samplers in an application, a linear search is enough
+      struct samplerRegistry {
+        std::mutex                        mutex;
+        std::vector<cachedSampler>        samplers;
+        // destroyed by clear while still referenced, their users release them after the device is destroyed
+        std::vector<VkSampler>            cleared;
+      };
+
+      samplerRegistry& registry() {
+        static samplerRegistry r;
+        return r;
+      }
+
+      bool sameSampler(const VkSamplerCreateInfo& a, const VkSamplerCreateInfo& b) {
+        return a.flags == b.flags &&
+          a.magFilter == b.magFilter &&
+          a.minFilter == b.minFilter &&
+          a.mipmapMode == b.mipmapMode &&
+          a.addressModeU == b.addressModeU &&
+          a.addressModeV == b.addressModeV &&
+          a.addressModeW == b.addressModeW &&
+          a.mipLodBias == b.mipLodBias &&
+          a.anisotropyEnable == b.anisotropyEnable &&
+          a.maxAnisotropy == b.maxAnisotropy &&
+          a.compareEnable == b.compareEnable &&
+          a.compareOp == b.compareOp &&
+          a.minLod == b.minLod &&
+          a.maxLod == b.maxLod &&
+          a.borderColor == b.borderColor &&
+          a.unnormalizedCoordinates == b.unnormalizedCoordinates;
+      }
+    }
+
+    VkSampler SamplerCache::acquire(const VkSamplerCreateInfo& info) {
+      samplerRegistry& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+
+      // the structures chained in pNext cannot be compared, these samplers are created for a single user
+      bool shared = info.pNext == nullptr;
+      if (shared) {
+        for (auto& s : r.samplers) {
+          if (s.shared && sameSampler(s.info, info)) {
+            s.references++;
+            return s.sampler;
+          }
+        }
+      }
+
+      VkSampler sampler = VK_NULL_HANDLE;
+      VkResult result = vkCreateSampler(Device::getDevice()->getLogicalDevice(), &info, nullptr, &sampler);
+      if (VK_SUCCESS != result) {
+        ErrorCheck::setError("Could not create sampler.");
+        return VK_NULL_HANDLE;
+      }
+      r.samplers.push_back({ info, sampler, 1, shared });
+      r.samplers.back().info.pNext = nullptr;
+      return sampler;
+    }
+
+    void SamplerCache::release(VkSampler sampler) {
+      if (VK_NULL_HANDLE == sampler) {
+        return;
+      }
+      samplerRegistry& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      auto it = std::find_if(r.samplers.begin(), r.samplers.end(), [&](const cachedSampler& s) { return s.sampler == sampler; });
+      if (it == r.samplers.end()) {
+        auto cleared = std::find(r.cleared.begin(), r.cleared.end(), sampler);
+        if (cleared == r.cleared.end()) {
+          ErrorCheck::setError("Releasing a sampler that was not created by the SamplerCache", 1);
+        }
+        return;
+      }
+      if (--it->references == 0) {
+        vkDestroySampler(Device::getDevice()->getLogicalDevice(), it->sampler, nullptr);
+        r.samplers.erase(it);
+      }
+    }
+
+    size_t SamplerCache::size() {
+      samplerRegistry& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      return r.samplers.size();
+    }
+
+    void SamplerCache::clear() {
+      samplerRegistry& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      VkDevice logical = Device::getDevice()->getLogicalDevice();
+      for (auto& s : r.samplers) {
+        vkDestroySampler(logical, s.sampler, nullptr);
+        r.cleared.push_back(s.sampler);
+      }
+      r.samplers.clear();
+    }
+
+  }
+}
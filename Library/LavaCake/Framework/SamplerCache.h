@@ -0,0 +1,44 @@
+#pragma once
+
+#include "AllHeaders.h"
+#include <cstddef>
+
+namespace LavaCake {
+  namespace Framework {
+
+    /**
+      Class SamplerCache :
+      \brief Share the VkSampler objects of the device between every image and frame buffer created with the same parameters.
+      Samplers are reference counted, identical create infos return the same handle and the sampler is destroyed when its last user
+      releases it, so that a large number of textures does not exhaust maxSamplerAllocationCount.
+    */
+    class SamplerCache {
+    public:
+
+      /**
+        \brief get a sampler matching a create info, created on the first request, every call must be matched by a call to release
+        \param info : the create info of the sampler, samplers with a pNext chain are not shared
+        \return the sampler, VK_NULL_HANDLE if it could not be created
+      */
+      static VkSampler acquire(const VkSamplerCreateInfo& info);
+
+      /**
+        \brief release a sampler returned by acquire, it is destroyed once it has no user left
+        \param sampler : the sampler
+      */
+      static void release(VkSampler sampler);
+
+      /**
+        \brief get the number of samplers alive
+      */
+      static size_t size();
+
+      /**
+        \brief destroy every sampler still alive, called by Device::end before the logical device is destroyed.
+        The images outliving the device release their destroyed samplers silently
+      */
+      static void clear();
+    };
+
+  }
+}
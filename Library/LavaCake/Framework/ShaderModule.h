@@ -2,6 +2,8 @@
 
 #include "AllHeaders.h"
 #include "Device.h"
+#include <cstring>
+#include <type_traits>
 
 namespace LavaCake {
   namespace Framework {
@@ -14,6 +16,92 @@ namespace LavaCake {
       VkSpecializationInfo const* specializationInfo;
     };
 
+    /**
+     Class SpecializationConstants :
+     \brief A typed builder for VkSpecializationInfo, the values of the specialization constants of a shader are baked when
+     the pipeline is compiled so that the driver can fold them (workgroup sizes, loop bounds, feature switches...).
+     The VkSpecializationInfo returned by getInfo points into the builder, which must not be modified or destroyed before
+     the pipeline using it is compiled.
+     */
+    class SpecializationConstants {
+    public:
+
+      /**
+      \brief set the value of a specialization constant, replacing its previous value
+      \param constantID the id of the constant in the shader, layout(constant_id = constantID)
+      \param value the value of the constant, a bool, a 32 bits integer, a float or a double
+      \return the builder, so that calls can be chained
+      */
+      template<typename T>
+      SpecializationConstants& set(uint32_t constantID, T value) {
+        static_assert(std::is_arithmetic_v<T> && (sizeof(T) == 4 || sizeof(T) == 8 || std::is_same_v<T, bool>), "specialization constants are booleans, 32 bits integers, floats or doubles");
+        if constexpr (std::is_same_v<T, bool>) {
+          return set<VkBool32>(constantID, value ? VK_TRUE : VK_FALSE);
+        }
+        else {
+          for (auto& entry : m_entries) {
+            if (entry.constantID == constantID) {
+              if (entry.size == sizeof(T)) {
+                std::memcpy(m_data.data() + entry.offset, &value, sizeof(T));
+                return *this;
+              }
+              // the type changed, the old bytes are left unused
+              entry.offset = static_cast<uint32_t>(m_data.size());
+              entry.size = sizeof(T);
+              m_data.resize(m_data.size() + sizeof(T));
+              std::memcpy(m_data.data() + entry.offset, &value, sizeof(T));
+              return *this;
+            }
+          }
+          m_entries.push_back({
+            constantID,                                     // uint32_t    constantID
+            static_cast<uint32_t>(m_data.size()),           // uint32_t    offset
+            sizeof(T)                                       // size_t      size
+            });
+          m_data.resize(m_data.size() + sizeof(T));
+          std::memcpy(m_data.data() + m_entries.back().offset, &value, sizeof(T));
+          return *this;
+        }
+      }
+
+      /**
+      \brief set the workgroup size of a compute shader declared with layout(local_size_x_id = firstID, local_size_y_id = firstID + 1, local_size_z_id = firstID + 2)
+      \param x the size of the workgroup along x
+      \param y the size of the workgroup along y
+      \param z the size of the workgroup along z
+      \param firstID the constant id of the x size
+      \return the builder, so that calls can be chained
+      */
+      SpecializationConstants& setWorkGroupSize(uint32_t x, uint32_t y = 1, uint32_t z = 1, uint32_t firstID = 0) {
+        return set(firstID, x).set(firstID + 1, y).set(firstID + 2, z);
+      }
+
+      /**
+      \brief check if no constant was set
+      */
+      bool empty() const {
+        return m_entries.empty();
+      }
+
+      /**
+      \brief get the VkSpecializationInfo describing the constants, valid until the builder is modified or destroyed
+      */
+      const VkSpecializationInfo* getInfo() {
+        m_info = {
+          static_cast<uint32_t>(m_entries.size()),          // uint32_t                           mapEntryCount
+          m_entries.data(),                                 // const VkSpecializationMapEntry   * pMapEntries
+          m_data.size(),                                    // size_t                             dataSize
+          m_data.data()                                     // const void                       * pData
+        };
+        return &m_info;
+      }
+
+    private:
+      std::vector<VkSpecializationMapEntry>                   m_entries;
+      std::vector<std::byte>                                  m_data;
+      VkSpecializationInfo                                    m_info = {};
+    };
+
 
     class ShaderModule {
     protected:
@@ -6,6 +6,7 @@
 #include "ErrorCheck.h"
 #include "Device.h"
 #include "CommandBuffer.h"
+#include "MemoryBudget.h"
 
 
 
@@ -200,6 +201,11 @@ namespace LavaCake {
         if (result != VK_SUCCESS) {
           ErrorCheck::setError("Failed to present the image");
         }
+
+        // presenting closes the frame of the counters and checks the memory budget, applications without swapchain call
+        // FrameStatistics::endFrame and MemoryBudget::checkBudget themselves
+        FrameStatistics::endFrame();
+        MemoryBudget::checkBudget();
       }
 
     private:
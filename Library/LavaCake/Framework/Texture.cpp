@@ -1,5 +1,7 @@
 #include "Texture.h"
 #include "CommandBuffer.h"
+#include <LavaCake/Helpers/Trace.h>
+#include <algorithm>
 
 
 namespace LavaCake {
@@ -81,6 +83,7 @@ namespace LavaCake {
     }
 
     Image createTextureBuffer(const Queue& queue, CommandBuffer& cmdBuff, const std::vector<unsigned char>& data, int width, int height, int depth, int nbChannel, VkFormat format, VkPipelineStageFlagBits stageFlagBit) {
+      LAVACAKE_TRACE_ZONE("createTextureBuffer");
 
       Image image(width, height, depth, format, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
 
@@ -122,6 +125,7 @@ namespace LavaCake {
     }
 
     Image createCubeMap(const  Queue& queue, CommandBuffer& cmdBuff, const std::string& path, int nbChannel, const std::array<std::string, 6>& images, VkFormat f, VkPipelineStageFlagBits stageFlagBit) {
+      LAVACAKE_TRACE_ZONE("createCubeMap");
 
       std::vector<unsigned char> cubemap_image_data;
 
@@ -178,6 +182,145 @@ namespace LavaCake {
       return image;
     };
 
+    Image createTextureArray(int width, int height, uint32_t layers, VkFormat format) {
+      Image image(width, height, 1, format, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, false, layers, true);
+      image.createSampler();
+      return image;
+    }
+
+    Image createTextureArray(const Queue& queue, CommandBuffer& cmdBuff, const std::vector<std::vector<unsigned char>>& layers, int width, int height, int nbChannel, VkFormat format, VkPipelineStageFlagBits stageFlagBit) {
+      LAVACAKE_TRACE_ZONE("createTextureArray");
+
+      if (layers.empty() || width <= 0 || height <= 0 || nbChannel <= 0) {
+        ErrorCheck::setError("Could not create a texture array without layers or with an empty size");
+        return createTextureArray(std::max(width, 1), std::max(height, 1), 1, format);
+      }
+
+      Image image = createTextureArray(width, height, static_cast<uint32_t>(layers.size()), format);
+
+      // the copy reads width * height * nbChannel bytes per layer, shorter data would be read past the end of the staging buffer
+      size_t layerSize = size_t(width) * size_t(height) * size_t(nbChannel);
+      for (size_t i = 0; i < layers.size(); ++i) {
+        if (layers[i].size() != layerSize) {
+          ErrorCheck::setError("The size of a layer does not match the size of the texture array");
+          return image;
+        }
+      }
+
+      // the layers are packed one after the other in the staging buffer, a single region copies all of them
+      std::vector<unsigned char> data;
+      data.reserve(layers.size() * layerSize);
+      for (size_t i = 0; i < layers.size(); ++i) {
+        data.insert(data.end(), layers[i].begin(), layers[i].end());
+      }
+
+      Buffer stagingBuffer(queue, cmdBuff, data, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+
+      cmdBuff.beginRecord();
+
+      VkImageSubresourceLayers image_subresource_layer = {
+        VK_IMAGE_ASPECT_COLOR_BIT,                    // VkImageAspectFlags     aspectMask
+        0,                                            // uint32_t               mipLevel
+        0,                                            // uint32_t               baseArrayLayer
+        static_cast<uint32_t>(layers.size())          // uint32_t               layerCount
+      };
+
+      VkBufferImageCopy region = {
+            0,																																								// VkDeviceSize               bufferOffset
+            0,																																								// uint32_t                   bufferRowLength
+            0,																																								// uint32_t                   bufferImageHeight
+            image_subresource_layer,																													// VkImageSubresourceLayers   imageSubresource
+            { 0, 0, 0 },																																			// VkOffset3D                 imageOffset
+            { image.width(), image.height(), 1 },																							// VkExtent3D                 imageExtent
+      };
+
+      VkImageSubresourceRange subresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, static_cast<uint32_t>(layers.size()) };
+      image.setLayout(cmdBuff, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, subresourceRange);
+
+      stagingBuffer.copyToImage(cmdBuff, image, { region });
+
+      image.setLayout(cmdBuff, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, stageFlagBit, subresourceRange);
+
+      cmdBuff.endRecord();
+      cmdBuff.submit(queue, {}, {});
+      cmdBuff.wait(UINT32_MAX);
+      cmdBuff.resetFence();
+      return image;
+    }
+
+    Image createTextureArray(const Queue& queue, CommandBuffer& cmdBuff, const std::vector<std::string>& filenames, int nbChannel, VkFormat f, VkPipelineStageFlagBits stageFlagBit) {
+      std::vector<std::vector<unsigned char>> layers(filenames.size());
+      int width = 0, height = 0;
+      for (size_t i = 0; i < filenames.size(); ++i) {
+        int layerWidth = 0, layerHeight = 0;
+        if (!Helpers::LoadTextureDataFromFile(filenames[i].c_str(), nbChannel, layers[i], &layerWidth, &layerHeight)) {
+          ErrorCheck::setError("Could not load all texture file");
+          return createTextureArray(std::max(width, 1), std::max(height, 1), static_cast<uint32_t>(std::max<size_t>(filenames.size(), 1)), f);
+        }
+        if (i == 0) {
+          width = layerWidth;
+          height = layerHeight;
+        }
+        else if (layerWidth != width || layerHeight != height) {
+          ErrorCheck::setError("The textures of a texture array must have the same size");
+          return createTextureArray(width, height, static_cast<uint32_t>(filenames.size()), f);
+        }
+      }
+
+      return createTextureArray(queue, cmdBuff, layers, width, height, nbChannel, f, stageFlagBit);
+    }
+
+    void uploadTextureLayer(const Queue& queue, CommandBuffer& cmdBuff, Image& image, const std::vector<unsigned char>& data, int nbChannel, uint32_t layer, VkPipelineStageFlagBits stageFlagBit) {
+      LAVACAKE_TRACE_ZONE("uploadTextureLayer");
+
+      if (layer >= image.layers()) {
+        ErrorCheck::setError("The layer is out of the texture array");
+        return;
+      }
+
+      if (nbChannel <= 0 || data.size() != size_t(image.width()) * size_t(image.height()) * size_t(nbChannel)) {
+        ErrorCheck::setError("The size of the data does not match the size of a layer of the texture array");
+        return;
+      }
+
+      Buffer stagingBuffer(queue, cmdBuff, data, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+
+      cmdBuff.beginRecord();
+
+      // the layout is tracked for the whole image, the first upload moves every layer out of the undefined layout so they all share the same layout afterwards
+      VkImageSubresourceRange subresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, layer, 1 };
+      if (image.getLayout() == VK_IMAGE_LAYOUT_UNDEFINED) {
+        subresourceRange.baseArrayLayer = 0;
+        subresourceRange.layerCount = image.layers();
+      }
+      image.setLayout(cmdBuff, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, subresourceRange);
+
+      VkImageSubresourceLayers image_subresource_layer = {
+        VK_IMAGE_ASPECT_COLOR_BIT,    // VkImageAspectFlags     aspectMask
+        0,                            // uint32_t               mipLevel
+        layer,                        // uint32_t               baseArrayLayer
+        1                             // uint32_t               layerCount
+      };
+
+      VkBufferImageCopy region = {
+            0,																																								// VkDeviceSize               bufferOffset
+            0,																																								// uint32_t                   bufferRowLength
+            0,																																								// uint32_t                   bufferImageHeight
+            image_subresource_layer,																													// VkImageSubresourceLayers   imageSubresource
+            { 0, 0, 0 },																																			// VkOffset3D                 imageOffset
+            { image.width(), image.height(), 1 },																							// VkExtent3D                 imageExtent
+      };
+
+      stagingBuffer.copyToImage(cmdBuff, image, { region });
+
+      image.setLayout(cmdBuff, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, stageFlagBit, subresourceRange);
+
+      cmdBuff.endRecord();
+      cmdBuff.submit(queue, {}, {});
+      cmdBuff.wait(UINT32_MAX);
+      cmdBuff.resetFence();
+    }
+
 
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
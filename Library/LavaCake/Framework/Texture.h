@@ -84,10 +84,8 @@ namespace LavaCake {
           m_frameBuffer = VK_NULL_HANDLE;
         }
 
-        if (VK_NULL_HANDLE != m_sampler) {
-          vkDestroySampler(logical, m_sampler, nullptr);
-          m_sampler = VK_NULL_HANDLE;
-        }
+        SamplerCache::release(m_sampler);
+        m_sampler = VK_NULL_HANDLE;
 
         if (VK_NULL_HANDLE != m_imageMemory) {
           vkFreeMemory(logical, m_imageMemory, nullptr);
@@ -194,5 +192,51 @@ namespace LavaCake {
     */
     Image createCubeMap(const Queue& queue, CommandBuffer& cmdBuff, const std::string& path, int nbChannel, const std::array<std::string, 6>& images = { "posx.jpg","negx.jpg","posy.jpg","negy.jpg","posz.jpg","negz.jpg" }, VkFormat f = VK_FORMAT_R8G8B8A8_UNORM, VkPipelineStageFlagBits stageFlagBit = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
 
+    /**
+      \brief create an empty 2D array texture, its layers are filled with uploadTextureLayer.
+      Draws that only differ by their texture can sample the same array texture with a layer index instead of switching descriptors.
+      \param width: the with of each layer
+      \param height: the height of each layer
+      \param layers: the number of layers
+      \param format: the format of the image
+    */
+    Image createTextureArray(int width, int height, uint32_t layers, VkFormat format = VK_FORMAT_R8G8B8A8_UNORM);
+
+    /**
+      \brief create a 2D array texture and initialize each layer, the layers are uploaded with a single staging buffer and a single submission.
+      \param queue: a pointer to the queue that will be used to copy data to the Buffer
+      \param cmdBuff: the command buffer used for this operation, must not be in a recording state
+      \param layers: the data of each layer, of width * height * nbChannel bytes
+      \param width: the with of each layer
+      \param height: the height of each layer
+      \param nbChannel: the number of channel in the layers
+      \param format: the format of the image
+      \param stageFlagBit: the stage in which the shader will be used
+    */
+    Image createTextureArray(const Queue& queue, CommandBuffer& cmdBuff, const std::vector<std::vector<unsigned char>>& layers, int width, int height, int nbChannel, VkFormat format = VK_FORMAT_R8G8B8A8_UNORM, VkPipelineStageFlagBits stageFlagBit = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+    /**
+      \brief create a 2D array texture with one layer per texture file, the files must have the same size.
+      \param queue: a pointer to the queue that will be used to copy data to the Buffer
+      \param cmdBuff: the command buffer used for this operation, must not be in a recording state
+      \param filenames: the path to the file of each layer
+      \param nbChannel: the number of channel to use from the textures
+      \param format: the format of the image
+      \param stageFlagBit: the stage in which the shader will be used
+    */
+    Image createTextureArray(const Queue& queue, CommandBuffer& cmdBuff, const std::vector<std::string>& filenames, int nbChannel, VkFormat f = VK_FORMAT_R8G8B8A8_UNORM, VkPipelineStageFlagBits stageFlagBit = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+    /**
+      \brief upload the content of one layer of an array texture, the other layers are left untouched.
+      \param queue: a pointer to the queue that will be used to copy data to the Buffer
+      \param cmdBuff: the command buffer used for this operation, must not be in a recording state
+      \param image: the array texture, created with VK_IMAGE_USAGE_TRANSFER_DST_BIT
+      \param data: the data of the layer, of the size of one layer of the image
+      \param nbChannel: the number of channel in the layer
+      \param layer: the index of the layer
+      \param stageFlagBit: the stage in which the shader will be used
+    */
+    void uploadTextureLayer(const Queue& queue, CommandBuffer& cmdBuff, Image& image, const std::vector<unsigned char>& data, int nbChannel, uint32_t layer, VkPipelineStageFlagBits stageFlagBit = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
   }
 }
@@ -0,0 +1,70 @@
+#include "UniformArena.h"
+#include <algorithm>
+
+namespace LavaCake {
+  namespace Framework {
+
+    UniformArena::UniformArena(uint32_t sliceSize, uint32_t frameSize, uint32_t frameCount, bool storage) {
+      Device* d = Device::getDevice();
+      VkPhysicalDeviceProperties p;
+      vkGetPhysicalDeviceProperties(d->getPhysicalDevice(), &p);
+
+      m_storage = storage;
+      m_alignment = uint32_t(storage ? p.limits.minStorageBufferOffsetAlignment : p.limits.minUniformBufferOffsetAlignment);
+      if (m_alignment == 0) {
+        m_alignment = 1;
+      }
+
+      uint32_t maxRange = storage ? p.limits.maxStorageBufferRange : p.limits.maxUniformBufferRange;
+      if (sliceSize == 0 || sliceSize > maxRange) {
+        ErrorCheck::setError("The slice size of the UniformArena exceeds the maximum range of the device");
+        sliceSize = std::min(std::max(sliceSize, 1u), maxRange);
+      }
+
+      m_sliceSize = sliceSize;
+      m_frameCount = std::max(frameCount, 1u);
+      // every frame starts on an aligned offset and can hold at least one slice
+      m_frameSize = (std::max(frameSize, sliceSize) + m_alignment - 1) / m_alignment * m_alignment;
+
+      m_buffer = std::move(Buffer(uint64_t(m_frameSize) * m_frameCount,
+        storage ? VK_BUFFER_USAGE_STORAGE_BUFFER_BIT : VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT));
+
+      // the buffer stays mapped until it is destroyed, freeing its memory unmaps it
+      m_mapped = static_cast<std::byte*>(m_buffer.map());
+    }
+
+    void UniformArena::nextFrame() {
+      m_frame = (m_frame + 1) % m_frameCount;
+      m_cursor = m_frame * m_frameSize;
+      m_flushed = m_cursor;
+    }
+
+    uint32_t UniformArena::allocate(std::span<const std::byte> data) {
+      if (data.size() > m_sliceSize) [[unlikely]] {
+        ErrorCheck::setError("The data allocated in the UniformArena is larger than its slice size");
+        return UINT32_MAX;
+      }
+      // the shader reads a whole slice from the dynamic offset, it must stay in the frame
+      uint32_t offset = m_cursor;
+      if (offset + m_sliceSize > (m_frame + 1) * m_frameSize) [[unlikely]] {
+        ErrorCheck::setError("The current frame of the UniformArena is full");
+        return UINT32_MAX;
+      }
+
+      std::memcpy(m_mapped + offset, data.data(), data.size());
+      FrameStatistics::add(COUNTER_UPLOADED_BYTES, data.size());
+      uint32_t size = std::max(uint32_t(data.size()), 1u);
+      m_cursor = offset + (size + m_alignment - 1) / m_alignment * m_alignment;
+      return offset;
+    }
+
+    void UniformArena::flush() {
+      if (m_cursor > m_flushed) {
+        m_buffer.flush(m_flushed, m_cursor - m_flushed);
+        m_flushed = m_cursor;
+      }
+    }
+
+  }
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <span>
+#include "Buffer.h"
+#include "ByteDictionary.h"
+
+namespace LavaCake {
+  namespace Framework {
+
+    /**
+      Class UniformArena :
+      \brief A ring of per frame regions in one host visible buffer, in which many objects allocate aligned slices of
+      uniform (or storage) data each frame. The buffer is bound once with a dynamic descriptor (see DescriptorSet::addDynamicBuffer)
+      and each draw selects its slice with a dynamic offset, so thousands of objects share one buffer and one descriptor set.
+    */
+    class UniformArena {
+    public:
+
+      /**
+        \brief create the arena
+        \param sliceSize: the size in bytes of the block seen by the shader, the largest data that can be allocated at once
+        \param frameSize: the number of bytes available to the allocations of one frame
+        \param frameCount: the number of frames in the ring, usually the number of frames in flight
+        \param storage: if true the slices are bound as storage buffers instead of uniform buffers
+      */
+      UniformArena(uint32_t sliceSize, uint32_t frameSize, uint32_t frameCount = 2, bool storage = false);
+
+      UniformArena(const UniformArena&) = delete;
+      UniformArena& operator=(const UniformArena&) = delete;
+
+      /**
+        \brief start the allocations of the next frame of the ring, the device must have finished reading that frame
+        (for instance by waiting on the fence of the command buffer that used it)
+      */
+      void nextFrame();
+
+      /**
+        \brief copy data into a new slice of the current frame
+        \param data: the bytes to copy, at most sliceSize bytes
+        \return the dynamic offset of the slice, UINT32_MAX if the frame is full
+      */
+      uint32_t allocate(std::span<const std::byte> data);
+
+      /**
+        \brief copy a block of variables, laid out by a ByteDictionary, into a new slice of the current frame
+        \param block: the variables to copy
+        \return the dynamic offset of the slice, UINT32_MAX if the frame is full
+      */
+      uint32_t allocate(const ByteDictionary& block) {
+        return allocate(std::span<const std::byte>(block.data()));
+      }
+
+      /**
+        \brief copy a value into a new slice of the current frame
+        \param value: the value to copy, it must be laid out as the shader block
+        \return the dynamic offset of the slice, UINT32_MAX if the frame is full
+      */
+      template<typename T>
+      uint32_t allocate(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "values allocated in a UniformArena are copied as bytes");
+        return allocate(std::as_bytes(std::span<const T, 1>{ &value, 1 }));
+      }
+
+      /**
+        \brief make the slices allocated in the current frame visible to the device, to be called before submitting the frame
+      */
+      void flush();
+
+      /**
+        \brief get the buffer holding every frame
+      */
+      const Buffer& getBuffer() const { return m_buffer; };
+
+      /**
+        \brief get the size of the block seen by the shader
+      */
+      uint32_t getSliceSize() const { return m_sliceSize; };
+
+      /**
+        \brief get the alignment of the slices, the minimum dynamic offset alignment of the device
+      */
+      uint32_t getAlignment() const { return m_alignment; };
+
+      /**
+        \brief get the index of the current frame in the ring
+      */
+      uint32_t getFrameIndex() const { return m_frame; };
+
+      /**
+        \brief get the number of bytes allocated in the current frame
+      */
+      uint32_t getUsedSize() const { return m_cursor - m_frame * m_frameSize; };
+
+      /**
+        \brief check if the slices are bound as storage buffers
+      */
+      bool isStorage() const { return m_storage; };
+
+    private:
+
+      Buffer                                                    m_buffer;
+      std::byte*                                                m_mapped = nullptr;
+
+      uint32_t                                                  m_sliceSize = 0;
+      uint32_t                                                  m_frameSize = 0;
+      uint32_t                                                  m_frameCount = 0;
+      uint32_t                                                  m_alignment = 1;
+      bool                                                      m_storage = false;
+
+      uint32_t                                                  m_frame = 0;
+      uint32_t                                                  m_cursor = 0;
+      uint32_t                                                  m_flushed = 0;
+    };
+
+  }
+}
@@ -1,4 +1,5 @@
 #include "UniformBuffer.h"
+#include <LavaCake/Helpers/Trace.h>
 
 
 namespace LavaCake {
@@ -8,16 +9,27 @@ namespace LavaCake {
       //allocate both the buffer and the staging buffer
       m_stagingBuffer = std::move(Buffer(m_variables.data().size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT));
       m_buffer = std::move(Buffer(m_variables.data().size(), (VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+
+      // the staging buffer stays mapped until it is destroyed, freeing its memory unmaps it
+      m_mapped = static_cast<std::byte*>(m_stagingBuffer.map());
+      m_variables.setAllDirty();
     }
 
     void UniformBuffer::update(CommandBuffer& commandBuffer) {
-      copyToStageMemory(true);
+      LAVACAKE_TRACE_ZONE("UniformBuffer::update");
+      if (!m_variables.isDirty()) {
+        return;
+      }
+      if (m_mapped == nullptr) [[unlikely]] {
+        ErrorCheck::setError("The UniformBuffer must be ended before being updated");
+        return;
+      }
+
+      std::vector<VkBufferCopy> regions = copyToStageMemory();
 
       m_buffer.setAccess(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
 
-      // Idea : template copyToBuffer to avoid memory allocation (or just take a span as input)
-      // then we can use an std::array for regions above
-      m_stagingBuffer.copyToBuffer(commandBuffer, m_buffer, { 0, 0, m_variables.data().size() });
+      m_stagingBuffer.copyToBuffer(commandBuffer, m_buffer, std::span<VkBufferCopy>(regions));
 
       m_buffer.setAccess(commandBuffer, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_ACCESS_UNIFORM_READ_BIT);
     }
@@ -26,8 +38,29 @@ namespace LavaCake {
       return m_buffer.getHandle();
     };
 
-    void UniformBuffer::copyToStageMemory(bool /*all*/) {
-      m_stagingBuffer.write(m_variables.data());
+    std::vector<VkBufferCopy> UniformBuffer::copyToStageMemory(bool all) {
+      const std::vector<std::byte>& data = m_variables.data();
+      std::vector<std::pair<uint32_t, uint32_t>> ranges;
+      if (all) {
+        ranges.push_back({ 0, (uint32_t)data.size() });
+      }
+      else {
+        // close ranges are copied together, a copy region costs more than a few extra bytes
+        ranges = m_variables.dirtyRanges(64);
+      }
+
+      std::vector<VkBufferCopy> regions;
+      regions.reserve(ranges.size());
+      for (auto [offset, size] : ranges) {
+        std::memcpy(m_mapped + offset, data.data() + offset, size);
+        regions.push_back({ offset, offset, size });
+        FrameStatistics::add(COUNTER_UPLOADED_BYTES, size);
+      }
+      if (!ranges.empty()) {
+        m_stagingBuffer.flush(ranges.front().first, ranges.back().first + ranges.back().second - ranges.front().first);
+      }
+      m_variables.clearDirtyRanges();
+      return regions;
     }
 
     const Buffer& UniformBuffer::getBuffer() const {
@@ -21,6 +21,12 @@ namespace LavaCake {
     */
     class UniformBuffer {
     public:
+      /**
+        \brief create an empty UniformBuffer
+        \param layout: the rules used to place the variables, std140 by default as for uniform blocks in GLSL
+      */
+      UniformBuffer(blockLayout layout = STD140) : m_variables(layout) {};
+
       ~UniformBuffer() = default;
 
       /**
@@ -29,27 +35,33 @@ namespace LavaCake {
         \param value: the variable, either a simple data type of a contiguous range of simple data type.
       */
       template<typename T>
-      void addVariable(const std::string& name, const T& value) {
-        //    if constexpr(std::ranges::sized_range<T> && std::ranges::contiguous_range<T>) {
-        //      m_variables.addVariableRange(name, std::span { value });
-        //    } else {
-        m_variables.addVariableRange(name, std::span<const T, 1> { &value, 1 });
-        //    }
+      variableHandle<T> addVariable(const std::string& name, const T& value) {
+        return m_variables.addVariableRange(name, std::span<const T, 1> { &value, 1 });
       }
 
       template<typename T>
-      void addVariable(const std::string& name, const std::vector<T>& value) {
-        m_variables.addVariableRange(name, std::span{ value });
+      variableHandle<T> addVariable(const std::string& name, const std::vector<T>& value) {
+        return m_variables.addVariableRange(name, std::span<const T>{ value });
       }
 
+      /**
+        \brief Add a std::array into the dictionary, an array of 2, 3, 4, 9 or 16 scalars is a single vector or matrix variable.
+        \param name: the name of constant.
+        \param value: the variable.
+      */
       template<typename T, std::size_t N>
-      void addVariable(const std::string& name, const std::array<T, N>& value) {
-        m_variables.addVariableRange(name, std::span{ value });
+      auto addVariable(const std::string& name, const std::array<T, N>& value) {
+        if constexpr (std::is_arithmetic_v<T> && (N == 2 || N == 3 || N == 4 || N == 9 || N == 16)) {
+          return m_variables.addVariableRange(name, std::span<const std::array<T, N>, 1> { &value, 1 });
+        }
+        else {
+          return m_variables.addVariableRange(name, std::span<const T, N>{ value });
+        }
       }
 
       template<typename T, std::size_t Extent>
-      void addVariable(const std::string& name, const std::span<T, Extent>& value) {
-        m_variables.addVariableRange(name, std::span{ value });
+      variableHandle<std::remove_const_t<T>> addVariable(const std::string& name, const std::span<T, Extent>& value) {
+        return m_variables.addVariableRange(name, std::span<const T, Extent>{ value });
       }
 
       /**
@@ -59,11 +71,7 @@ namespace LavaCake {
       */
       template<typename T>
       void setVariable(const std::string& name, const T& value) {
-        //    if constexpr(std::ranges::sized_range<T> && std::ranges::contiguous_range<T>) {
-        //      m_variables.setVariableRange(name, std::span{ value });
-        //    } else {
         m_variables.setVariableRange(name, std::span<const T, 1>{ &value, 1 });
-        //    }
       }
 
       template<typename T>
@@ -81,13 +89,34 @@ namespace LavaCake {
         m_variables.setVariableRange(name, std::span{ value });
       }
 
+      /**
+        \brief set a variable through the handle returned by addVariable, without any name lookup.
+        \param variable : the handle of the variable
+        \param value: the new value of the variable
+      */
+      template<typename T>
+      void setVariable(const variableHandle<T>& variable, const T& value) {
+        m_variables.setVariableRange(variable, std::span<const T, 1>{ &value, 1 });
+      }
+
+      template<typename T>
+      void setVariable(const variableHandle<T>& variable, const std::vector<T>& value) {
+        m_variables.setVariableRange(variable, std::span<const T>{ value });
+      }
+
+      template<typename T, std::size_t Extent>
+      void setVariable(const variableHandle<std::remove_const_t<T>>& variable, const std::span<T, Extent>& value) {
+        m_variables.setVariableRange(variable, value);
+      }
+
       /**
         \brief notify the buffer that no new variable will be added
       */
       void end();
 
       /**
-        \brief update the gpu memory of the uniform buffer
+        \brief update the gpu memory of the uniform buffer, only the bytes of the variables set since the last update are copied
+        and nothing is recorded if no variable changed
         \param cmdBuff: the command buffer used for this operation, must be in a recording state
       */
       void update(CommandBuffer& commandBuffer);
@@ -98,10 +127,11 @@ namespace LavaCake {
 
     private:
 
-      void copyToStageMemory(bool all = false);
+      std::vector<VkBufferCopy> copyToStageMemory(bool all = false);
 
       Buffer                                                    m_buffer;
       Buffer                                                    m_stagingBuffer;
+      std::byte*                                                m_mapped = nullptr;
 
       ByteDictionary                                            m_variables;
     };
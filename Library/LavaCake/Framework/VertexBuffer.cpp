@@ -1,5 +1,7 @@
 #include "VertexBuffer.h"
 #include "CommandBuffer.h"
+#include <LavaCake/Math/transform.h>
+#include <LavaCake/Helpers/Trace.h>
 
 namespace LavaCake {
   namespace Framework {
@@ -11,6 +13,7 @@ namespace LavaCake {
       uint32_t binding,
       VkVertexInputRate inputRate,
       VkBufferUsageFlags otherUsage) {
+      LAVACAKE_TRACE_ZONE("VertexBuffer::VertexBuffer");
 
       m_topology = m[0]->getTopology();
       m_stride = (uint32_t)m[0]->vertexSize();
@@ -47,6 +50,13 @@ namespace LavaCake {
 
       if (vertices.size() == 0)return;
 
+      std::vector<Geometry::primitiveFormat> description = m[0]->getFormat().description();
+      if (!description.empty() && description[0] == Geometry::POS3) {
+        bounds3f bounds = ComputeBounds(vertices, m_stride);
+        m_boundingBox = Helpers::ABBox<3>(bounds.first, bounds.second);
+        m_hasBoundingBox = m_boundingBox.isValid();
+      }
+
       m_vertexBuffer = std::make_shared<Buffer>(queue, cmdBuff, vertices, (VkBufferUsageFlagBits)(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | otherUsage), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_FORMAT_R32_SFLOAT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
 
       if (m_indexed) {
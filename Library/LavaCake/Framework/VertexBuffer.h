@@ -3,6 +3,7 @@
 #include "Queue.h"
 #include "Device.h"
 #include <LavaCake/Geometry/mesh.h>
+#include <LavaCake/Helpers/ABBox.h>
 #include "Buffer.h"
 
 namespace LavaCake {
@@ -76,6 +77,20 @@ namespace LavaCake {
 
       bool isIndexed() const;
 
+      /**
+      \brief check if the vertex buffer has a bounding box, it is only computed when the first attribute of the vertex format is a POS3
+      */
+      bool hasABBox() const {
+        return m_hasBoundingBox;
+      }
+
+      /**
+      \brief get the bounding box of the vertices in object space
+      */
+      const Helpers::ABBox<3>& getABBox() const {
+        return m_boundingBox;
+      }
+
       ~VertexBuffer() {
       }
 
@@ -90,6 +105,8 @@ namespace LavaCake {
       uint32_t                                                      m_indicesSize = 0;
       uint32_t                                                      m_stride = 0;
       bool                                                          m_indexed = false;
+      bool                                                          m_hasBoundingBox = false;
+      Helpers::ABBox<3>                                             m_boundingBox;
       LavaCake::Geometry::topology                                  m_topology;
     };
 
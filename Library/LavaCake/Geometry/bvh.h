@@ -0,0 +1,738 @@
+#pragma once
+#include "mesh.h"
+#include <LavaCake/Helpers/ABBox.h>
+#include <LavaCake/Helpers/Trace.h>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+namespace LavaCake {
+  namespace Geometry {
+
+    /**
+     \brief Result of a ray query on a TriangleBVH
+     */
+    struct rayHit {
+      bool      hit = false;
+      // distance along the ray, in multiples of the ray direction
+      float     t = INFINITY;
+      // barycentric coordinates of the hit point relative to the second and third vertices of the triangle
+      float     u = 0.0f;
+      float     v = 0.0f;
+      // index of the triangle in the mesh, the triangle vertices being indices()[3 * triangle + k]
+      uint32_t  triangle = UINT32_MAX;
+    };
+
+    /**
+     \brief Result of a closest point query on a TriangleBVH
+     */
+    struct closestPoint {
+      bool      found = false;
+      vec3f     point = vec3f({ 0.0f, 0.0f, 0.0f });
+      float     distance = INFINITY;
+      uint32_t  triangle = UINT32_MAX;
+    };
+
+    /**
+     *Class TriangleBVH :
+     *\brief Bounding volume hierarchy over the triangles of a TriangleIndexedMesh, built with a binned surface area heuristic,
+     *used for ray casting, closest point and overlap queries on the CPU
+     */
+    class TriangleBVH {
+    public:
+
+      TriangleBVH() {};
+
+      /**
+       \brief Build a bounding volume hierarchy over a mesh
+       \param mesh: a triangle mesh whose vertex format contains a POS3
+       \param threadCount: the number of threads used during the build, 0 to use all the available cores
+       \param wide: if true, the binary tree is collapsed into 4-wide nodes used by the queries
+       */
+      TriangleBVH(const TriangleIndexedMesh& mesh, uint32_t threadCount = 0, bool wide = false) {
+        build(mesh, threadCount, wide);
+      }
+
+      /**
+       \brief Build the bounding volume hierarchy, any previous content is discarded
+       \param mesh: a triangle mesh whose vertex format contains a POS3
+       \param threadCount: the number of threads used during the build, 0 to use all the available cores
+       \param wide: if true, the binary tree is collapsed into 4-wide nodes used by the queries
+       */
+      void build(const TriangleIndexedMesh& mesh, uint32_t threadCount = 0, bool wide = false) {
+        LAVACAKE_TRACE_ZONE("TriangleBVH::build");
+        m_nodes.clear();
+        m_wideNodes.clear();
+        m_triangles.clear();
+        m_triangleIds.clear();
+
+        int pos = -1;
+        int offset = 0;
+        std::vector<primitiveFormat> description = mesh.getFormat().description();
+        for (size_t s = 0; s < description.size(); s++) {
+          if (description[s] == POS3 && pos == -1) {
+            pos = offset;
+          }
+          offset += (int)toSize(description[s]);
+        }
+        if (pos == -1) {
+          return;
+        }
+
+        const std::vector<float>& vertices = mesh.vertices();
+        const std::vector<uint32_t>& indices = mesh.indices();
+        size_t stride = mesh.vertexSize();
+        uint32_t triangleCount = (uint32_t)(indices.size() / 3);
+        if (triangleCount == 0) {
+          return;
+        }
+
+        auto position = [&](uint32_t index) {
+          size_t s = index * stride + pos;
+          return vec3f({ vertices[s], vertices[s + 1], vertices[s + 2] });
+        };
+
+        std::vector<triangle> triangles(triangleCount);
+        m_boxMin.resize(triangleCount);
+        m_boxMax.resize(triangleCount);
+        m_centers.resize(triangleCount);
+        m_order.resize(triangleCount);
+        for (uint32_t t = 0; t < triangleCount; t++) {
+          vec3f a = position(indices[3 * t]);
+          vec3f b = position(indices[3 * t + 1]);
+          vec3f c = position(indices[3 * t + 2]);
+          triangles[t] = { a, b - a, c - a };
+          for (int u = 0; u < 3; u++) {
+            m_boxMin[t][u] = std::min(a[u], std::min(b[u], c[u]));
+            m_boxMax[t][u] = std::max(a[u], std::max(b[u], c[u]));
+            m_centers[t][u] = 0.5f * (m_boxMin[t][u] + m_boxMax[t][u]);
+          }
+          m_order[t] = t;
+        }
+
+        if (threadCount == 0) {
+          threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        m_nodes.reserve(2 * triangleCount);
+        m_nodes.push_back({ vec3f(), 0, vec3f(), triangleCount });
+
+        if (threadCount == 1 || triangleCount < 2 * minimalParallelTriangles) {
+          buildRecursive(m_nodes, 0);
+        }
+        else {
+          buildParallel(threadCount);
+        }
+
+        // store the triangles in the leaf order so that leaves read contiguous memory
+        m_triangles.resize(triangleCount);
+        m_triangleIds = m_order;
+        for (uint32_t t = 0; t < triangleCount; t++) {
+          m_triangles[t] = triangles[m_order[t]];
+        }
+
+        m_boxMin.clear();
+        m_boxMax.clear();
+        m_centers.clear();
+        m_order.clear();
+        m_boxMin.shrink_to_fit();
+        m_boxMax.shrink_to_fit();
+        m_centers.shrink_to_fit();
+        m_order.shrink_to_fit();
+
+        if (wide) {
+          buildWideNodes();
+        }
+      }
+
+      /**
+       \brief Find the closest intersection between a ray and the triangles
+       \param origin: the ray origin
+       \param direction: the ray direction, it does not need to be normalized
+       \param tMin: the minimal distance along the ray
+       \param tMax: the maximal distance along the ray
+       \return the closest hit, hit is false if the ray does not hit any triangle
+       */
+      rayHit intersect(const vec3f& origin, const vec3f& direction, float tMin = 0.0f, float tMax = INFINITY) const {
+        rayHit result;
+        result.t = tMax;
+        vec3f inv = vec3f({ 1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2] });
+
+        auto score = [&](float minX, float minY, float minZ, float maxX, float maxY, float maxZ) {
+          float tx1 = (minX - origin[0]) * inv[0], tx2 = (maxX - origin[0]) * inv[0];
+          float ty1 = (minY - origin[1]) * inv[1], ty2 = (maxY - origin[1]) * inv[1];
+          float tz1 = (minZ - origin[2]) * inv[2], tz2 = (maxZ - origin[2]) * inv[2];
+          float tNear = std::max(std::max(std::min(tx1, tx2), std::min(ty1, ty2)), std::max(std::min(tz1, tz2), tMin));
+          float tFar = std::min(std::min(std::max(tx1, tx2), std::max(ty1, ty2)), std::min(std::max(tz1, tz2), result.t));
+          return tNear <= tFar ? tNear : INFINITY;
+        };
+
+        auto leaf = [&](uint32_t first, uint32_t count) {
+          for (uint32_t i = first; i < first + count; i++) {
+            const triangle& tri = m_triangles[i];
+            vec3f p = cross(direction, tri.e2);
+            float det = dot(tri.e1, p);
+            if (std::abs(det) < 1e-12f) {
+              continue;
+            }
+            float invDet = 1.0f / det;
+            vec3f s = origin - tri.v0;
+            float u = dot(s, p) * invDet;
+            if (u < 0.0f || u > 1.0f) {
+              continue;
+            }
+            vec3f q = cross(s, tri.e1);
+            float v = dot(direction, q) * invDet;
+            if (v < 0.0f || u + v > 1.0f) {
+              continue;
+            }
+            float t = dot(tri.e2, q) * invDet;
+            if (t >= tMin && t < result.t) {
+              result = { true, t, u, v, m_triangleIds[i] };
+            }
+          }
+        };
+
+        traverse(result.t, score, leaf);
+        return result;
+      }
+
+      /**
+       \brief Find the point of the mesh closest to a given point
+       \param point: the query point
+       \param maxDistance: points further than this distance are ignored
+       \return the closest point, found is false if no triangle is closer than maxDistance
+       */
+      closestPoint closest(const vec3f& point, float maxDistance = INFINITY) const {
+        closestPoint result;
+        float limit = maxDistance * maxDistance;
+
+        auto score = [&](float minX, float minY, float minZ, float maxX, float maxY, float maxZ) {
+          float dx = std::max(std::max(minX - point[0], point[0] - maxX), 0.0f);
+          float dy = std::max(std::max(minY - point[1], point[1] - maxY), 0.0f);
+          float dz = std::max(std::max(minZ - point[2], point[2] - maxZ), 0.0f);
+          float d = dx * dx + dy * dy + dz * dz;
+          return minX <= maxX ? d : INFINITY;
+        };
+
+        auto leaf = [&](uint32_t first, uint32_t count) {
+          for (uint32_t i = first; i < first + count; i++) {
+            const triangle& tri = m_triangles[i];
+            vec3f c = closestPointOnTriangle(point, tri.v0, tri.v0 + tri.e1, tri.v0 + tri.e2);
+            vec3f d = c - point;
+            float distance = dot(d, d);
+            if (distance < limit) {
+              limit = distance;
+              result = { true, c, 0.0f, m_triangleIds[i] };
+            }
+          }
+        };
+
+        traverse(limit, score, leaf);
+        if (result.found) {
+          result.distance = std::sqrt(limit);
+        }
+        return result;
+      }
+
+      /**
+       \brief Find the triangles overlapping an axis aligned box
+       \param box: the query box
+       \param triangles: receive the index of the overlapping triangles, previous content is kept
+       */
+      void overlap(const Helpers::ABBox<3>& box, std::vector<uint32_t>& triangles) const {
+        vec3f bmin = box.A();
+        vec3f bmax = box.B();
+        vec3f center = (bmin + bmax) * 0.5f;
+        vec3f half = (bmax - bmin) * 0.5f;
+        float limit = 1.0f;
+
+        auto score = [&](float minX, float minY, float minZ, float maxX, float maxY, float maxZ) {
+          bool overlaps = minX <= bmax[0] && maxX >= bmin[0]
+                       && minY <= bmax[1] && maxY >= bmin[1]
+                       && minZ <= bmax[2] && maxZ >= bmin[2];
+          return overlaps ? 0.0f : INFINITY;
+        };
+
+        auto leaf = [&](uint32_t first, uint32_t count) {
+          for (uint32_t i = first; i < first + count; i++) {
+            const triangle& tri = m_triangles[i];
+            if (triangleBoxOverlap(center, half, tri.v0, tri.v0 + tri.e1, tri.v0 + tri.e2)) {
+              triangles.push_back(m_triangleIds[i]);
+            }
+          }
+        };
+
+        traverse(limit, score, leaf);
+      }
+
+      /**
+       \brief get the bounding box of the whole mesh
+       */
+      Helpers::ABBox<3> getABBox() const {
+        if (m_nodes.empty()) {
+          return Helpers::ABBox<3>();
+        }
+        return Helpers::ABBox<3>(m_nodes[0].min, m_nodes[0].max);
+      }
+
+      /**
+       \brief get the number of nodes of the binary tree
+       */
+      size_t nodeCount() const {
+        return m_nodes.size();
+      }
+
+      /**
+       \brief get the number of 4-wide nodes, 0 if they were not built
+       */
+      size_t wideNodeCount() const {
+        return m_wideNodes.size();
+      }
+
+    private:
+
+      struct triangle {
+        vec3f v0;
+        vec3f e1;
+        vec3f e2;
+      };
+
+      // 32 bytes node, two nodes fit in a cache line
+      struct node {
+        vec3f     min;
+        // first triangle for leaves, first child for inner nodes, the second child being first + 1
+        uint32_t  first;
+        vec3f     max;
+        // number of triangles, 0 for inner nodes
+        uint32_t  count;
+      };
+
+      // children bounds are stored as structure of arrays so that the four of them are tested at once
+      struct wideNode {
+        float     minX[4];
+        float     minY[4];
+        float     minZ[4];
+        float     maxX[4];
+        float     maxY[4];
+        float     maxZ[4];
+        // first triangle of leaf children, index of inner children
+        uint32_t  first[4];
+        // number of triangles of leaf children, 0 for inner or empty children
+        uint32_t  count[4];
+      };
+
+      static constexpr uint32_t binCount = 12;
+      static constexpr uint32_t maxLeafSize = 8;
+      static constexpr uint32_t minimalParallelTriangles = 4096;
+
+      static float surfaceArea(const vec3f& min, const vec3f& max) {
+        vec3f d = max - min;
+        if (d[0] < 0.0f || d[1] < 0.0f || d[2] < 0.0f) {
+          return 0.0f;
+        }
+        return 2.0f * (d[0] * d[1] + d[1] * d[2] + d[2] * d[0]);
+      }
+
+      // compute the bounds of nodes[index] and split it with the binned SAH, return true if two children were appended to nodes
+      bool splitNode(std::vector<node>& nodes, uint32_t index) {
+        uint32_t first = nodes[index].first;
+        uint32_t count = nodes[index].count;
+        float inf = std::numeric_limits<float>::infinity();
+
+        vec3f bmin = vec3f({ inf, inf, inf }), bmax = vec3f({ -inf, -inf, -inf });
+        vec3f cmin = bmin, cmax = bmax;
+        for (uint32_t i = first; i < first + count; i++) {
+          uint32_t t = m_order[i];
+          for (int u = 0; u < 3; u++) {
+            bmin[u] = std::min(bmin[u], m_boxMin[t][u]);
+            bmax[u] = std::max(bmax[u], m_boxMax[t][u]);
+            cmin[u] = std::min(cmin[u], m_centers[t][u]);
+            cmax[u] = std::max(cmax[u], m_centers[t][u]);
+          }
+        }
+        nodes[index].min = bmin;
+        nodes[index].max = bmax;
+
+        if (count <= 2) {
+          return false;
+        }
+
+        struct bin {
+          vec3f     min;
+          vec3f     max;
+          uint32_t  count;
+        };
+
+        float bestCost = inf;
+        int bestAxis = -1;
+        uint32_t bestSplit = 0;
+        for (int axis = 0; axis < 3; axis++) {
+          float extent = cmax[axis] - cmin[axis];
+          if (extent <= 0.0f) {
+            continue;
+          }
+          float scale = binCount / extent;
+          std::array<bin, binCount> bins;
+          bins.fill({ vec3f({ inf, inf, inf }), vec3f({ -inf, -inf, -inf }), 0 });
+          for (uint32_t i = first; i < first + count; i++) {
+            uint32_t t = m_order[i];
+            uint32_t b = std::min(binCount - 1, (uint32_t)((m_centers[t][axis] - cmin[axis]) * scale));
+            bins[b].count++;
+            for (int u = 0; u < 3; u++) {
+              bins[b].min[u] = std::min(bins[b].min[u], m_boxMin[t][u]);
+              bins[b].max[u] = std::max(bins[b].max[u], m_boxMax[t][u]);
+            }
+          }
+
+          // sweep from the right to get the cost of every right side, then from the left
+          std::array<float, binCount> rightCost;
+          bin right = { vec3f({ inf, inf, inf }), vec3f({ -inf, -inf, -inf }), 0 };
+          for (uint32_t b = binCount - 1; b > 0; b--) {
+            right.count += bins[b].count;
+            for (int u = 0; u < 3; u++) {
+              right.min[u] = std::min(right.min[u], bins[b].min[u]);
+              right.max[u] = std::max(right.max[u], bins[b].max[u]);
+            }
+            rightCost[b] = surfaceArea(right.min, right.max) * right.count;
+          }
+          bin left = { vec3f({ inf, inf, inf }), vec3f({ -inf, -inf, -inf }), 0 };
+          for (uint32_t b = 0; b < binCount - 1; b++) {
+            left.count += bins[b].count;
+            for (int u = 0; u < 3; u++) {
+              left.min[u] = std::min(left.min[u], bins[b].min[u]);
+              left.max[u] = std::max(left.max[u], bins[b].max[u]);
+            }
+            float cost = surfaceArea(left.min, left.max) * left.count + rightCost[b + 1];
+            if (left.count > 0 && left.count < count && cost < bestCost) {
+              bestCost = cost;
+              bestAxis = axis;
+              bestSplit = b + 1;
+            }
+          }
+        }
+
+        uint32_t* begin = m_order.data() + first;
+        uint32_t* end = begin + count;
+        uint32_t* middle = nullptr;
+
+        float area = surfaceArea(bmin, bmax);
+        // traversal and intersection costs are both taken as 1
+        float splitCost = area > 0.0f ? 1.0f + bestCost / area : inf;
+        if (bestAxis != -1 && (splitCost < (float)count || count > maxLeafSize)) {
+          float scale = binCount / (cmax[bestAxis] - cmin[bestAxis]);
+          middle = std::partition(begin, end, [&](uint32_t t) {
+            return std::min(binCount - 1, (uint32_t)((m_centers[t][bestAxis] - cmin[bestAxis]) * scale)) < bestSplit;
+          });
+        }
+        else if (count > maxLeafSize) {
+          // every center is at the same position, split the range in two halves
+          middle = begin + count / 2;
+        }
+        else {
+          return false;
+        }
+
+        uint32_t leftCount = (uint32_t)(middle - begin);
+        uint32_t child = (uint32_t)nodes.size();
+        nodes[index].first = child;
+        nodes[index].count = 0;
+        nodes.push_back({ vec3f(), first, vec3f(), leftCount });
+        nodes.push_back({ vec3f(), first + leftCount, vec3f(), count - leftCount });
+        return true;
+      }
+
+      void buildRecursive(std::vector<node>& nodes, uint32_t index) {
+        if (splitNode(nodes, index)) {
+          uint32_t child = nodes[index].first;
+          buildRecursive(nodes, child);
+          buildRecursive(nodes, child + 1);
+        }
+      }
+
+      // split the top of the tree until it has enough subtrees, these are recorded in tasks
+      void buildTop(uint32_t index, uint32_t depth, uint32_t maxDepth, std::vector<uint32_t>& tasks) {
+        if (depth >= maxDepth || m_nodes[index].count < minimalParallelTriangles) {
+          tasks.push_back(index);
+          return;
+        }
+        if (splitNode(m_nodes, index)) {
+          uint32_t child = m_nodes[index].first;
+          buildTop(child, depth + 1, maxDepth, tasks);
+          buildTop(child + 1, depth + 1, maxDepth, tasks);
+        }
+      }
+
+      void buildParallel(uint32_t threadCount) {
+        LAVACAKE_TRACE_ZONE("TriangleBVH::buildParallel");
+        // about four subtrees per thread to balance uneven splits
+        uint32_t maxDepth = 2;
+        while ((1u << maxDepth) < 4 * threadCount) {
+          maxDepth++;
+        }
+
+        std::vector<uint32_t> tasks;
+        buildTop(0, 0, maxDepth, tasks);
+
+        // each subtree is built independently, they touch disjoint ranges of m_order
+        std::vector<std::vector<node>> subtrees(tasks.size());
+        std::atomic<uint32_t> next = 0;
+        auto worker = [&]() {
+          for (uint32_t t = next++; t < tasks.size(); t = next++) {
+            subtrees[t].push_back(m_nodes[tasks[t]]);
+            buildRecursive(subtrees[t], 0);
+          }
+        };
+        std::vector<std::thread> threads;
+        for (uint32_t t = 1; t < std::min(threadCount, (uint32_t)tasks.size()); t++) {
+          threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+          thread.join();
+        }
+
+        // the root of each subtree replaces its task node, the other nodes are appended with shifted child indices
+        for (uint32_t t = 0; t < tasks.size(); t++) {
+          std::vector<node>& subtree = subtrees[t];
+          uint32_t shift = (uint32_t)m_nodes.size() - 1;
+          for (size_t i = 0; i < subtree.size(); i++) {
+            if (subtree[i].count == 0) {
+              subtree[i].first += shift;
+            }
+          }
+          m_nodes[tasks[t]] = subtree[0];
+          m_nodes.insert(m_nodes.end(), subtree.begin() + 1, subtree.end());
+        }
+      }
+
+      void buildWideNodes() {
+        LAVACAKE_TRACE_ZONE("TriangleBVH::buildWideNodes");
+        m_wideNodes.clear();
+        m_wideNodes.reserve(m_nodes.size() / 2 + 1);
+        buildWideNode(0);
+      }
+
+      uint32_t buildWideNode(uint32_t index) {
+        // open the inner child with the largest surface until there are four children
+        std::vector<uint32_t> children;
+        if (m_nodes[index].count > 0) {
+          children.push_back(index);
+        }
+        else {
+          children.push_back(m_nodes[index].first);
+          children.push_back(m_nodes[index].first + 1);
+        }
+        while (children.size() < 4) {
+          int best = -1;
+          float bestArea = -1.0f;
+          for (int c = 0; c < (int)children.size(); c++) {
+            const node& n = m_nodes[children[c]];
+            float area = surfaceArea(n.min, n.max);
+            if (n.count == 0 && area > bestArea) {
+              best = c;
+              bestArea = area;
+            }
+          }
+          if (best == -1) {
+            break;
+          }
+          uint32_t opened = children[best];
+          children[best] = m_nodes[opened].first;
+          children.push_back(m_nodes[opened].first + 1);
+        }
+
+        uint32_t wideIndex = (uint32_t)m_wideNodes.size();
+        m_wideNodes.push_back({});
+        wideNode w;
+        for (int c = 0; c < 4; c++) {
+          float inf = std::numeric_limits<float>::infinity();
+          w.minX[c] = w.minY[c] = w.minZ[c] = inf;
+          w.maxX[c] = w.maxY[c] = w.maxZ[c] = -inf;
+          w.first[c] = UINT32_MAX;
+          w.count[c] = 0;
+          if (c < (int)children.size()) {
+            const node& n = m_nodes[children[c]];
+            w.minX[c] = n.min[0];
+            w.minY[c] = n.min[1];
+            w.minZ[c] = n.min[2];
+            w.maxX[c] = n.max[0];
+            w.maxY[c] = n.max[1];
+            w.maxZ[c] = n.max[2];
+            if (n.count > 0) {
+              w.first[c] = n.first;
+              w.count[c] = n.count;
+            }
+            else {
+              w.first[c] = buildWideNode(children[c]);
+            }
+          }
+        }
+        m_wideNodes[wideIndex] = w;
+        return wideIndex;
+      }
+
+      /*
+      Visit the leaves in order of increasing score, score giving the distance of a box to the query
+      (INFINITY if it can be skipped) and limit being the largest score worth visiting, updated by leaf.
+      */
+      template<typename Score, typename Leaf>
+      void traverse(float& limit, const Score& score, const Leaf& leaf) const {
+        if (m_nodes.empty()) {
+          return;
+        }
+
+        struct entry {
+          uint32_t  index;
+          uint32_t  count;
+          float     key;
+        };
+        std::vector<entry> stack;
+        stack.reserve(64);
+
+        if (!m_wideNodes.empty()) {
+          stack.push_back({ 0, 0, -INFINITY });
+          while (!stack.empty()) {
+            entry e = stack.back();
+            stack.pop_back();
+            if (e.key >= limit) {
+              continue;
+            }
+            if (e.count > 0) {
+              leaf(e.index, e.count);
+              continue;
+            }
+
+            const wideNode& w = m_wideNodes[e.index];
+            float keys[4];
+            for (int c = 0; c < 4; c++) {
+              keys[c] = score(w.minX[c], w.minY[c], w.minZ[c], w.maxX[c], w.maxY[c], w.maxZ[c]);
+            }
+
+            size_t top = stack.size();
+            for (int c = 0; c < 4; c++) {
+              if (keys[c] < limit && w.first[c] != UINT32_MAX) {
+                stack.push_back({ w.first[c], w.count[c], keys[c] });
+              }
+            }
+            // the nearest child is popped first
+            std::sort(stack.begin() + top, stack.end(), [](const entry& a, const entry& b) {
+              return a.key > b.key;
+            });
+          }
+          return;
+        }
+
+        const node& root = m_nodes[0];
+        stack.push_back({ 0, 0, score(root.min[0], root.min[1], root.min[2], root.max[0], root.max[1], root.max[2]) });
+        while (!stack.empty()) {
+          entry e = stack.back();
+          stack.pop_back();
+          if (e.key >= limit) {
+            continue;
+          }
+          const node& n = m_nodes[e.index];
+          if (n.count > 0) {
+            leaf(n.first, n.count);
+            continue;
+          }
+
+          const node& a = m_nodes[n.first];
+          const node& b = m_nodes[n.first + 1];
+          float keyA = score(a.min[0], a.min[1], a.min[2], a.max[0], a.max[1], a.max[2]);
+          float keyB = score(b.min[0], b.min[1], b.min[2], b.max[0], b.max[1], b.max[2]);
+          entry near = { n.first, 0, keyA };
+          entry far = { n.first + 1, 0, keyB };
+          if (keyB < keyA) {
+            std::swap(near, far);
+          }
+          if (far.key < limit) {
+            stack.push_back(far);
+          }
+          if (near.key < limit) {
+            stack.push_back(near);
+          }
+        }
+      }
+
+      // Ericson, Real-Time Collision Detection, 5.1.5
+      static vec3f closestPointOnTriangle(const vec3f& p, const vec3f& a, const vec3f& b, const vec3f& c) {
+        vec3f ab = b - a;
+        vec3f ac = c - a;
+        vec3f ap = p - a;
+        float d1 = dot(ab, ap);
+        float d2 = dot(ac, ap);
+        if (d1 <= 0.0f && d2 <= 0.0f) return a;
+
+        vec3f bp = p - b;
+        float d3 = dot(ab, bp);
+        float d4 = dot(ac, bp);
+        if (d3 >= 0.0f && d4 <= d3) return b;
+
+        float vc = d1 * d4 - d3 * d2;
+        if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+          return a + ab * (d1 / (d1 - d3));
+        }
+
+        vec3f cp = p - c;
+        float d5 = dot(ab, cp);
+        float d6 = dot(ac, cp);
+        if (d6 >= 0.0f && d5 <= d6) return c;
+
+        float vb = d5 * d2 - d1 * d6;
+        if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+          return a + ac * (d2 / (d2 - d6));
+        }
+
+        float va = d3 * d6 - d5 * d4;
+        if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+          return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        }
+
+        float denom = 1.0f / (va + vb + vc);
+        return a + ab * (vb * denom) + ac * (vc * denom);
+      }
+
+      // Akenine-Moller separating axis test between a triangle and a box given by its center and half size
+      static bool triangleBoxOverlap(const vec3f& center, const vec3f& half, const vec3f& a, const vec3f& b, const vec3f& c) {
+        std::array<vec3f, 3> v = { a - center, b - center, c - center };
+        std::array<vec3f, 3> e = { v[1] - v[0], v[2] - v[1], v[0] - v[2] };
+
+        auto separated = [&](const vec3f& axis) {
+          float p0 = dot(axis, v[0]);
+          float p1 = dot(axis, v[1]);
+          float p2 = dot(axis, v[2]);
+          float r = half[0] * std::abs(axis[0]) + half[1] * std::abs(axis[1]) + half[2] * std::abs(axis[2]);
+          return std::max(p0, std::max(p1, p2)) < -r || std::min(p0, std::min(p1, p2)) > r;
+        };
+
+        for (int i = 0; i < 3; i++) {
+          vec3f unit = vec3f({ 0.0f, 0.0f, 0.0f });
+          unit[i] = 1.0f;
+          for (int j = 0; j < 3; j++) {
+            if (separated(cross(unit, e[j]))) {
+              return false;
+            }
+          }
+          // box face normals
+          if (separated(unit)) {
+            return false;
+          }
+        }
+        return !separated(cross(e[0], e[1]));
+      }
+
+      std::vector<node>                                 m_nodes;
+      std::vector<wideNode>                             m_wideNodes;
+      std::vector<triangle>                             m_triangles;
+      std::vector<uint32_t>                             m_triangleIds;
+
+      // build data, released once the hierarchy is built
+      std::vector<vec3f>                                m_boxMin;
+      std::vector<vec3f>                                m_boxMax;
+      std::vector<vec3f>                                m_centers;
+      std::vector<uint32_t>                             m_order;
+    };
+
+  }
+}
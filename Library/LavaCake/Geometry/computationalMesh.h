@@ -1,5 +1,6 @@
 #pragma once
 #include "mesh.h"
+#include <LavaCake/Helpers/Trace.h>
 #include <algorithm>
 
 namespace LavaCake {
@@ -201,6 +202,7 @@ namespace LavaCake {
       };
 
       void triangulation() {
+        LAVACAKE_TRACE_ZONE("PolygonalMesh::triangulation");
         for (size_t s = 0; s < faces.size(); s++) {
           if (faces[s]->vertices.size() > 3) {
 
@@ -209,6 +211,7 @@ namespace LavaCake {
       };
 
       std::vector<float> GaussianCurvature(float radius) {
+        LAVACAKE_TRACE_ZONE("PolygonalMesh::GaussianCurvature");
         if (!onlyTriangle) {
           return {};
         }
@@ -0,0 +1,435 @@
+#pragma once
+#include "mesh.h"
+#include <LavaCake/Helpers/Field.h>
+#include <LavaCake/Helpers/Trace.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace LavaCake {
+  namespace Geometry {
+
+    /**
+     *Class MarchingCubes :
+     *\brief Extract isosurfaces from 3D grid fields with the marching cubes algorithm.
+     *The grid is split in slabs of cells processed in parallel, a vertex is created once per grid edge crossed by the surface
+     *and shared by all the cells around this edge, including across slabs, so the resulting mesh is indexed without duplicated vertices.
+     */
+    class MarchingCubes {
+    public:
+
+      /**
+       \brief Create an extractor
+       \param threadCount: the number of threads used during the extraction, 0 to use all the available cores
+       */
+      MarchingCubes(uint32_t threadCount = 0) {
+        m_threadCount = threadCount == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threadCount;
+      }
+
+      /**
+       \brief Extract the surface where the field is equal to isovalue
+       \param field: the field to extract the surface from, at least 2 grid points are needed along each axis
+       \param isovalue: the value of the surface, grid points below this value are considered inside
+       \return an indexed triangle mesh in the PN3 format, normals are given by the field gradient and point toward increasing values,
+       triangles are counter clockwise when seen from the direction of the normals
+       */
+      TriangleIndexedMesh extract(const Helpers::Field3DGrid<float>& field, float isovalue) const {
+        LAVACAKE_TRACE_ZONE("MarchingCubes::extract");
+        TriangleIndexedMesh mesh(PN3);
+        vec3u dim = field.getDimension();
+        if (dim[0] < 2 || dim[1] < 2 || dim[2] < 2) {
+          return mesh;
+        }
+
+        grid g(field, isovalue);
+
+        // a few slabs per thread to balance the surface density
+        uint32_t slabCount = std::min(dim[2] - 1, m_threadCount == 1 ? 1u : 4 * m_threadCount);
+        std::vector<slab> slabs(slabCount);
+        parallelFor(slabCount, [&](uint32_t s) {
+          uint32_t z0 = uint32_t(uint64_t(dim[2] - 1) * s / slabCount);
+          uint32_t z1 = uint32_t(uint64_t(dim[2] - 1) * (s + 1) / slabCount);
+          processSlab(g, z0, z1, slabs[s]);
+        });
+
+        std::vector<uint32_t> vertexOffsets(slabCount + 1, 0);
+        std::vector<size_t> indexOffsets(slabCount + 1, 0);
+        for (uint32_t s = 0; s < slabCount; s++) {
+          vertexOffsets[s + 1] = vertexOffsets[s] + uint32_t(slabs[s].vertices.size() / 6);
+          indexOffsets[s + 1] = indexOffsets[s] + slabs[s].indices.size();
+        }
+
+        std::vector<float>& vertices = mesh.vertices();
+        std::vector<uint32_t>& indices = mesh.indices();
+        vertices.resize(size_t(vertexOffsets[slabCount]) * 6);
+        indices.resize(indexOffsets[slabCount]);
+
+        // vertices on the top plane of a slab are referenced through the bottom plane of the next one
+        parallelFor(slabCount, [&](uint32_t s) {
+          const slab& current = slabs[s];
+          if (!current.vertices.empty()) {
+            std::memcpy(&vertices[size_t(vertexOffsets[s]) * 6], current.vertices.data(), current.vertices.size() * sizeof(float));
+          }
+          uint32_t* out = indices.data() + indexOffsets[s];
+          for (uint32_t index : current.indices) {
+            if (index & external) {
+              *out++ = slabs[s + 1].bottom[index & ~external] + vertexOffsets[s + 1];
+            }
+            else {
+              *out++ = index + vertexOffsets[s];
+            }
+          }
+        });
+
+        return mesh;
+      }
+
+    private:
+
+      static constexpr uint32_t external = 0x80000000u;
+
+      struct slab {
+        std::vector<float>      vertices;
+        std::vector<uint32_t>   indices;
+        // vertex indices of the x and y edges of the first plane of the slab
+        std::vector<uint32_t>   bottom;
+      };
+
+      struct grid {
+        grid(const Helpers::Field3DGrid<float>& f, float iso) : field(f) {
+          isovalue = iso;
+          dim = f.getDimension();
+          planeSize = size_t(dim[0]) * dim[1];
+          Helpers::ABBox<3> box = f.getABBox();
+          origin = box.A();
+          vec3f extent = box.B() - box.A();
+          for (int u = 0; u < 3; u++) {
+            spacing[u] = extent[u] / float(dim[u] - 1);
+          }
+        }
+
+        float value(int32_t x, int32_t y, int32_t z) const {
+          x = std::clamp(x, 0, int32_t(dim[0]) - 1);
+          y = std::clamp(y, 0, int32_t(dim[1]) - 1);
+          z = std::clamp(z, 0, int32_t(dim[2]) - 1);
+          return field.at(uint32_t(x), uint32_t(y), uint32_t(z));
+        }
+
+        vec3f gradient(int32_t x, int32_t y, int32_t z) const {
+          return vec3f({
+            (value(x + 1, y, z) - value(x - 1, y, z)) / ((x > 0 && x + 1 < int32_t(dim[0]) ? 2.0f : 1.0f) * spacing[0]),
+            (value(x, y + 1, z) - value(x, y - 1, z)) / ((y > 0 && y + 1 < int32_t(dim[1]) ? 2.0f : 1.0f) * spacing[1]),
+            (value(x, y, z + 1) - value(x, y, z - 1)) / ((z > 0 && z + 1 < int32_t(dim[2]) ? 2.0f : 1.0f) * spacing[2])
+          });
+        }
+
+        void loadPlane(uint32_t z, std::vector<float>& plane) const {
+          if (field.getLayout() == Helpers::LINEAR) {
+            std::memcpy(plane.data(), field.getRawField().data() + z * planeSize, planeSize * sizeof(float));
+            return;
+          }
+          for (uint32_t y = 0; y < dim[1]; y++) {
+            for (uint32_t x = 0; x < dim[0]; x++) {
+              plane[x + y * dim[0]] = field.at(x, y, z);
+            }
+          }
+        }
+
+        const Helpers::Field3DGrid<float>&  field;
+        float                               isovalue;
+        vec3u                               dim;
+        size_t                              planeSize;
+        vec3f                               origin;
+        vec3f                               spacing;
+      };
+
+      // triangles of each of the 256 cases, as lists of cube edges
+      struct caseTable {
+        std::vector<uint8_t>    edges;
+        uint32_t                offsets[257];
+
+        // corner c is at (c & 1, (c >> 1) & 1, c >> 2), edge 4 * a + k is parallel to the axis a
+        static uint32_t edgeCorner(uint32_t e) {
+          uint32_t a = e >> 2;
+          uint32_t o0 = a == 0 ? 1 : 0;
+          uint32_t o1 = a == 2 ? 1 : 2;
+          return ((e & 1) << o0) | (((e >> 1) & 1) << o1);
+        }
+
+        static uint32_t edgeBetween(uint32_t c0, uint32_t c1) {
+          uint32_t a = (c0 ^ c1) == 1 ? 0 : ((c0 ^ c1) == 2 ? 1 : 2);
+          uint32_t c = c0 & c1;
+          uint32_t o0 = a == 0 ? 1 : 0;
+          uint32_t o1 = a == 2 ? 1 : 2;
+          return 4 * a + ((c >> o0) & 1) + 2 * ((c >> o1) & 1);
+        }
+
+        // faces 2 * a + s of the cube containing an edge, s being the side along the axis a
+        static uint32_t edgeFaces(uint32_t e) {
+          uint32_t a = e >> 2;
+          uint32_t o0 = a == 0 ? 1 : 0;
+          uint32_t o1 = a == 2 ? 1 : 2;
+          return (1u << (2 * o0 + (e & 1))) | (1u << (2 * o1 + ((e >> 1) & 1)));
+        }
+
+        static vec3f cornerPosition(uint32_t c) {
+          return vec3f({ float(c & 1), float((c >> 1) & 1), float(c >> 2) });
+        }
+
+        static vec3f edgeMiddle(uint32_t e) {
+          vec3f p = cornerPosition(edgeCorner(e));
+          p[e >> 2] = 0.5f;
+          return p;
+        }
+
+        // the surface is bounded by segments on the cube faces, oriented so that the inside corners are on their left
+        // when seen from outside, they are chained into loops and each loop is triangulated as a fan
+        caseTable() {
+          offsets[0] = 0;
+          for (uint32_t mask = 0; mask < 256; mask++) {
+            int32_t next[12];
+            for (int32_t& n : next) {
+              n = -1;
+            }
+
+            for (uint32_t f = 0; f < 6; f++) {
+              uint32_t axis = f >> 1;
+              uint32_t side = f & 1;
+              uint32_t u = axis == 0 ? 1 : 0;
+              uint32_t v = axis == 2 ? 1 : 2;
+              uint32_t q[4] = {
+                (side << axis),
+                (side << axis) | (1u << u),
+                (side << axis) | (1u << u) | (1u << v),
+                (side << axis) | (1u << v)
+              };
+              vec3f normal = vec3f({ 0.0f, 0.0f, 0.0f });
+              normal[axis] = side ? 1.0f : -1.0f;
+
+              bool in[4];
+              uint32_t insideCount = 0;
+              vec3f insideCenter = vec3f({ 0.0f, 0.0f, 0.0f });
+              for (int i = 0; i < 4; i++) {
+                in[i] = (mask >> q[i]) & 1;
+                if (in[i]) {
+                  insideCount++;
+                  insideCenter = insideCenter + cornerPosition(q[i]);
+                }
+              }
+              if (insideCount == 0 || insideCount == 4) {
+                continue;
+              }
+
+              auto addSegment = [&](uint32_t e0, uint32_t e1, const vec3f& inside) {
+                vec3f P = edgeMiddle(e0);
+                vec3f Q = edgeMiddle(e1);
+                vec3f m = (P + Q) * 0.5f - inside;
+                if (dot(Q - P, cross(m, normal)) < 0.0f) {
+                  std::swap(e0, e1);
+                }
+                next[e0] = int32_t(e1);
+              };
+
+              if (insideCount == 2 && in[0] == in[2]) {
+                // ambiguous face, the two inside corners are kept separated
+                for (int i = 0; i < 4; i++) {
+                  if (in[i]) {
+                    addSegment(edgeBetween(q[(i + 3) & 3], q[i]), edgeBetween(q[i], q[(i + 1) & 3]), cornerPosition(q[i]));
+                  }
+                }
+              }
+              else {
+                uint32_t crossed[2];
+                uint32_t n = 0;
+                for (int i = 0; i < 4; i++) {
+                  if (in[i] != in[(i + 1) & 3]) {
+                    crossed[n++] = edgeBetween(q[i], q[(i + 1) & 3]);
+                  }
+                }
+                addSegment(crossed[0], crossed[1], insideCenter * (1.0f / float(insideCount)));
+              }
+            }
+
+            bool visited[12] = {};
+            for (uint32_t e = 0; e < 12; e++) {
+              if (next[e] < 0 || visited[e]) {
+                continue;
+              }
+              std::vector<uint8_t> loop;
+              for (int32_t c = int32_t(e); !visited[c]; c = next[c]) {
+                visited[c] = true;
+                loop.push_back(uint8_t(c));
+              }
+              // a diagonal between two vertices of the same face could also be created by the neighbour cube,
+              // the apex of the fan is chosen so that no diagonal lies on a face
+              size_t L = loop.size();
+              size_t apex = 0;
+              for (size_t a = 0; a < L; a++) {
+                bool onFace = false;
+                for (size_t i = 2; i + 1 < L; i++) {
+                  onFace |= (edgeFaces(loop[a]) & edgeFaces(loop[(a + i) % L])) != 0;
+                }
+                if (!onFace) {
+                  apex = a;
+                  break;
+                }
+              }
+              for (size_t i = 1; i + 1 < L; i++) {
+                edges.push_back(loop[apex]);
+                edges.push_back(loop[(apex + i) % L]);
+                edges.push_back(loop[(apex + i + 1) % L]);
+              }
+            }
+            offsets[mask + 1] = uint32_t(edges.size());
+          }
+        }
+      };
+
+      static const caseTable& table() {
+        static caseTable t;
+        return t;
+      }
+
+      static uint32_t createVertex(const grid& g, uint32_t x, uint32_t y, uint32_t z, uint32_t axis, float v0, float v1, slab& s) {
+        float t = (g.isovalue - v0) / (v1 - v0);
+        vec3f p = vec3f({ float(x), float(y), float(z) });
+        p[axis] += t;
+
+        vec3f n0 = g.gradient(x, y, z);
+        vec3f n1 = g.gradient(x + (axis == 0), y + (axis == 1), z + (axis == 2));
+        vec3f n = n0 * (1.0f - t) + n1 * t;
+        float length = std::sqrt(dot(n, n));
+        if (length > 0.0f) {
+          n = n * (1.0f / length);
+        }
+
+        uint32_t index = uint32_t(s.vertices.size() / 6);
+        for (int u = 0; u < 3; u++) {
+          s.vertices.push_back(g.origin[u] + p[u] * g.spacing[u]);
+        }
+        for (int u = 0; u < 3; u++) {
+          s.vertices.push_back(n[u]);
+        }
+        return index;
+      }
+
+      // vertices of the crossed edges along x and y in the plane z
+      static void planeEdges(const grid& g, uint32_t z, const std::vector<float>& plane, std::vector<uint32_t>& planeIndices, slab& s) {
+        uint32_t W = g.dim[0];
+        uint32_t H = g.dim[1];
+        for (uint32_t y = 0; y < H; y++) {
+          for (uint32_t x = 0; x < W; x++) {
+            size_t i = x + size_t(y) * W;
+            bool in = plane[i] < g.isovalue;
+            if (x + 1 < W && in != (plane[i + 1] < g.isovalue)) {
+              planeIndices[i] = createVertex(g, x, y, z, 0, plane[i], plane[i + 1], s);
+            }
+            if (y + 1 < H && in != (plane[i + W] < g.isovalue)) {
+              planeIndices[g.planeSize + i] = createVertex(g, x, y, z, 1, plane[i], plane[i + W], s);
+            }
+          }
+        }
+      }
+
+      static void processSlab(const grid& g, uint32_t z0, uint32_t z1, slab& s) {
+        const caseTable& cases = table();
+        uint32_t W = g.dim[0];
+        uint32_t H = g.dim[1];
+        bool last = z1 == g.dim[2] - 1;
+
+        std::vector<float> current(g.planeSize), above(g.planeSize);
+        std::vector<uint32_t> currentEdges(2 * g.planeSize), aboveEdges(2 * g.planeSize), zEdges(g.planeSize);
+
+        g.loadPlane(z0, current);
+        planeEdges(g, z0, current, currentEdges, s);
+        s.bottom = currentEdges;
+
+        for (uint32_t z = z0; z < z1; z++) {
+          g.loadPlane(z + 1, above);
+
+          for (size_t i = 0; i < g.planeSize; i++) {
+            if ((current[i] < g.isovalue) != (above[i] < g.isovalue)) {
+              zEdges[i] = createVertex(g, uint32_t(i % W), uint32_t(i / W), z, 2, current[i], above[i], s);
+            }
+          }
+
+          if (z + 1 < z1 || last) {
+            planeEdges(g, z + 1, above, aboveEdges, s);
+          }
+          else {
+            // the next slab owns this plane
+            for (uint32_t i = 0; i < 2 * g.planeSize; i++) {
+              aboveEdges[i] = external | i;
+            }
+          }
+
+          for (uint32_t y = 0; y + 1 < H; y++) {
+            for (uint32_t x = 0; x + 1 < W; x++) {
+              size_t i = x + size_t(y) * W;
+              uint32_t mask =
+                uint32_t(current[i] < g.isovalue) |
+                (uint32_t(current[i + 1] < g.isovalue) << 1) |
+                (uint32_t(current[i + W] < g.isovalue) << 2) |
+                (uint32_t(current[i + W + 1] < g.isovalue) << 3) |
+                (uint32_t(above[i] < g.isovalue) << 4) |
+                (uint32_t(above[i + 1] < g.isovalue) << 5) |
+                (uint32_t(above[i + W] < g.isovalue) << 6) |
+                (uint32_t(above[i + W + 1] < g.isovalue) << 7);
+              if (mask == 0 || mask == 255) {
+                continue;
+              }
+
+              for (uint32_t k = cases.offsets[mask]; k < cases.offsets[mask + 1]; k++) {
+                uint32_t e = cases.edges[k];
+                uint32_t c = caseTable::edgeCorner(e);
+                size_t j = i + (c & 1) + ((c >> 1) & 1) * W;
+                uint32_t axis = e >> 2;
+                if (axis == 2) {
+                  s.indices.push_back(zEdges[j]);
+                }
+                else {
+                  s.indices.push_back(((c >> 2) ? aboveEdges : currentEdges)[axis * g.planeSize + j]);
+                }
+              }
+            }
+          }
+
+          std::swap(current, above);
+          std::swap(currentEdges, aboveEdges);
+        }
+      }
+
+      template<typename Function>
+      void parallelFor(uint32_t count, Function f) const {
+        std::atomic<uint32_t> next = 0;
+        auto worker = [&]() {
+          for (uint32_t i = next++; i < count; i = next++) {
+            f(i);
+          }
+        };
+        std::vector<std::thread> threads;
+        for (uint32_t t = 1; t < std::min(m_threadCount, count); t++) {
+          threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+          thread.join();
+        }
+      }
+
+      uint32_t m_threadCount;
+    };
+
+    /**
+     \brief Extract the surface where a field is equal to isovalue, see MarchingCubes::extract
+     \param field: the field to extract the surface from
+     \param isovalue: the value of the surface
+     \param threadCount: the number of threads used during the extraction, 0 to use all the available cores
+     */
+    static TriangleIndexedMesh extractIsosurface(const Helpers::Field3DGrid<float>& field, float isovalue, uint32_t threadCount = 0) {
+      return MarchingCubes(threadCount).extract(field, isovalue);
+    }
+
+  }
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include "mesh.h"
 #include <LavaCake/Math/basics.h>
+#include <LavaCake/Math/transform.h>
+#include <LavaCake/Helpers/Trace.h>
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "tiny_obj_loader.h"
@@ -35,6 +37,7 @@ namespace LavaCake {
 		}
 
 		void GenerateTangentSpaceVectors(std::vector<float>& mesh) {
+			LAVACAKE_TRACE_ZONE("GenerateTangentSpaceVectors");
 			size_t const normal_offset = 3;
 			size_t const texcoord_offset = 6;
 			size_t const tangent_offset = 8;
@@ -116,14 +119,7 @@ namespace LavaCake {
 
 
 
-			// Load model data and unify (normalize) its size and position
-			float min_x = attribs.vertices[0];
-			float max_x = attribs.vertices[0];
-			float min_y = attribs.vertices[1];
-			float max_y = attribs.vertices[1];
-			float min_z = attribs.vertices[2];
-			float max_z = attribs.vertices[2];
-
+			// Load model data, it is unified (normalized) in size and position once loaded
 			std::vector<float> mesh;
 			uint32_t offset = 0;
 			for (auto& shape : shapes) {
@@ -153,27 +149,6 @@ namespace LavaCake {
 							mesh.emplace_back(0.0f);
 						}
 					}
-
-					if (unify) {
-						if (attribs.vertices[3 * index.vertex_index + 0] < min_x) {
-							min_x = attribs.vertices[3 * index.vertex_index + 0];
-						}
-						if (attribs.vertices[3 * index.vertex_index + 0] > max_x) {
-							max_x = attribs.vertices[3 * index.vertex_index + 0];
-						}
-						if (attribs.vertices[3 * index.vertex_index + 1] < min_y) {
-							min_y = attribs.vertices[3 * index.vertex_index + 1];
-						}
-						if (attribs.vertices[3 * index.vertex_index + 1] > max_y) {
-							max_y = attribs.vertices[3 * index.vertex_index + 1];
-						}
-						if (attribs.vertices[3 * index.vertex_index + 2] < min_z) {
-							min_z = attribs.vertices[3 * index.vertex_index + 2];
-						}
-						if (attribs.vertices[3 * index.vertex_index + 2] > max_z) {
-							max_z = attribs.vertices[3 * index.vertex_index + 2];
-						}
-					}
 				}
 			}
 
@@ -188,6 +163,14 @@ namespace LavaCake {
 
 			if (unify) {
         using std::abs;
+				bounds3f bounds = ComputeBounds(mesh, stride);
+				float min_x = bounds.first[0];
+				float max_x = bounds.second[0];
+				float min_y = bounds.first[1];
+				float max_y = bounds.second[1];
+				float min_z = bounds.first[2];
+				float max_z = bounds.second[2];
+
 				float offset_x = 0.5f * (min_x + max_x);
 				float offset_y = 0.5f * (min_y + max_y);
 				float offset_z = 0.5f * (min_z + max_z);
@@ -197,11 +180,8 @@ namespace LavaCake {
 				float scale = scale_x > scale_y ? scale_x : scale_y;
 				scale = scale_z > scale ? 1.0f / scale_z : 1.0f / scale;
 
-				for (size_t i = 0; i < mesh.size() - 2; i += stride) {
-					mesh[i + 0] = scale * (mesh[i + 0] - offset_x);
-					mesh[i + 1] = scale * (mesh[i + 1] - offset_y);
-					mesh[i + 2] = scale * (mesh[i + 2] - offset_z);
-				}
+				mat4 unifyTransform = PrepareScalingMatrix(scale, scale, scale) * PrepareTranslationMatrix(-offset_x, -offset_y, -offset_z);
+				TransformPoints(mesh, stride, unifyTransform, 0);
 			}
 			return { mesh,description };
     }
@@ -238,14 +218,6 @@ namespace LavaCake {
 			}
 
 			uint32_t stride = 3 + ((attribs.normals.size() != 0 && load_normal) ? 3 : 0);
-			// Load model data and unify (normalize) its size and position
-			float min_x = attribs.vertices[0];
-			float max_x = attribs.vertices[0];
-			float min_y = attribs.vertices[1];
-			float max_y = attribs.vertices[1];
-			float min_z = attribs.vertices[2];
-			float max_z = attribs.vertices[2];
-
 			//loading the position;
 
 			std::vector<float> mesh;
@@ -282,27 +254,6 @@ namespace LavaCake {
 					}
 
 					
-
-					if (unify) {
-						if (attribs.vertices[3 * index.vertex_index + 0] < min_x) {
-							min_x = attribs.vertices[3 * index.vertex_index + 0];
-						}
-						if (attribs.vertices[3 * index.vertex_index + 0] > max_x) {
-							max_x = attribs.vertices[3 * index.vertex_index + 0];
-						}
-						if (attribs.vertices[3 * index.vertex_index + 1] < min_y) {
-							min_y = attribs.vertices[3 * index.vertex_index + 1];
-						}
-						if (attribs.vertices[3 * index.vertex_index + 1] > max_y) {
-							max_y = attribs.vertices[3 * index.vertex_index + 1];
-						}
-						if (attribs.vertices[3 * index.vertex_index + 2] < min_z) {
-							min_z = attribs.vertices[3 * index.vertex_index + 2];
-						}
-						if (attribs.vertices[3 * index.vertex_index + 2] > max_z) {
-							max_z = attribs.vertices[3 * index.vertex_index + 2];
-						}
-					}
 				}
 			}
 
@@ -310,6 +261,14 @@ namespace LavaCake {
 
 			if (unify) {
         using std::abs;
+				bounds3f bounds = ComputeBounds(mesh, stride);
+				float min_x = bounds.first[0];
+				float max_x = bounds.second[0];
+				float min_y = bounds.first[1];
+				float max_y = bounds.second[1];
+				float min_z = bounds.first[2];
+				float max_z = bounds.second[2];
+
 				float offset_x = 0.5f * (min_x + max_x);
 				float offset_y = 0.5f * (min_y + max_y);
 				float offset_z = 0.5f * (min_z + max_z);
@@ -319,11 +278,8 @@ namespace LavaCake {
 				float scale = scale_x > scale_y ? scale_x : scale_y;
 				scale = scale_z > scale ? 1.0f / scale_z : 1.0f / scale;
 
-				for (size_t i = 0; i < mesh.size(); i += stride) {
-					mesh[i + 0] = scale * (mesh[i + 0] - offset_x);
-					mesh[i + 1] = scale * (mesh[i + 1] - offset_y);
-					mesh[i + 2] = scale * (mesh[i + 2] - offset_z);
-				}
+				mat4 unifyTransform = PrepareScalingMatrix(scale, scale, scale) * PrepareTranslationMatrix(-offset_x, -offset_y, -offset_z);
+				TransformPoints(mesh, stride, unifyTransform, 0);
 			}
 
 			if (load_normal) {
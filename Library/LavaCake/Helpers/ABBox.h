@@ -1,7 +1,7 @@
 #pragma once
 #include <array>
 #include "AllHeaders.h"
-#include "Math/basics.h"
+#include <LavaCake/Math/basics.h>
 
 namespace LavaCake {
   namespace Helpers {
@@ -52,7 +52,7 @@ namespace LavaCake {
        \brief get the min point of the bounding box
        \return a std array representing the min point of the bouding box
       */
-      std::array<T, N> A(){
+      std::array<T, N> A() const{
         return m_min;
       }
       
@@ -60,7 +60,7 @@ namespace LavaCake {
        \brief get the max point of the bounding box
        \return a std array representing the max point of the bouding box
        */
-      std::array<T, N> B(){
+      std::array<T, N> B() const{
         return m_max;
       }
       
@@ -71,6 +71,7 @@ namespace LavaCake {
       std::array<T, N> diag(){
         if (m_diagDirty) {
           m_diag = m_max - m_min;
+          m_diagDirty = false;
         }
         return m_diag;
       }
@@ -112,13 +113,35 @@ namespace LavaCake {
             m_diagDirty = true;
           }
           else {
-            newMax[u] = m_min[u];
+            newMax[u] = m_max[u];
           }
         }
         m_min = newMin;
         m_max = newMax;
       }
 
+      /**
+       \brief enlarge the bounding box so the box passed is contained
+       \param  box : a N-dimensional bounding box
+       */
+      void addBox(const ABBox<N, T>& box) {
+        addPoint(box.m_min);
+        addPoint(box.m_max);
+      }
+
+      /**
+       \brief check if the bounding box contains at least one point
+       \return true if the min point is lower or equal to the max point on every dimension
+       */
+      bool isValid() const {
+        for (uint8_t u = 0; u < N; u++) {
+          if (m_min[u] > m_max[u]) {
+            return false;
+          }
+        }
+        return true;
+      }
+
 
     private:
       
@@ -0,0 +1,262 @@
+#include "Culling.h"
+#include <algorithm>
+
+namespace LavaCake {
+  namespace Helpers {
+
+    ABBox<3> TransformBox(const ABBox<3>& box, const mat4& transform) {
+      if (!box.isValid()) {
+        return box;
+      }
+      vec3f min = box.A();
+      vec3f max = box.B();
+      vec3f center = (min + max) * 0.5f;
+      vec3f extent = (max - min) * 0.5f;
+
+      vec3f newCenter;
+      vec3f newExtent;
+      for (int r = 0; r < 3; r++) {
+        newCenter[r] = transform[r] * center[0] + transform[4 + r] * center[1] + transform[8 + r] * center[2] + transform[12 + r];
+        newExtent[r] = std::abs(transform[r]) * extent[0] + std::abs(transform[4 + r]) * extent[1] + std::abs(transform[8 + r]) * extent[2];
+      }
+      return ABBox<3>(newCenter - newExtent, newCenter + newExtent);
+    }
+
+
+    Frustum::Frustum() {
+      for (auto& plane : m_planes) {
+        plane = vec4f({ 0.0f, 0.0f, 0.0f, 1.0f });
+      }
+    }
+
+    Frustum::Frustum(const mat4& m) {
+      // rows of the column major matrix
+      vec4f r0 = vec4f({ m[0], m[4], m[8],  m[12] });
+      vec4f r1 = vec4f({ m[1], m[5], m[9],  m[13] });
+      vec4f r2 = vec4f({ m[2], m[6], m[10], m[14] });
+      vec4f r3 = vec4f({ m[3], m[7], m[11], m[15] });
+
+      // -w <= x <= w, -w <= y <= w, 0 <= z <= w
+      m_planes[0] = r3 + r0;
+      m_planes[1] = r3 - r0;
+      m_planes[2] = r3 + r1;
+      m_planes[3] = r3 - r1;
+      m_planes[4] = r2;
+      m_planes[5] = r3 - r2;
+
+      for (auto& plane : m_planes) {
+        float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f) {
+          plane = plane / length;
+        }
+      }
+    }
+
+    bool Frustum::intersect(const ABBox<3>& box) const {
+      vec3f min = box.A();
+      vec3f max = box.B();
+      for (auto& plane : m_planes) {
+        // farthest corner along the plane normal
+        float d = plane[3];
+        d += plane[0] * (plane[0] > 0.0f ? max[0] : min[0]);
+        d += plane[1] * (plane[1] > 0.0f ? max[1] : min[1]);
+        d += plane[2] * (plane[2] > 0.0f ? max[2] : min[2]);
+        if (d < 0.0f) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    bool Frustum::contains(const ABBox<3>& box) const {
+      vec3f min = box.A();
+      vec3f max = box.B();
+      for (auto& plane : m_planes) {
+        // nearest corner along the plane normal
+        float d = plane[3];
+        d += plane[0] * (plane[0] > 0.0f ? min[0] : max[0]);
+        d += plane[1] * (plane[1] > 0.0f ? min[1] : max[1]);
+        d += plane[2] * (plane[2] > 0.0f ? min[2] : max[2]);
+        if (d < 0.0f) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+
+    void PackedBounds::add(const ABBox<3>& box) {
+      vec3f min = box.A();
+      vec3f max = box.B();
+      m_minX.push_back(min[0]);
+      m_minY.push_back(min[1]);
+      m_minZ.push_back(min[2]);
+      m_maxX.push_back(max[0]);
+      m_maxY.push_back(max[1]);
+      m_maxZ.push_back(max[2]);
+    }
+
+    void PackedBounds::clear() {
+      m_minX.clear();
+      m_minY.clear();
+      m_minZ.clear();
+      m_maxX.clear();
+      m_maxY.clear();
+      m_maxZ.clear();
+    }
+
+    ABBox<3> PackedBounds::get(size_t index) const {
+      return ABBox<3>(
+        vec3f({ m_minX[index], m_minY[index], m_minZ[index] }),
+        vec3f({ m_maxX[index], m_maxY[index], m_maxZ[index] }));
+    }
+
+    uint32_t PackedBounds::cull(const Frustum& frustum, size_t begin, size_t end, std::vector<uint8_t>& visibility) const {
+      end = std::min(end, size());
+      if (begin >= end) {
+        return 0;
+      }
+      size_t count = end - begin;
+      if (visibility.size() < count) {
+        visibility.resize(count);
+      }
+
+      const float* minX = m_minX.data() + begin;
+      const float* minY = m_minY.data() + begin;
+      const float* minZ = m_minZ.data() + begin;
+      const float* maxX = m_maxX.data() + begin;
+      const float* maxY = m_maxY.data() + begin;
+      const float* maxZ = m_maxZ.data() + begin;
+      uint8_t* visible = visibility.data();
+
+      for (size_t i = 0; i < count; i++) {
+        visible[i] = 1;
+      }
+
+      // One pass per plane over contiguous arrays, using the center/extent form of the test
+      // so that the loop body has no branch and can be vectorized.
+      for (auto& plane : frustum.planes()) {
+        float nx = plane[0], ny = plane[1], nz = plane[2], d = plane[3];
+        float ax = std::abs(nx), ay = std::abs(ny), az = std::abs(nz);
+        for (size_t i = 0; i < count; i++) {
+          float cx = (maxX[i] + minX[i]) * 0.5f;
+          float cy = (maxY[i] + minY[i]) * 0.5f;
+          float cz = (maxZ[i] + minZ[i]) * 0.5f;
+          float ex = (maxX[i] - minX[i]) * 0.5f;
+          float ey = (maxY[i] - minY[i]) * 0.5f;
+          float ez = (maxZ[i] - minZ[i]) * 0.5f;
+          float distance = nx * cx + ny * cy + nz * cz + d;
+          float radius = ax * ex + ay * ey + az * ez;
+          visible[i] &= (uint8_t)(distance + radius >= 0.0f);
+        }
+      }
+
+      uint32_t visibleCount = 0;
+      for (size_t i = 0; i < count; i++) {
+        visibleCount += visible[i];
+      }
+      return visibleCount;
+    }
+
+
+    void SceneHierarchy::build(const std::vector<ABBox<3>>& boxes, uint32_t leafSize) {
+      m_nodes.clear();
+      m_objects.clear();
+      m_bounds.clear();
+      if (boxes.empty()) {
+        return;
+      }
+      leafSize = std::max(1u, leafSize);
+
+      std::vector<vec3f> centers(boxes.size());
+      m_objects.resize(boxes.size());
+      for (uint32_t i = 0; i < boxes.size(); i++) {
+        centers[i] = (boxes[i].A() + boxes[i].B()) * 0.5f;
+        m_objects[i] = i;
+      }
+
+      m_nodes.reserve(2 * boxes.size());
+      m_nodes.push_back({ ABBox<3>(), 0, (uint32_t)boxes.size(), 0 });
+      buildNode(0, boxes, centers, leafSize);
+
+      for (uint32_t object : m_objects) {
+        m_bounds.add(boxes[object]);
+      }
+    }
+
+    void SceneHierarchy::buildNode(uint32_t index, const std::vector<ABBox<3>>& boxes, const std::vector<vec3f>& centers, uint32_t leafSize) {
+      uint32_t first = m_nodes[index].first;
+      uint32_t count = m_nodes[index].count;
+
+      ABBox<3> box;
+      ABBox<3> centerBox;
+      for (uint32_t i = first; i < first + count; i++) {
+        box.addBox(boxes[m_objects[i]]);
+        centerBox.addPoint(centers[m_objects[i]]);
+      }
+      m_nodes[index].box = box;
+
+      if (count <= leafSize) {
+        return;
+      }
+
+      // median split along the largest extent of the object centers
+      vec3f extent = centerBox.diag();
+      int axis = 0;
+      if (extent[1] > extent[axis]) axis = 1;
+      if (extent[2] > extent[axis]) axis = 2;
+
+      uint32_t half = count / 2;
+      std::nth_element(m_objects.begin() + first, m_objects.begin() + first + half, m_objects.begin() + first + count,
+        [&](uint32_t a, uint32_t b) {
+          return centers[a][axis] < centers[b][axis];
+        });
+
+      uint32_t child = (uint32_t)m_nodes.size();
+      m_nodes[index].child = child;
+      m_nodes.push_back({ ABBox<3>(), first, half, 0 });
+      m_nodes.push_back({ ABBox<3>(), first + half, count - half, 0 });
+      buildNode(child, boxes, centers, leafSize);
+      buildNode(child + 1, boxes, centers, leafSize);
+    }
+
+    uint32_t SceneHierarchy::cull(const Frustum& frustum, std::vector<uint8_t>& visibility, cullScratch& scratch) const {
+      visibility.assign(m_objects.size(), 0);
+      if (m_nodes.empty()) {
+        return 0;
+      }
+
+      uint32_t visibleCount = 0;
+      scratch.stack.clear();
+      scratch.stack.push_back(0);
+      while (!scratch.stack.empty()) {
+        const node& n = m_nodes[scratch.stack.back()];
+        scratch.stack.pop_back();
+
+        if (!frustum.intersect(n.box)) {
+          continue;
+        }
+
+        if (frustum.contains(n.box)) {
+          for (uint32_t i = n.first; i < n.first + n.count; i++) {
+            visibility[m_objects[i]] = 1;
+          }
+          visibleCount += n.count;
+        }
+        else if (n.child == 0) {
+          scratch.leafVisibility.clear();
+          visibleCount += m_bounds.cull(frustum, n.first, n.first + n.count, scratch.leafVisibility);
+          for (uint32_t i = 0; i < n.count; i++) {
+            visibility[m_objects[n.first + i]] = scratch.leafVisibility[i];
+          }
+        }
+        else {
+          scratch.stack.push_back(n.child);
+          scratch.stack.push_back(n.child + 1);
+        }
+      }
+      return visibleCount;
+    }
+
+  }
+}
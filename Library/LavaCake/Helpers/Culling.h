@@ -0,0 +1,197 @@
+#pragma once
+#include <array>
+#include <vector>
+#include "AllHeaders.h"
+#include <LavaCake/Math/basics.h>
+#include "ABBox.h"
+
+namespace LavaCake {
+  namespace Helpers {
+
+    /**
+     \brief Compute the axis aligned bounding box of a transformed box
+     \param box: the box to transform
+     \param transform: a column major affine transformation
+     \return the smallest axis aligned box containing the transformed box
+     */
+    ABBox<3> TransformBox(const ABBox<3>& box, const mat4& transform);
+
+    /**
+     *Class Frustum :
+     *\brief Represent the six planes of a view frustum, the normals pointing inward
+     */
+    class Frustum {
+    public:
+
+      /**
+       \brief default constructor, the resulting frustum contains everything
+       */
+      Frustum();
+
+      /**
+       \brief Extract the frustum planes from a projection or view-projection matrix
+       \param viewProjection: a column major matrix such as the one built by PreparePerspectiveProjectionMatrix, multiplied by a view matrix,
+       the clip space depth is expected to be in the [0, 1] range
+       */
+      Frustum(const mat4& viewProjection);
+
+      /**
+       \brief get the frustum planes
+       \return the 6 planes (left, right, bottom, top, near, far) stored as (nx, ny, nz, d), a point p is inside the plane if dot(n,p) + d >= 0
+       */
+      const std::array<vec4f, 6>& planes() const {
+        return m_planes;
+      }
+
+      /**
+       \brief check if a bounding box is at least partially inside the frustum
+       \param box: the box to test
+       \return false if the box is guaranteed to be outside the frustum
+       */
+      bool intersect(const ABBox<3>& box) const;
+
+      /**
+       \brief check if a bounding box is completely inside the frustum
+       \param box: the box to test
+       \return true if every point of the box is inside the frustum
+       */
+      bool contains(const ABBox<3>& box) const;
+
+    private:
+      std::array<vec4f, 6>                                          m_planes;
+    };
+
+    /**
+     *Class PackedBounds :
+     *\brief Store an array of bounding boxes as a structure of arrays so that they can be tested against a frustum in bulk
+     */
+    class PackedBounds {
+    public:
+
+      /**
+       \brief add a box at the end of the array
+       \param box: the box to add
+       */
+      void add(const ABBox<3>& box);
+
+      /**
+       \brief remove every box
+       */
+      void clear();
+
+      /**
+       \brief get the number of boxes
+       */
+      size_t size() const {
+        return m_minX.size();
+      }
+
+      /**
+       \brief get the box at the given index
+       */
+      ABBox<3> get(size_t index) const;
+
+      /**
+       \brief test a range of boxes against a frustum
+       \param frustum: the frustum to test against
+       \param begin: the first box tested
+       \param end: one after the last box tested
+       \param visibility: receive 1 for each box intersecting the frustum, 0 otherwise, at index i - begin, resized if needed
+       \return the number of visible boxes in the range
+       */
+      uint32_t cull(const Frustum& frustum, size_t begin, size_t end, std::vector<uint8_t>& visibility) const;
+
+      /**
+       \brief test every boxes against a frustum
+       \param frustum: the frustum to test against
+       \param visibility: receive 1 for each box intersecting the frustum, 0 otherwise
+       \return the number of visible boxes
+       */
+      uint32_t cull(const Frustum& frustum, std::vector<uint8_t>& visibility) const {
+        return cull(frustum, 0, size(), visibility);
+      }
+
+    private:
+      std::vector<float>                                            m_minX;
+      std::vector<float>                                            m_minY;
+      std::vector<float>                                            m_minZ;
+      std::vector<float>                                            m_maxX;
+      std::vector<float>                                            m_maxY;
+      std::vector<float>                                            m_maxZ;
+    };
+
+    /**
+     \brief the traversal buffers of SceneHierarchy::cull, owned by the caller and kept between draws to avoid allocations
+     */
+    struct cullScratch {
+      std::vector<uint32_t>     stack;
+      std::vector<uint8_t>      leafVisibility;
+    };
+
+    /**
+     *Class SceneHierarchy :
+     *\brief Bounding volume hierarchy over the bounding boxes of scene objects, used to find the objects visible from a frustum
+     */
+    class SceneHierarchy {
+    public:
+
+      /**
+       \brief build the hierarchy, any previous content is discarded
+       \param boxes: the bounding box of each object, the object index being the box index
+       \param leafSize: the maximum number of objects stored in a leaf
+       */
+      void build(const std::vector<ABBox<3>>& boxes, uint32_t leafSize = 4);
+
+      /**
+       \brief find the objects intersecting a frustum, threads culling the same hierarchy concurrently must use their own scratch buffers
+       \param frustum: the frustum to test against
+       \param visibility: receive 1 for each visible object, 0 otherwise, resized to the number of objects
+       \param scratch: the traversal buffers, cleared before use
+       \return the number of visible objects
+       */
+      uint32_t cull(const Frustum& frustum, std::vector<uint8_t>& visibility, cullScratch& scratch) const;
+
+      /**
+       \brief find the objects intersecting a frustum with temporary traversal buffers
+       \param frustum: the frustum to test against
+       \param visibility: receive 1 for each visible object, 0 otherwise, resized to the number of objects
+       \return the number of visible objects
+       */
+      uint32_t cull(const Frustum& frustum, std::vector<uint8_t>& visibility) const {
+        cullScratch scratch;
+        return cull(frustum, visibility, scratch);
+      }
+
+      /**
+       \brief get the number of objects stored in the hierarchy
+       */
+      size_t size() const {
+        return m_objects.size();
+      }
+
+      /**
+       \brief get the bounding box of the whole scene
+       */
+      ABBox<3> getABBox() const {
+        return m_nodes.empty() ? ABBox<3>() : m_nodes[0].box;
+      }
+
+    private:
+
+      struct node {
+        ABBox<3>  box;
+        // range of m_objects covered by the node
+        uint32_t  first;
+        uint32_t  count;
+        // index of the first child, the second one being child + 1, 0 for leaves
+        uint32_t  child;
+      };
+
+      void buildNode(uint32_t index, const std::vector<ABBox<3>>& boxes, const std::vector<vec3f>& centers, uint32_t leafSize);
+
+      std::vector<node>                                             m_nodes;
+      std::vector<uint32_t>                                         m_objects;
+      PackedBounds                                                  m_bounds;
+    };
+  }
+}
@@ -1,7 +1,8 @@
 #pragma once
+#include <span>
 #include "helpers.h"
 #include "ABBox.h"
-#include "Math/basics.h"
+#include <LavaCake/Math/basics.h>
 
 namespace LavaCake {
   namespace Helpers {
@@ -94,14 +95,14 @@ namespace LavaCake {
     }
     
     
-    std::vector<T> getRawField(){return m_fields;}
-    vec2u getDimension(){return{m_width,m_height};}
+    const std::vector<T>& getRawField() const {return m_fields;}
+    vec2u getDimension() const {return{m_width,m_height};}
     
     /**
      \brief get the bounding box of the field
      \return a bounding box 2D
      */
-    ABBox<2> getABBox(){return m_boundingbox;}
+    ABBox<2> getABBox() const {return m_boundingbox;}
     
     private :
     uint32_t        m_width;
@@ -130,6 +131,15 @@ namespace LavaCake {
   };
   
   
+  /**
+   \brief Enum : field layout
+   Memory layout of the values of a grid field
+  */
+  enum fieldLayout {
+    LINEAR,   /*!< values are stored x first, then y, then z */
+    BRICKED   /*!< values are stored by 4x4x4 bricks, in Morton order inside a brick, so that the 8 values used by an interpolation are close in memory */
+  };
+
   /**
    *Class  Field3DGrid :
    *\brief A class that represent a 3D field sampled on a regular grid
@@ -141,20 +151,42 @@ namespace LavaCake {
     
     /**
      *\brief Create a 3D field
-     *\param data a std::vector of data
+     *\param data a std::vector of data, stored x first, then y, then z
      *\param width the width of the grid
      *\param height the height of the grid
      *\param dpeth  the depth of the grid
      *\param boundingbox the bounding box of the field in the domain
      *\param interpolate [optional]  a funtion pointer to an interpolation function for the type T
+     *\param layout [optional] the memory layout used to store the values
      */
-    Field3DGrid(std::vector<T>& data, uint32_t width, uint32_t height, uint32_t depth, ABBox<3> boundingbox, T (*interpolate)(T&, T&, float) = nullptr){
-      m_fields = data;
-      m_width = width;
-      m_height = height;
-      m_depth = depth;
-      m_boundingbox = boundingbox;
-      m_interpolate = interpolate;
+    Field3DGrid(std::vector<T>& data, uint32_t width, uint32_t height, uint32_t depth, ABBox<3> boundingbox, T (*interpolate)(T&, T&, float) = nullptr, fieldLayout layout = LINEAR){
+      init(width, height, depth, boundingbox, interpolate, layout);
+      if (m_layout == LINEAR) {
+        m_fields = data;
+      }
+      else {
+        storeBricked(data);
+      }
+    }
+
+    /**
+     *\brief Create a 3D field, taking ownership of the data instead of copying it when the layout is LINEAR
+     *\param data a std::vector of data, stored x first, then y, then z
+     *\param width the width of the grid
+     *\param height the height of the grid
+     *\param dpeth  the depth of the grid
+     *\param boundingbox the bounding box of the field in the domain
+     *\param interpolate [optional]  a funtion pointer to an interpolation function for the type T
+     *\param layout [optional] the memory layout used to store the values
+     */
+    Field3DGrid(std::vector<T>&& data, uint32_t width, uint32_t height, uint32_t depth, ABBox<3> boundingbox, T (*interpolate)(T&, T&, float) = nullptr, fieldLayout layout = LINEAR){
+      init(width, height, depth, boundingbox, interpolate, layout);
+      if (m_layout == LINEAR) {
+        m_fields = std::move(data);
+      }
+      else {
+        storeBricked(data);
+      }
     }
     
     /**
@@ -163,37 +195,152 @@ namespace LavaCake {
      \return the value of the field at the position pos
      */
     T sample(vec3f pos) override{
-      vec3f X = (pos - m_boundingbox.A()) / (m_boundingbox.B() - m_boundingbox.A());
-      X = X * vec3f({float(m_width-1), float(m_height-1), float(m_depth-1)});
-      
-      X = vec3f({fmax(0.0f, X[0]), fmax(0.0f, X[1]), fmax(0.0f, X[2])});
-      
-      vec3u U = vec3u({uint32_t(X[0]),uint32_t(X[1]), uint32_t(X[2])});
-      vec3f R = X - vec3f({float(U[0]),float(U[1]),float(U[2])});
-      
-      
-      if(U[0] >= m_width-1){
-        U[0] = m_width-2;
-        R[0] = 1.0f;
+      vec3u U;
+      vec3f R;
+      cell(pos, U, R);
+      return interpolate(U, R);
+    }
+
+    /**
+     \brief sample the field at many positions at once, without virtual call
+     \param positions the sample positions
+     \param values receive the value of the field at each position, must be at least as large as positions
+     \param threadCount [optional] the number of threads used, 0 to use all the available cores, small batches always run on the calling thread
+     */
+    void sample(std::span<const vec3f> positions, std::span<T> values, uint32_t threadCount = 1) const {
+      size_t count = std::min(positions.size(), values.size());
+
+      auto job = [&](size_t begin, size_t end) {
+        vec3u U[sampleBlockSize];
+        vec3f R[sampleBlockSize];
+        for (size_t b = begin; b < end; b += sampleBlockSize) {
+          size_t n = std::min(sampleBlockSize, end - b);
+          // cell computation on a whole block first, this loop only does float arithmetic and is vectorized
+          for (size_t i = 0; i < n; i++) {
+            cell(positions[b + i], U[i], R[i]);
+          }
+          for (size_t i = 0; i < n; i++) {
+            values[b + i] = interpolate(U[i], R[i]);
+          }
+        }
+      };
+
+      if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
       }
-      if(U[1] >= m_height-1){
-        U[1] = m_height-2;
-        R[1] = 1.0f;
+      threadCount = (uint32_t)std::min<size_t>(threadCount, std::max<size_t>(1, count / minimalSamplesPerThread));
+      if (threadCount <= 1) {
+        job(0, count);
+        return;
       }
-      if(U[2] >= m_depth-1){
-        U[2] = m_depth-2;
-        R[2] = 1.0f;
+
+      size_t chunk = (count + threadCount - 1) / threadCount;
+      std::vector<std::thread> threads;
+      for (uint32_t t = 1; t < threadCount; t++) {
+        size_t begin = std::min(count, t * chunk);
+        size_t end = std::min(count, begin + chunk);
+        threads.emplace_back(job, begin, end);
       }
-      
+      job(0, std::min(count, chunk));
+      for (auto& thread : threads) {
+        thread.join();
+      }
+    }
+
+    /**
+     \brief get the value stored at a grid point
+     \param x, y, z the coordinates of the grid point
+     \return the value stored at this grid point
+     */
+    const T& at(uint32_t x, uint32_t y, uint32_t z) const {
+      return m_fields[index(x, y, z)];
+    }
+    
+    /**
+     \brief get the stored values, in the order given by getLayout
+     \return a reference to the stored values
+     */
+    const std::vector<T>& getRawField() const {return m_fields;};
+    vec3u getDimension() const {return{m_width,m_height,m_depth};};
+
+    /**
+     \brief get the memory layout of the stored values
+     */
+    fieldLayout getLayout() const {return m_layout;};
+    
+    /**
+     \brief get the bounding box of the field
+     \return a bounding box 3D
+     */
+    ABBox<3> getABBox() const {return m_boundingbox;};
+    
+    private :
+
+    static constexpr size_t sampleBlockSize = 64;
+    static constexpr size_t minimalSamplesPerThread = 16384;
+
+    void init(uint32_t width, uint32_t height, uint32_t depth, ABBox<3> boundingbox, T (*interpolate)(T&, T&, float), fieldLayout layout) {
+      m_width = width;
+      m_height = height;
+      m_depth = depth;
+      m_boundingbox = boundingbox;
+      m_interpolate = interpolate;
+      m_layout = layout;
+
+      m_origin = m_boundingbox.A();
+      vec3f extent = m_boundingbox.B() - m_boundingbox.A();
+      m_scale = vec3f({ float(m_width - 1) / extent[0], float(m_height - 1) / extent[1], float(m_depth - 1) / extent[2] });
+      m_maxCoord = vec3f({ float(m_width - 1), float(m_height - 1), float(m_depth - 1) });
+
+      m_bricksX = (m_width + 3) / 4;
+      m_bricksY = (m_height + 3) / 4;
+      m_bricksZ = (m_depth + 3) / 4;
+    }
+
+    void storeBricked(const std::vector<T>& data) {
+      m_fields = std::vector<T>(size_t(m_bricksX) * m_bricksY * m_bricksZ * 64);
+      for (uint32_t z = 0; z < m_depth; z++) {
+        for (uint32_t y = 0; y < m_height; y++) {
+          for (uint32_t x = 0; x < m_width; x++) {
+            m_fields[index(x, y, z)] = data[x + y * m_width + size_t(z) * m_width * m_height];
+          }
+        }
+      }
+    }
+
+    size_t index(uint32_t x, uint32_t y, uint32_t z) const {
+      if (m_layout == LINEAR) {
+        return x + y * m_width + size_t(z) * m_width * m_height;
+      }
+      size_t brick = (x >> 2) + (y >> 2) * m_bricksX + size_t(z >> 2) * m_bricksX * m_bricksY;
+      // interleave the two low bits of each coordinate
+      uint32_t morton = (x & 1) | ((y & 1) << 1) | ((z & 1) << 2) | ((x & 2) << 2) | ((y & 2) << 3) | ((z & 2) << 4);
+      return brick * 64 + morton;
+    }
+
+    // grid cell containing pos and position inside the cell, positions outside of the grid are clamped to its border
+    void cell(const vec3f& pos, vec3u& U, vec3f& R) const {
+      for (int u = 0; u < 3; u++) {
+        float X = (pos[u] - m_origin[u]) * m_scale[u];
+        X = X > 0.0f ? X : 0.0f;
+        X = X < m_maxCoord[u] ? X : m_maxCoord[u];
+        float I = std::floor(X);
+        I = I < m_maxCoord[u] - 1.0f ? I : m_maxCoord[u] - 1.0f;
+        U[u] = uint32_t(I);
+        R[u] = X - I;
+      }
+    }
+
+    T interpolate(const vec3u& U, const vec3f& R) const {
       T A,B,C,D,E,F,G,H;
-      A = m_fields[U[0]   +  U[1]    *m_width + U[2]    *m_width*m_height];
-      B = m_fields[U[0]+1 +  U[1]    *m_width + U[2]    *m_width*m_height];
-      C = m_fields[U[0]   + (U[1]+1) *m_width + U[2]    *m_width*m_height];
-      D = m_fields[U[0]+1 + (U[1]+1) *m_width + U[2]    *m_width*m_height];
-      E = m_fields[U[0]   +  U[1]    *m_width + (U[2]+1)*m_width*m_height];
-      F = m_fields[U[0]+1 +  U[1]    *m_width + (U[2]+1)*m_width*m_height];
-      G = m_fields[U[0]   + (U[1]+1) *m_width + (U[2]+1)*m_width*m_height];
-      H = m_fields[U[0]+1 + (U[1]+1) *m_width + (U[2]+1)*m_width*m_height];
+      A = m_fields[index(U[0]  , U[1]  , U[2]  )];
+      B = m_fields[index(U[0]+1, U[1]  , U[2]  )];
+      C = m_fields[index(U[0]  , U[1]+1, U[2]  )];
+      D = m_fields[index(U[0]+1, U[1]+1, U[2]  )];
+      E = m_fields[index(U[0]  , U[1]  , U[2]+1)];
+      F = m_fields[index(U[0]+1, U[1]  , U[2]+1)];
+      G = m_fields[index(U[0]  , U[1]+1, U[2]+1)];
+      H = m_fields[index(U[0]+1, U[1]+1, U[2]+1)];
 
       if (m_interpolate == nullptr) {
         T AB = B * R[0] + A * (1.0f - R[0]);
@@ -210,35 +357,33 @@ namespace LavaCake {
       }
 
       T AB = m_interpolate(A, B, R[0]);
-      T CD = m_interpolate(A, B, R[0]);
+      T CD = m_interpolate(C, D, R[0]);
       T ABCD = m_interpolate(AB, CD, R[1]);
 
       T EF = m_interpolate(E, F, R[0]);
       T GH = m_interpolate(G, H, R[0]);
       T EFGH = m_interpolate(EF, GH, R[1]);
       return m_interpolate(ABCD, EFGH, R[2]);
-
     }
-    
-    std::vector<T> getRawField(){return m_fields;};
-    vec3u getDimension(){return{m_width,m_height,m_depth};};
-    
-    /**
-     \brief get the bounding box of the field
-     \return a bounding box 3D
-     */
-    ABBox<3> getABBox(){return m_boundingbox;};
-    
-    private :
+
     uint32_t        m_width;
     uint32_t        m_height;
     uint32_t        m_depth;
     std::vector<T>  m_fields;
     ABBox<3>        m_boundingbox;
+    fieldLayout     m_layout = LINEAR;
+
+    // precomputed sampling terms
+    vec3f           m_origin;
+    vec3f           m_scale;
+    vec3f           m_maxCoord;
+
+    uint32_t        m_bricksX = 0;
+    uint32_t        m_bricksY = 0;
+    uint32_t        m_bricksZ = 0;
 
     T (*m_interpolate)(T&, T&, float);
   };
   
-  
   }
 }
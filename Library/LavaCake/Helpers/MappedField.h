@@ -0,0 +1,325 @@
+#pragma once
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include "Field.h"
+#include "MappedFile.h"
+#include <LavaCake/Framework/ErrorCheck.h>
+
+namespace LavaCake {
+  namespace Helpers {
+
+  /**
+   *Class  MappedField3D :
+   *\brief A class that represent a 3D field sampled on a regular grid stored in a memory mapped file,
+   *for fields that do not fit in memory. The file stores the grid by bricks, each brick also holding the first values of its
+   *neighbours so that an interpolation only reads one brick. Bricks are copied from the mapping when they are sampled and kept
+   *in a least recently used cache of bounded size.
+   *\tparam T  the type the Field will hold, it must be trivially copyable
+   */
+  template <typename T>
+  class MappedField3D : public Field3D<T>{
+    static_assert(std::is_trivially_copyable<T>::value, "MappedField3D values are copied from a file and must be trivially copyable");
+  public:
+
+    /**
+     *\brief Write a bricked field file, values are requested brick by brick so the whole field never needs to be in memory
+     *\param path the path of the file to write
+     *\param width the width of the grid
+     *\param height the height of the grid
+     *\param depth  the depth of the grid
+     *\param value a function returning the value of the grid point (x, y, z)
+     *\param brickSize [optional] the number of cells of a brick along each axis
+     *\return true if the file was written
+     */
+    static bool write(const std::string& path, uint32_t width, uint32_t height, uint32_t depth, const std::function<T(uint32_t, uint32_t, uint32_t)>& value, uint32_t brickSize = 16) {
+      if (width < 2 || height < 2 || depth < 2 || brickSize == 0) {
+        Framework::ErrorCheck::setError("A mapped field needs at least 2 grid points per axis");
+        return false;
+      }
+      std::ofstream file(path, std::ios::binary | std::ios::trunc);
+      if (!file) {
+        Framework::ErrorCheck::setError("Could not open the mapped field file for writing");
+        return false;
+      }
+
+      header h = { { 'L', 'C', 'F', 'I', 'E', 'L', 'D', '1' }, width, height, depth, brickSize, (uint32_t)sizeof(T), 0 };
+      file.write(reinterpret_cast<const char*>(&h), sizeof(header));
+
+      uint32_t bx = brickCount(width, brickSize);
+      uint32_t by = brickCount(height, brickSize);
+      uint32_t bz = brickCount(depth, brickSize);
+      uint32_t s = brickSize + 1;
+      std::vector<T> brick(size_t(s) * s * s);
+      for (uint32_t k = 0; k < bz; k++) {
+        for (uint32_t j = 0; j < by; j++) {
+          for (uint32_t i = 0; i < bx; i++) {
+            // points past the end of the grid repeat the last one
+            for (uint32_t z = 0; z < s; z++) {
+              for (uint32_t y = 0; y < s; y++) {
+                for (uint32_t x = 0; x < s; x++) {
+                  brick[x + y * s + size_t(z) * s * s] = value(
+                    std::min(i * brickSize + x, width - 1),
+                    std::min(j * brickSize + y, height - 1),
+                    std::min(k * brickSize + z, depth - 1));
+                }
+              }
+            }
+            file.write(reinterpret_cast<const char*>(brick.data()), brick.size() * sizeof(T));
+          }
+        }
+      }
+      if (!file) {
+        Framework::ErrorCheck::setError("Could not write the mapped field file");
+        return false;
+      }
+      return true;
+    }
+
+    /**
+     *\brief Write a bricked field file from data stored x first, then y, then z
+     *\param path the path of the file to write
+     *\param data a std::vector of data
+     *\param width the width of the grid
+     *\param height the height of the grid
+     *\param depth  the depth of the grid
+     *\param brickSize [optional] the number of cells of a brick along each axis
+     *\return true if the file was written
+     */
+    static bool write(const std::string& path, const std::vector<T>& data, uint32_t width, uint32_t height, uint32_t depth, uint32_t brickSize = 16) {
+      return write(path, width, height, depth, [&](uint32_t x, uint32_t y, uint32_t z) {
+        return data[x + y * width + size_t(z) * width * height];
+      }, brickSize);
+    }
+
+    /**
+     *\brief Open a field file written by MappedField3D::write, check isOpen to know if it succeeded
+     *\param path the path of the file
+     *\param boundingbox the bounding box of the field in the domain
+     *\param maxResidentBricks [optional] the maximum number of bricks kept in memory
+     *\param interpolate [optional]  a funtion pointer to an interpolation function for the type T
+     */
+    MappedField3D(const std::string& path, ABBox<3> boundingbox, size_t maxResidentBricks = 4096, T (*interpolate)(T&, T&, float) = nullptr) : m_file(path) {
+      m_boundingbox = boundingbox;
+      m_interpolate = interpolate;
+      m_maxResidentBricks = std::max<size_t>(1, maxResidentBricks);
+      if (!m_file.isOpen()) {
+        return;
+      }
+
+      header h;
+      if (m_file.size() < sizeof(header)) {
+        Framework::ErrorCheck::setError("The mapped field file is too small");
+        return;
+      }
+      std::memcpy(&h, m_file.data(), sizeof(header));
+      if (std::memcmp(h.magic, "LCFIELD1", 8) != 0 || h.valueSize != sizeof(T) || h.width < 2 || h.height < 2 || h.depth < 2 || h.brickSize == 0) {
+        Framework::ErrorCheck::setError("The mapped field file header does not match the field type");
+        return;
+      }
+
+      m_width = h.width;
+      m_height = h.height;
+      m_depth = h.depth;
+      m_brickSize = h.brickSize;
+      m_bricksX = brickCount(m_width, m_brickSize);
+      m_bricksY = brickCount(m_height, m_brickSize);
+      m_bricksZ = brickCount(m_depth, m_brickSize);
+      uint32_t s = m_brickSize + 1;
+      m_brickValues = size_t(s) * s * s;
+
+      size_t expected = sizeof(header) + size_t(m_bricksX) * m_bricksY * m_bricksZ * m_brickValues * sizeof(T);
+      if (m_file.size() < expected) {
+        Framework::ErrorCheck::setError("The mapped field file is truncated");
+        return;
+      }
+
+      m_origin = m_boundingbox.A();
+      vec3f extent = m_boundingbox.B() - m_boundingbox.A();
+      m_scale = vec3f({ float(m_width - 1) / extent[0], float(m_height - 1) / extent[1], float(m_depth - 1) / extent[2] });
+      m_maxCoord = vec3f({ float(m_width - 1), float(m_height - 1), float(m_depth - 1) });
+      m_valid = true;
+    }
+
+    /**
+     \brief check if the field file was opened and matches the field type
+     */
+    bool isOpen() const {
+      return m_valid;
+    }
+
+    /**
+     \brief sample the field at a postion, loading the containing brick if it is not resident
+     \param pos a vec3f representing the sample position
+     \return the value of the field at the position pos
+     */
+    T sample(vec3f pos) override{
+      if (!m_valid) {
+        return T();
+      }
+
+      vec3u U;
+      vec3f R;
+      for (int u = 0; u < 3; u++) {
+        float X = (pos[u] - m_origin[u]) * m_scale[u];
+        X = X > 0.0f ? X : 0.0f;
+        X = X < m_maxCoord[u] ? X : m_maxCoord[u];
+        float I = std::floor(X);
+        I = I < m_maxCoord[u] - 1.0f ? I : m_maxCoord[u] - 1.0f;
+        U[u] = uint32_t(I);
+        R[u] = X - I;
+      }
+
+      uint32_t brick = U[0] / m_brickSize + (U[1] / m_brickSize) * m_bricksX + (U[2] / m_brickSize) * m_bricksX * m_bricksY;
+      size_t s = m_brickSize + 1;
+      size_t i = U[0] % m_brickSize + (U[1] % m_brickSize) * s + (U[2] % m_brickSize) * s * s;
+
+      T A,B,C,D,E,F,G,H;
+      {
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+        const T* v = residentBrick(brick);
+        A = v[i];
+        B = v[i + 1];
+        C = v[i + s];
+        D = v[i + s + 1];
+        E = v[i + s * s];
+        F = v[i + s * s + 1];
+        G = v[i + s * s + s];
+        H = v[i + s * s + s + 1];
+      }
+
+      if (m_interpolate == nullptr) {
+        T AB = B * R[0] + A * (1.0f - R[0]);
+        T CD = D * R[0] + C * (1.0f - R[0]);
+
+        T ABCD = CD * R[1] + AB * (1.0f - R[1]);
+
+        T EF = F * R[0] + E * (1.0f - R[0]);
+        T GH = H * R[0] + G * (1.0f - R[0]);
+
+        T EFGH = GH * R[1] + EF * (1.0f - R[1]);
+
+        return EFGH * R[2] + ABCD * (1.0f - R[2]);
+      }
+
+      T AB = m_interpolate(A, B, R[0]);
+      T CD = m_interpolate(C, D, R[0]);
+      T ABCD = m_interpolate(AB, CD, R[1]);
+
+      T EF = m_interpolate(E, F, R[0]);
+      T GH = m_interpolate(G, H, R[0]);
+      T EFGH = m_interpolate(EF, GH, R[1]);
+      return m_interpolate(ABCD, EFGH, R[2]);
+    }
+
+    /**
+     \brief change the maximum number of bricks kept in memory, extra bricks are evicted
+     \param maxResidentBricks the maximum number of bricks kept in memory
+     */
+    void setMaxResidentBricks(size_t maxResidentBricks) {
+      std::lock_guard<std::mutex> lock(m_cacheMutex);
+      m_maxResidentBricks = std::max<size_t>(1, maxResidentBricks);
+      while (m_resident.size() > m_maxResidentBricks) {
+        m_resident.erase(m_lru.back());
+        m_lru.pop_back();
+      }
+    }
+
+    /**
+     \brief get the number of bricks currently in memory
+     */
+    size_t residentBrickCount() {
+      std::lock_guard<std::mutex> lock(m_cacheMutex);
+      return m_resident.size();
+    }
+
+    vec3u getDimension() const {return{m_width,m_height,m_depth};};
+
+    /**
+     \brief get the bounding box of the field
+     \return a bounding box 3D
+     */
+    ABBox<3> getABBox() const {return m_boundingbox;};
+
+    private :
+
+    struct header {
+      char      magic[8];
+      uint32_t  width;
+      uint32_t  height;
+      uint32_t  depth;
+      uint32_t  brickSize;
+      uint32_t  valueSize;
+      uint32_t  reserved;
+    };
+
+    struct residentBrickInfo {
+      std::vector<T>                    values;
+      std::list<uint32_t>::iterator     position;
+    };
+
+    static uint32_t brickCount(uint32_t size, uint32_t brickSize) {
+      return std::max(1u, (size - 1 + brickSize - 1) / brickSize);
+    }
+
+    // must be called with m_cacheMutex locked
+    const T* residentBrick(uint32_t brick) {
+      auto it = m_resident.find(brick);
+      if (it != m_resident.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, it->second.position);
+        return it->second.values.data();
+      }
+
+      // reuse the storage of the least recently used brick
+      std::vector<T> values;
+      if (m_resident.size() >= m_maxResidentBricks) {
+        auto victim = m_resident.find(m_lru.back());
+        values = std::move(victim->second.values);
+        m_resident.erase(victim);
+        m_lru.pop_back();
+      }
+      values.resize(m_brickValues);
+
+      size_t offset = sizeof(header) + size_t(brick) * m_brickValues * sizeof(T);
+      std::memcpy(values.data(), m_file.data() + offset, m_brickValues * sizeof(T));
+      // the brick now lives in the cache, the mapped pages can be reclaimed
+      m_file.release(offset, m_brickValues * sizeof(T));
+
+      m_lru.push_front(brick);
+      residentBrickInfo& info = m_resident[brick];
+      info.values = std::move(values);
+      info.position = m_lru.begin();
+      return info.values.data();
+    }
+
+    MappedFile                                        m_file;
+    bool                                              m_valid = false;
+
+    uint32_t                                          m_width = 0;
+    uint32_t                                          m_height = 0;
+    uint32_t                                          m_depth = 0;
+    uint32_t                                          m_brickSize = 0;
+    uint32_t                                          m_bricksX = 0;
+    uint32_t                                          m_bricksY = 0;
+    uint32_t                                          m_bricksZ = 0;
+    size_t                                            m_brickValues = 0;
+    ABBox<3>                                          m_boundingbox;
+
+    vec3f                                             m_origin;
+    vec3f                                             m_scale;
+    vec3f                                             m_maxCoord;
+
+    std::mutex                                        m_cacheMutex;
+    size_t                                            m_maxResidentBricks;
+    std::unordered_map<uint32_t, residentBrickInfo>   m_resident;
+    std::list<uint32_t>                               m_lru;
+
+    T (*m_interpolate)(T&, T&, float);
+  };
+
+  }
+}
@@ -0,0 +1,122 @@
+#include "MappedFile.h"
+#include <algorithm>
+#include <LavaCake/Framework/ErrorCheck.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace LavaCake {
+  namespace Helpers {
+
+#ifdef _WIN32
+
+  MappedFile::MappedFile(const std::string& path) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+      Framework::ErrorCheck::setError("Could not open the file to map");
+      return;
+    }
+    m_file = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+      Framework::ErrorCheck::setError("Could not get the size of the file to map");
+      return;
+    }
+
+    m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping == nullptr) {
+      Framework::ErrorCheck::setError("Could not create the file mapping");
+      return;
+    }
+
+    m_data = static_cast<const std::byte*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_data == nullptr) {
+      Framework::ErrorCheck::setError("Could not map the file in memory");
+      return;
+    }
+    m_size = (size_t)size.QuadPart;
+  }
+
+  void MappedFile::release(size_t offset, size_t size) const {
+    if (m_data == nullptr || offset >= m_size) {
+      return;
+    }
+    // unlocking pages that are not locked removes them from the working set
+    VirtualUnlock((LPVOID)(m_data + offset), std::min(size, m_size - offset));
+  }
+
+  MappedFile::~MappedFile() {
+    if (m_data != nullptr) {
+      UnmapViewOfFile(m_data);
+    }
+    if (m_mapping != nullptr) {
+      CloseHandle(m_mapping);
+    }
+    if (m_file != nullptr) {
+      CloseHandle(m_file);
+    }
+  }
+
+#else
+
+  MappedFile::MappedFile(const std::string& path) {
+    m_file = open(path.c_str(), O_RDONLY);
+    if (m_file == -1) {
+      Framework::ErrorCheck::setError("Could not open the file to map");
+      return;
+    }
+
+    struct stat info;
+    if (fstat(m_file, &info) != 0 || info.st_size == 0) {
+      Framework::ErrorCheck::setError("Could not get the size of the file to map");
+      return;
+    }
+
+    void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, m_file, 0);
+    if (data == MAP_FAILED) {
+      Framework::ErrorCheck::setError("Could not map the file in memory");
+      return;
+    }
+    madvise(data, (size_t)info.st_size, MADV_RANDOM);
+    m_data = static_cast<const std::byte*>(data);
+    m_size = (size_t)info.st_size;
+  }
+
+  void MappedFile::release(size_t offset, size_t size) const {
+    if (m_data == nullptr || offset >= m_size) {
+      return;
+    }
+    size = std::min(size, m_size - offset);
+
+    // only whole pages inside the range can be released
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t begin = (offset + page - 1) / page * page;
+    size_t end = (offset + size) / page * page;
+    if (begin < end) {
+      madvise((void*)(m_data + begin), end - begin, MADV_DONTNEED);
+    }
+  }
+
+  MappedFile::~MappedFile() {
+    if (m_data != nullptr) {
+      munmap((void*)m_data, m_size);
+    }
+    if (m_file != -1) {
+      close(m_file);
+    }
+  }
+
+#endif
+
+  }
+}
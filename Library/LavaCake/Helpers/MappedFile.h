@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace LavaCake {
+  namespace Helpers {
+
+  /**
+   *Class MappedFile :
+   *\brief Read only memory mapping of a whole file, pages are loaded by the system when they are first accessed
+   */
+  class MappedFile {
+  public:
+
+    /**
+     \brief Map a file in memory, check isOpen to know if the mapping succeeded
+     \param path the path of the file to map
+     */
+    MappedFile(const std::string& path);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     \brief check if the file is mapped
+     */
+    bool isOpen() const {
+      return m_data != nullptr;
+    }
+
+    /**
+     \brief get the beginning of the mapped file
+     */
+    const std::byte* data() const {
+      return m_data;
+    }
+
+    /**
+     \brief get the size of the mapped file in bytes
+     */
+    size_t size() const {
+      return m_size;
+    }
+
+    /**
+     \brief tell the system that a range of the file is not needed anymore so that its pages can be reclaimed,
+     the range stays readable and will be loaded again from the file if accessed
+     \param offset the beginning of the range in bytes
+     \param size the size of the range in bytes
+     */
+    void release(size_t offset, size_t size) const;
+
+    ~MappedFile();
+
+  private:
+    const std::byte*      m_data = nullptr;
+    size_t                m_size = 0;
+
+#ifdef _WIN32
+    void*                 m_file = nullptr;
+    void*                 m_mapping = nullptr;
+#else
+    int                   m_file = -1;
+#endif
+  };
+
+  }
+}
@@ -0,0 +1,282 @@
+#pragma once
+#include <bit>
+#include <unordered_map>
+#include "Field.h"
+
+namespace LavaCake {
+  namespace Helpers {
+
+  /**
+   *Class  SparseField3D :
+   *\brief A class that represent a 3D field sampled on a sparse regular grid.
+   *Voxels are stored in 8x8x8 leaf bricks, grouped by 16x16x16 leaves under internal nodes found through a hash map,
+   *so memory scales with the number of active voxels. Voxels that were never set hold the background value.
+   *\tparam T  the type the Field will hold
+   */
+  template <typename T>
+  class SparseField3D : public Field3D<T>{
+  public:
+
+    /**
+     *\brief Create an empty sparse 3D field
+     *\param background the value of every inactive voxel
+     *\param origin the position of the voxel (0,0,0) in the domain
+     *\param voxelSize the distance between two voxels in the domain
+     *\param interpolate [optional]  a funtion pointer to an interpolation function for the type T
+     */
+    SparseField3D(const T& background, vec3f origin = vec3f({ 0.0f, 0.0f, 0.0f }), float voxelSize = 1.0f, T (*interpolate)(T&, T&, float) = nullptr){
+      m_background = background;
+      m_origin = origin;
+      m_voxelSize = voxelSize;
+      m_interpolate = interpolate;
+    }
+
+    /**
+     \brief set the value of a voxel and mark it active
+     \param x, y, z the voxel coordinates
+     \param value the voxel value
+     */
+    void setValue(int32_t x, int32_t y, int32_t z, const T& value) {
+      leaf& l = m_leaves[touchLeaf(x, y, z)];
+      uint32_t i = leafOffset(x, y, z);
+      if (!(l.mask[i >> 6] & (uint64_t(1) << (i & 63)))) {
+        l.mask[i >> 6] |= uint64_t(1) << (i & 63);
+        m_activeCount++;
+      }
+      l.values[i] = value;
+    }
+
+    /**
+     \brief reset a voxel to the background value and mark it inactive, leaves are kept allocated
+     \param x, y, z the voxel coordinates
+     */
+    void setValueOff(int32_t x, int32_t y, int32_t z) {
+      uint32_t index = findLeaf(x, y, z);
+      if (index == empty) {
+        return;
+      }
+      leaf& l = m_leaves[index];
+      uint32_t i = leafOffset(x, y, z);
+      if (l.mask[i >> 6] & (uint64_t(1) << (i & 63))) {
+        l.mask[i >> 6] &= ~(uint64_t(1) << (i & 63));
+        m_activeCount--;
+      }
+      l.values[i] = m_background;
+    }
+
+    /**
+     \brief get the value of a voxel
+     \param x, y, z the voxel coordinates
+     \return the voxel value, the background value if the voxel is inactive
+     */
+    const T& getValue(int32_t x, int32_t y, int32_t z) const {
+      uint32_t index = findLeaf(x, y, z);
+      if (index == empty) {
+        return m_background;
+      }
+      return m_leaves[index].values[leafOffset(x, y, z)];
+    }
+
+    /**
+     \brief check if a voxel is active
+     \param x, y, z the voxel coordinates
+     */
+    bool isActive(int32_t x, int32_t y, int32_t z) const {
+      uint32_t index = findLeaf(x, y, z);
+      if (index == empty) {
+        return false;
+      }
+      uint32_t i = leafOffset(x, y, z);
+      return (m_leaves[index].mask[i >> 6] >> (i & 63)) & 1;
+    }
+
+    /**
+     \brief sample the field at a postion with a trilinear interpolation of the surrounding voxels
+     \param pos a vec3f representing the sample position
+     \return the value of the field at the position pos
+     */
+    T sample(vec3f pos) override{
+      vec3f X = (pos - m_origin) / m_voxelSize;
+      vec3i U = vec3i({ int32_t(std::floor(X[0])), int32_t(std::floor(X[1])), int32_t(std::floor(X[2])) });
+      vec3f R = X - vec3f({ float(U[0]), float(U[1]), float(U[2]) });
+
+      T A,B,C,D,E,F,G,H;
+      if ((U[0] & 7) < 7 && (U[1] & 7) < 7 && (U[2] & 7) < 7) {
+        // the 8 voxels are in the same leaf, it is only looked up once
+        uint32_t index = findLeaf(U[0], U[1], U[2]);
+        if (index == empty) {
+          return m_background;
+        }
+        const leaf& l = m_leaves[index];
+        uint32_t i = leafOffset(U[0], U[1], U[2]);
+        A = l.values[i];
+        B = l.values[i + 1];
+        C = l.values[i + 8];
+        D = l.values[i + 9];
+        E = l.values[i + 64];
+        F = l.values[i + 65];
+        G = l.values[i + 72];
+        H = l.values[i + 73];
+      }
+      else {
+        A = getValue(U[0]  , U[1]  , U[2]  );
+        B = getValue(U[0]+1, U[1]  , U[2]  );
+        C = getValue(U[0]  , U[1]+1, U[2]  );
+        D = getValue(U[0]+1, U[1]+1, U[2]  );
+        E = getValue(U[0]  , U[1]  , U[2]+1);
+        F = getValue(U[0]+1, U[1]  , U[2]+1);
+        G = getValue(U[0]  , U[1]+1, U[2]+1);
+        H = getValue(U[0]+1, U[1]+1, U[2]+1);
+      }
+
+      if (m_interpolate == nullptr) {
+        T AB = B * R[0] + A * (1.0f - R[0]);
+        T CD = D * R[0] + C * (1.0f - R[0]);
+
+        T ABCD = CD * R[1] + AB * (1.0f - R[1]);
+
+        T EF = F * R[0] + E * (1.0f - R[0]);
+        T GH = H * R[0] + G * (1.0f - R[0]);
+
+        T EFGH = GH * R[1] + EF * (1.0f - R[1]);
+
+        return EFGH * R[2] + ABCD * (1.0f - R[2]);
+      }
+
+      T AB = m_interpolate(A, B, R[0]);
+      T CD = m_interpolate(C, D, R[0]);
+      T ABCD = m_interpolate(AB, CD, R[1]);
+
+      T EF = m_interpolate(E, F, R[0]);
+      T GH = m_interpolate(G, H, R[0]);
+      T EFGH = m_interpolate(EF, GH, R[1]);
+      return m_interpolate(ABCD, EFGH, R[2]);
+    }
+
+    /**
+     \brief call a function on every active voxel, leaf by leaf
+     \param f a function taking the voxel coordinates as a vec3i and its value as a const T&
+     */
+    template<typename Function>
+    void forEachActive(Function f) const {
+      for (const leaf& l : m_leaves) {
+        for (uint32_t w = 0; w < 8; w++) {
+          uint64_t bits = l.mask[w];
+          while (bits) {
+            uint32_t i = w * 64 + (uint32_t)std::countr_zero(bits);
+            bits &= bits - 1;
+            f(vec3i({ l.origin[0] + int32_t(i & 7), l.origin[1] + int32_t((i >> 3) & 7), l.origin[2] + int32_t(i >> 6) }), l.values[i]);
+          }
+        }
+      }
+    }
+
+    /**
+     \brief get the position of a voxel in the domain
+     */
+    vec3f voxelPosition(const vec3i& voxel) const {
+      return m_origin + vec3f({ float(voxel[0]), float(voxel[1]), float(voxel[2]) }) * m_voxelSize;
+    }
+
+    /**
+     \brief get the number of active voxels
+     */
+    size_t activeVoxelCount() const {return m_activeCount;};
+
+    /**
+     \brief get the number of allocated leaves
+     */
+    size_t leafCount() const {return m_leaves.size();};
+
+    /**
+     \brief get the background value
+     */
+    const T& getBackground() const {return m_background;};
+
+    /**
+     \brief get the bounding box of the allocated leaves in the domain
+     \return a bounding box 3D, empty if no leaf is allocated
+     */
+    ABBox<3> getABBox() const {
+      ABBox<3> box;
+      for (const leaf& l : m_leaves) {
+        box.addPoint(voxelPosition(l.origin));
+        box.addPoint(voxelPosition(l.origin + vec3i({ 7, 7, 7 })));
+      }
+      return box;
+    }
+
+    private :
+
+    static constexpr uint32_t empty = UINT32_MAX;
+
+    struct leaf {
+      vec3i                   origin;
+      std::array<uint64_t, 8> mask;
+      std::array<T, 512>      values;
+    };
+
+    struct internal {
+      std::array<uint32_t, 4096> children;
+    };
+
+    // internal nodes cover 128 voxels per axis, the arithmetic shift keeps negative coordinates ordered
+    static uint64_t rootKey(int32_t x, int32_t y, int32_t z) {
+      return (uint64_t(uint32_t(x >> 7) & 0x1FFFFF) << 42) | (uint64_t(uint32_t(y >> 7) & 0x1FFFFF) << 21) | uint64_t(uint32_t(z >> 7) & 0x1FFFFF);
+    }
+
+    static uint32_t internalOffset(int32_t x, int32_t y, int32_t z) {
+      return ((x >> 3) & 15) | (((y >> 3) & 15) << 4) | (((z >> 3) & 15) << 8);
+    }
+
+    static uint32_t leafOffset(int32_t x, int32_t y, int32_t z) {
+      return (x & 7) | ((y & 7) << 3) | ((z & 7) << 6);
+    }
+
+    uint32_t findLeaf(int32_t x, int32_t y, int32_t z) const {
+      auto it = m_root.find(rootKey(x, y, z));
+      if (it == m_root.end()) {
+        return empty;
+      }
+      return m_internals[it->second].children[internalOffset(x, y, z)];
+    }
+
+    uint32_t touchLeaf(int32_t x, int32_t y, int32_t z) {
+      auto it = m_root.find(rootKey(x, y, z));
+      uint32_t node;
+      if (it == m_root.end()) {
+        node = (uint32_t)m_internals.size();
+        m_internals.emplace_back();
+        m_internals.back().children.fill(empty);
+        m_root[rootKey(x, y, z)] = node;
+      }
+      else {
+        node = it->second;
+      }
+
+      uint32_t& child = m_internals[node].children[internalOffset(x, y, z)];
+      if (child == empty) {
+        child = (uint32_t)m_leaves.size();
+        m_leaves.emplace_back();
+        leaf& l = m_leaves.back();
+        l.origin = vec3i({ x & ~7, y & ~7, z & ~7 });
+        l.mask.fill(0);
+        l.values.fill(m_background);
+      }
+      return child;
+    }
+
+    std::unordered_map<uint64_t, uint32_t>  m_root;
+    std::vector<internal>                   m_internals;
+    std::vector<leaf>                       m_leaves;
+
+    T                                       m_background;
+    vec3f                                   m_origin;
+    float                                   m_voxelSize;
+    size_t                                  m_activeCount = 0;
+
+    T (*m_interpolate)(T&, T&, float);
+  };
+
+  }
+}
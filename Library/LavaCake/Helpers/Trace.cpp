@@ -0,0 +1,140 @@
+#include "Trace.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+
+namespace LavaCake {
+  namespace Helpers {
+
+    namespace {
+      // the buffers are shared with the registry so their zones survive the end of their thread
+      struct traceRegistry {
+        std::mutex                                    mutex;
+        std::vector<std::shared_ptr<traceBuffer>>     buffers;
+        size_t                                        capacity = 1 << 16;
+      };
+
+      traceRegistry& registry() {
+        static traceRegistry r;
+        return r;
+      }
+
+      std::shared_ptr<traceBuffer> registerThread() {
+        traceRegistry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        auto buffer = std::make_shared<traceBuffer>();
+        buffer->events.resize(std::max<size_t>(r.capacity, 1));
+        buffer->threadId = static_cast<uint32_t>(r.buffers.size());
+        r.buffers.push_back(buffer);
+        return buffer;
+      }
+    }
+
+    std::string escapeJson(const std::string& s) {
+      std::string escaped;
+      for (char c : s) {
+        if (c == '"' || c == '\\') {
+          escaped.push_back('\\');
+        }
+        if (static_cast<unsigned char>(c) >= 0x20) {
+          escaped.push_back(c);
+        }
+      }
+      return escaped;
+    }
+
+    ChromeTraceWriter::ChromeTraceWriter(std::ostream& out) : m_out(out), m_flags(out.flags()), m_precision(out.precision()) {
+      m_out << std::fixed << std::setprecision(3);
+      m_out << "{\"traceEvents\":[";
+    }
+
+    void ChromeTraceWriter::threadName(uint32_t threadId, const std::string& name) {
+      m_out << (m_first ? "\n" : ",\n");
+      m_first = false;
+      m_out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << threadId
+        << ",\"args\":{\"name\":\"" << escapeJson(name) << "\"}}";
+    }
+
+    void ChromeTraceWriter::complete(const std::string& name, const char* category, uint32_t threadId, double begin, double duration) {
+      m_out << (m_first ? "\n" : ",\n");
+      m_first = false;
+      m_out << "{\"name\":\"" << escapeJson(name) << "\",\"cat\":\"" << category << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << threadId
+        << ",\"ts\":" << begin << ",\"dur\":" << duration << "}";
+    }
+
+    ChromeTraceWriter::~ChromeTraceWriter() {
+      m_out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+      m_out.flags(m_flags);
+      m_out.precision(m_precision);
+    }
+
+    traceBuffer& Tracer::threadBuffer() {
+      thread_local std::shared_ptr<traceBuffer> buffer = registerThread();
+      return *buffer;
+    }
+
+    void Tracer::setThreadName(const std::string& name) {
+      traceBuffer& buffer = threadBuffer();
+      std::lock_guard<std::mutex> lock(registry().mutex);
+      buffer.threadName = name;
+    }
+
+    void Tracer::setCapacity(size_t capacity) {
+      std::lock_guard<std::mutex> lock(registry().mutex);
+      registry().capacity = capacity;
+    }
+
+    void Tracer::clear() {
+      std::lock_guard<std::mutex> lock(registry().mutex);
+      for (auto& buffer : registry().buffers) {
+        buffer->count.store(0, std::memory_order_relaxed);
+      }
+    }
+
+    void Tracer::writeChromeTrace(std::ostream& out) {
+      traceRegistry& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+
+      // the timestamps are relative to the oldest zone kept
+      uint64_t origin = UINT64_MAX;
+      for (auto& buffer : r.buffers) {
+        uint64_t count = buffer->count.load(std::memory_order_acquire);
+        uint64_t size = buffer->events.size();
+        for (uint64_t i = count > size ? count - size : 0; i < count; i++) {
+          origin = std::min(origin, buffer->events[i % size].begin);
+        }
+      }
+
+      ChromeTraceWriter writer(out);
+      for (auto& buffer : r.buffers) {
+        uint64_t count = buffer->count.load(std::memory_order_acquire);
+        if (count == 0) {
+          continue;
+        }
+        if (!buffer->threadName.empty()) {
+          writer.threadName(buffer->threadId, buffer->threadName);
+        }
+
+        uint64_t size = buffer->events.size();
+        for (uint64_t i = count > size ? count - size : 0; i < count; i++) {
+          const traceEvent& e = buffer->events[i % size];
+          // the zones are in nanoseconds, the trace in microseconds
+          writer.complete(e.name, "cpu", buffer->threadId, double(e.begin - origin) / 1000.0, double(e.end - e.begin) / 1000.0);
+        }
+      }
+    }
+
+    bool Tracer::exportChromeTrace(const std::string& filename) {
+      std::ofstream ofs;
+      ofs.open(filename, std::ofstream::out | std::ofstream::trunc);
+      if (!ofs.is_open()) {
+        return false;
+      }
+      writeChromeTrace(ofs);
+      return ofs.good();
+    }
+
+  }
+}
@@ -0,0 +1,178 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace LavaCake {
+  namespace Helpers {
+
+    /**
+     \brief escape a string to write it between the quotes of a JSON string, the control characters are dropped
+     \param s the string
+     */
+    std::string escapeJson(const std::string& s);
+
+    /**
+     *Class ChromeTraceWriter :
+     *\brief write events in the Chrome trace event format, readable by chrome://tracing or Perfetto.
+     *The header is written by the constructor and the footer by the destructor, the timestamps are in microseconds
+     */
+    class ChromeTraceWriter {
+    public:
+      ChromeTraceWriter(std::ostream& out);
+
+      ChromeTraceWriter(const ChromeTraceWriter&) = delete;
+      ChromeTraceWriter& operator=(const ChromeTraceWriter&) = delete;
+
+      /**
+       \brief name a thread of the trace
+       \param threadId the id of the thread
+       \param name the name of the thread
+       */
+      void threadName(uint32_t threadId, const std::string& name);
+
+      /**
+       \brief write a complete event
+       \param name the name of the event
+       \param category the category of the event
+       \param threadId the id of the thread the event belongs to
+       \param begin the beginning of the event in microseconds
+       \param duration the duration of the event in microseconds
+       */
+      void complete(const std::string& name, const char* category, uint32_t threadId, double begin, double duration);
+
+      ~ChromeTraceWriter();
+
+    private:
+      std::ostream&             m_out;
+      std::ios_base::fmtflags   m_flags;
+      std::streamsize           m_precision;
+      bool                      m_first = true;
+    };
+
+    /**
+     \brief a zone recorded by the tracer, the name must outlive the tracer (string literals)
+     */
+    struct traceEvent {
+      const char*   name;
+      uint64_t      begin;      // nanoseconds
+      uint64_t      end;        // nanoseconds
+    };
+
+    /**
+     \brief the events of one thread, only written by this thread
+     */
+    struct traceBuffer {
+      std::vector<traceEvent>   events;
+      std::atomic<uint64_t>     count = 0;
+      uint32_t                  threadId = 0;
+      std::string               threadName;
+    };
+
+    /**
+     *Class Tracer :
+     *\brief Record the CPU time spent in named zones, see LAVACAKE_TRACE_ZONE.
+     *Each thread writes its zones without locking in its own ring buffer, the oldest zones being overwritten when it is full.
+     *The buffers must only be exported or cleared while the traced threads are not recording zones.
+     */
+    class Tracer {
+    public:
+
+      /**
+       \brief get the current time of the tracer clock in nanoseconds
+       */
+      static uint64_t now() {
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+      }
+
+      /**
+       \brief get the buffer of the calling thread, created on the first call of each thread
+       */
+      static traceBuffer& threadBuffer();
+
+      /**
+       \brief record a zone in the buffer of the calling thread
+       \param name the name of the zone, it must outlive the tracer
+       \param begin the beginning of the zone in nanoseconds
+       \param end the end of the zone in nanoseconds
+       */
+      static void record(const char* name, uint64_t begin, uint64_t end) {
+        record(threadBuffer(), name, begin, end);
+      }
+
+      /**
+       \brief record a zone in a thread buffer, must be called from the thread owning the buffer
+       */
+      static void record(traceBuffer& buffer, const char* name, uint64_t begin, uint64_t end) {
+        uint64_t count = buffer.count.load(std::memory_order_relaxed);
+        buffer.events[count % buffer.events.size()] = { name, begin, end };
+        buffer.count.store(count + 1, std::memory_order_release);
+      }
+
+      /**
+       \brief name the calling thread in the exported traces
+       \param name the name of the thread
+       */
+      static void setThreadName(const std::string& name);
+
+      /**
+       \brief set the number of zones kept by each thread, applied to the threads starting to record afterward
+       \param capacity the number of zones
+       */
+      static void setCapacity(size_t capacity);
+
+      /**
+       \brief forget the recorded zones of every thread
+       */
+      static void clear();
+
+      /**
+       \brief write the recorded zones in the Chrome trace event format, readable by chrome://tracing or Perfetto
+       \param out the stream the JSON is written to
+       */
+      static void writeChromeTrace(std::ostream& out);
+
+      /**
+       \brief write the recorded zones in a Chrome trace file
+       \param filename the path of the file
+       \return true if the file was written
+       */
+      static bool exportChromeTrace(const std::string& filename);
+    };
+
+    /**
+     *Class TraceZone :
+     *\brief record the lifetime of the object as a zone of the tracer
+     */
+    class TraceZone {
+    public:
+      TraceZone(const char* name) : m_buffer(Tracer::threadBuffer()), m_name(name), m_begin(Tracer::now()) {}
+
+      TraceZone(const TraceZone&) = delete;
+      TraceZone& operator=(const TraceZone&) = delete;
+
+      ~TraceZone() {
+        Tracer::record(m_buffer, m_name, m_begin, Tracer::now());
+      }
+
+    private:
+      traceBuffer&  m_buffer;
+      const char*   m_name;
+      uint64_t      m_begin;
+    };
+
+  }
+}
+
+// The zones are only compiled when LAVACAKE_TRACING is defined (cmake option LAVACAKE_TRACING), otherwise they cost nothing
+#define LAVACAKE_TRACE_CONCAT_IMPL(a, b) a##b
+#define LAVACAKE_TRACE_CONCAT(a, b) LAVACAKE_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef LAVACAKE_TRACING
+#define LAVACAKE_TRACE_ZONE(name) ::LavaCake::Helpers::TraceZone LAVACAKE_TRACE_CONCAT(lavacakeTraceZone, __LINE__)(name)
+#else
+#define LAVACAKE_TRACE_ZONE(name) ((void)0)
+#endif
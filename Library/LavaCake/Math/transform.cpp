@@ -0,0 +1,268 @@
+#include "transform.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace LavaCake {
+
+namespace {
+
+  // Vertices are processed by blocks of this size, the loops over a block only touch
+  // contiguous arrays of floats so that compilers can vectorize them.
+  constexpr size_t blockSize = 16;
+
+  // Below this number of vertices per thread, spawning threads costs more than it saves.
+  constexpr size_t minimalVerticesPerThread = 16384;
+
+  bounds3f emptyBounds() {
+    float inf = std::numeric_limits<float>::infinity();
+    return { vec3f({ inf, inf, inf }), vec3f({ -inf, -inf, -inf }) };
+  }
+
+  void mergeBounds(bounds3f& bounds, bounds3f const& other) {
+    for (int u = 0; u < 3; u++) {
+      bounds.first[u] = other.first[u] < bounds.first[u] ? other.first[u] : bounds.first[u];
+      bounds.second[u] = other.second[u] > bounds.second[u] ? other.second[u] : bounds.second[u];
+    }
+  }
+
+  uint32_t threadNumber(size_t count, uint32_t threadCount) {
+    if (threadCount == 0) {
+      threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t maxThreads = std::max<size_t>(1, count / minimalVerticesPerThread);
+    return (uint32_t)std::min<size_t>(threadCount, maxThreads);
+  }
+
+  // Split [0, count) in contiguous ranges, run job(begin, end) on each of them and merge the resulting bounds
+  template<typename F>
+  bounds3f parallelFor(size_t count, uint32_t threadCount, F const& job) {
+    uint32_t n = threadNumber(count, threadCount);
+    if (n <= 1) {
+      return job(0, count);
+    }
+
+    size_t chunk = (count + n - 1) / n;
+    std::vector<bounds3f> partials(n, emptyBounds());
+    std::vector<std::thread> threads;
+    for (uint32_t t = 1; t < n; t++) {
+      threads.emplace_back([&, t]() {
+        size_t begin = t * chunk;
+        size_t end = std::min(count, begin + chunk);
+        if (begin < end) {
+          partials[t] = job(begin, end);
+        }
+      });
+    }
+    partials[0] = job(0, std::min(count, chunk));
+
+    bounds3f bounds = emptyBounds();
+    for (uint32_t t = 0; t < n; t++) {
+      if (t > 0) {
+        threads[t - 1].join();
+      }
+      mergeBounds(bounds, partials[t]);
+    }
+    return bounds;
+  }
+
+  // Transform n <= blockSize points stored as structure of arrays, optionally accumulating their bounds
+  template<bool withBounds>
+  void transformBlock(float* x, float* y, float* z, size_t n, mat4 const& m, bounds3f& bounds) {
+    for (size_t i = 0; i < n; i++) {
+      float px = x[i];
+      float py = y[i];
+      float pz = z[i];
+      x[i] = m[0] * px + m[4] * py + m[8]  * pz + m[12];
+      y[i] = m[1] * px + m[5] * py + m[9]  * pz + m[13];
+      z[i] = m[2] * px + m[6] * py + m[10] * pz + m[14];
+    }
+    if constexpr (withBounds) {
+      vec3f bmin = bounds.first;
+      vec3f bmax = bounds.second;
+      for (size_t i = 0; i < n; i++) {
+        bmin[0] = x[i] < bmin[0] ? x[i] : bmin[0];
+        bmin[1] = y[i] < bmin[1] ? y[i] : bmin[1];
+        bmin[2] = z[i] < bmin[2] ? z[i] : bmin[2];
+        bmax[0] = x[i] > bmax[0] ? x[i] : bmax[0];
+        bmax[1] = y[i] > bmax[1] ? y[i] : bmax[1];
+        bmax[2] = z[i] > bmax[2] ? z[i] : bmax[2];
+      }
+      bounds = { bmin, bmax };
+    }
+  }
+
+  void normalizeBlock(float* x, float* y, float* z, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      float length = std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+      float inv = length > 0.0f ? 1.0f / length : 1.0f;
+      x[i] *= inv;
+      y[i] *= inv;
+      z[i] *= inv;
+    }
+  }
+
+  // Gather blocks of an interleaved array into local structure of arrays, apply op and scatter them back
+  template<bool writeBack, typename T, typename F>
+  void interleavedBlocks(T* data, size_t stride, size_t begin, size_t end, F const& op) {
+    float x[blockSize];
+    float y[blockSize];
+    float z[blockSize];
+    for (size_t b = begin; b < end; b += blockSize) {
+      size_t n = std::min(blockSize, end - b);
+      T* v = data + b * stride;
+      for (size_t i = 0; i < n; i++) {
+        x[i] = v[i * stride + 0];
+        y[i] = v[i * stride + 1];
+        z[i] = v[i * stride + 2];
+      }
+      op(x, y, z, n);
+      if constexpr (writeBack) {
+        for (size_t i = 0; i < n; i++) {
+          v[i * stride + 0] = x[i];
+          v[i * stride + 1] = y[i];
+          v[i * stride + 2] = z[i];
+        }
+      }
+    }
+  }
+
+  // Number of complete 3 components elements in an interleaved array
+  size_t elementCount(size_t size, size_t stride) {
+    if (stride < 3 || size < 3) {
+      return 0;
+    }
+    return (size - 3) / stride + 1;
+  }
+
+  // Inverse transpose of the upper 3x3 part of a column major matrix, stored as a column major mat4 without translation
+  mat4 normalMatrix(mat4 const& m) {
+    float a00 = m[0], a01 = m[4], a02 = m[8];
+    float a10 = m[1], a11 = m[5], a12 = m[9];
+    float a20 = m[2], a21 = m[6], a22 = m[10];
+
+    float c00 = a11 * a22 - a12 * a21;
+    float c01 = a12 * a20 - a10 * a22;
+    float c02 = a10 * a21 - a11 * a20;
+    float c10 = a02 * a21 - a01 * a22;
+    float c11 = a00 * a22 - a02 * a20;
+    float c12 = a01 * a20 - a00 * a21;
+    float c20 = a01 * a12 - a02 * a11;
+    float c21 = a02 * a10 - a00 * a12;
+    float c22 = a00 * a11 - a01 * a10;
+
+    float det = a00 * c00 + a01 * c01 + a02 * c02;
+    float s = det != 0.0f ? 1.0f / det : 1.0f;
+
+    return mat4({
+      c00 * s, c10 * s, c20 * s, 0.0f,
+      c01 * s, c11 * s, c21 * s, 0.0f,
+      c02 * s, c12 * s, c22 * s, 0.0f,
+      0.0f,    0.0f,    0.0f,    1.0f
+    });
+  }
+}
+
+bounds3f ComputeBounds(std::span<const float> data, size_t stride, uint32_t threadCount) {
+  size_t count = elementCount(data.size(), stride);
+  return parallelFor(count, threadCount, [&](size_t begin, size_t end) {
+    bounds3f bounds = emptyBounds();
+    interleavedBlocks<false>(data.data(), stride, begin, end, [&](float* x, float* y, float* z, size_t n) {
+      for (size_t i = 0; i < n; i++) {
+        bounds.first[0] = x[i] < bounds.first[0] ? x[i] : bounds.first[0];
+        bounds.first[1] = y[i] < bounds.first[1] ? y[i] : bounds.first[1];
+        bounds.first[2] = z[i] < bounds.first[2] ? z[i] : bounds.first[2];
+        bounds.second[0] = x[i] > bounds.second[0] ? x[i] : bounds.second[0];
+        bounds.second[1] = y[i] > bounds.second[1] ? y[i] : bounds.second[1];
+        bounds.second[2] = z[i] > bounds.second[2] ? z[i] : bounds.second[2];
+      }
+    });
+    return bounds;
+  });
+}
+
+bounds3f TransformPoints(std::span<float> data, size_t stride, mat4 const& transform, uint32_t threadCount) {
+  size_t count = elementCount(data.size(), stride);
+  return parallelFor(count, threadCount, [&](size_t begin, size_t end) {
+    bounds3f bounds = emptyBounds();
+    interleavedBlocks<true>(data.data(), stride, begin, end, [&](float* x, float* y, float* z, size_t n) {
+      transformBlock<true>(x, y, z, n, transform, bounds);
+    });
+    return bounds;
+  });
+}
+
+bounds3f TransformPoints(std::span<vec3f> points, mat4 const& transform, uint32_t threadCount) {
+  if (points.empty()) {
+    return emptyBounds();
+  }
+  return TransformPoints(std::span<float>(points.data()->data(), points.size() * 3), 3, transform, threadCount);
+}
+
+bounds3f TransformPoints(std::span<float> x, std::span<float> y, std::span<float> z, mat4 const& transform, uint32_t threadCount) {
+  size_t count = std::min({ x.size(), y.size(), z.size() });
+  return parallelFor(count, threadCount, [&](size_t begin, size_t end) {
+    bounds3f bounds = emptyBounds();
+    for (size_t b = begin; b < end; b += blockSize) {
+      transformBlock<true>(&x[b], &y[b], &z[b], std::min(blockSize, end - b), transform, bounds);
+    }
+    return bounds;
+  });
+}
+
+void TransformNormals(std::span<float> data, size_t stride, mat4 const& transform, bool renormalize, uint32_t threadCount) {
+  size_t count = elementCount(data.size(), stride);
+  mat4 normal = normalMatrix(transform);
+  parallelFor(count, threadCount, [&](size_t begin, size_t end) {
+    bounds3f unused;
+    interleavedBlocks<true>(data.data(), stride, begin, end, [&](float* x, float* y, float* z, size_t n) {
+      transformBlock<false>(x, y, z, n, normal, unused);
+      if (renormalize) {
+        normalizeBlock(x, y, z, n);
+      }
+    });
+    return emptyBounds();
+  });
+}
+
+void TransformNormals(std::span<float> x, std::span<float> y, std::span<float> z, mat4 const& transform, bool renormalize, uint32_t threadCount) {
+  size_t count = std::min({ x.size(), y.size(), z.size() });
+  mat4 normal = normalMatrix(transform);
+  parallelFor(count, threadCount, [&](size_t begin, size_t end) {
+    bounds3f unused;
+    for (size_t b = begin; b < end; b += blockSize) {
+      size_t n = std::min(blockSize, end - b);
+      transformBlock<false>(&x[b], &y[b], &z[b], n, normal, unused);
+      if (renormalize) {
+        normalizeBlock(&x[b], &y[b], &z[b], n);
+      }
+    }
+    return emptyBounds();
+  });
+}
+
+VkTransformMatrixKHR ToTransformMatrix(mat4 const& transform) {
+  VkTransformMatrixKHR result;
+  for (int r = 0; r < 3; r++) {
+    for (int c = 0; c < 4; c++) {
+      result.matrix[r][c] = transform[c * 4 + r];
+    }
+  }
+  return result;
+}
+
+void ToTransformMatrices(std::span<const mat4> transforms, std::span<VkTransformMatrixKHR> result) {
+  size_t count = std::min(transforms.size(), result.size());
+  for (size_t i = 0; i < count; i++) {
+    const float* m = transforms[i].data();
+    float* t = &result[i].matrix[0][0];
+    for (int r = 0; r < 3; r++) {
+      t[r * 4 + 0] = m[r];
+      t[r * 4 + 1] = m[4 + r];
+      t[r * 4 + 2] = m[8 + r];
+      t[r * 4 + 3] = m[12 + r];
+    }
+  }
+}
+
+}
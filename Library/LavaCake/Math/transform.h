@@ -0,0 +1,110 @@
+#pragma once
+
+#include <span>
+#include <utility>
+#include "AllHeaders.h"
+#include "basics.h"
+
+namespace LavaCake {
+
+  /**
+   \brief Min and max corners of a set of points, {min, max}
+  */
+  using bounds3f = std::pair<vec3f, vec3f>;
+
+  /**
+   \brief Compute the bounds of positions stored in an interleaved array
+   \param data: the interleaved vertex data, the position being the first 3 floats of each vertex
+   \param stride: the number of floats between two consecutive vertices
+   \param threadCount: the number of threads used for the computation, 0 to use all the available cores
+   \return the bounds of the positions, {inf, -inf} if the array is empty
+  */
+  bounds3f ComputeBounds(std::span<const float>   data,
+                         size_t                   stride,
+                         uint32_t                 threadCount = 1);
+
+  /**
+   \brief Transform positions stored in an interleaved array by an affine matrix and compute their bounds in the same pass
+   \param data: the interleaved vertex data, the position being the first 3 floats of each vertex (use subspan to target another attribute)
+   \param stride: the number of floats between two consecutive vertices
+   \param transform: the column major transformation, the last row is ignored
+   \param threadCount: the number of threads used for the computation, 0 to use all the available cores
+   \return the bounds of the transformed positions
+  */
+  bounds3f TransformPoints(std::span<float>       data,
+                           size_t                 stride,
+                           mat4 const&            transform,
+                           uint32_t               threadCount = 1);
+
+  /**
+   \brief Transform an array of positions by an affine matrix and compute their bounds in the same pass
+   \param points: the positions to transform
+   \param transform: the column major transformation, the last row is ignored
+   \param threadCount: the number of threads used for the computation, 0 to use all the available cores
+   \return the bounds of the transformed positions
+  */
+  bounds3f TransformPoints(std::span<vec3f>       points,
+                           mat4 const&            transform,
+                           uint32_t               threadCount = 1);
+
+  /**
+   \brief Transform positions stored as a structure of arrays by an affine matrix and compute their bounds in the same pass
+   \param x: the x coordinates
+   \param y: the y coordinates, must have the same size as x
+   \param z: the z coordinates, must have the same size as x
+   \param transform: the column major transformation, the last row is ignored
+   \param threadCount: the number of threads used for the computation, 0 to use all the available cores
+   \return the bounds of the transformed positions
+  */
+  bounds3f TransformPoints(std::span<float>       x,
+                           std::span<float>       y,
+                           std::span<float>       z,
+                           mat4 const&            transform,
+                           uint32_t               threadCount = 1);
+
+  /**
+   \brief Transform normals stored in an interleaved array by the inverse transpose of the upper 3x3 part of a matrix
+   \param data: the interleaved vertex data, the normal being the first 3 floats of each vertex (use subspan to target the normal attribute)
+   \param stride: the number of floats between two consecutive vertices
+   \param transform: the column major transformation applied to the positions
+   \param renormalize: if true the transformed normals are normalized
+   \param threadCount: the number of threads used for the computation, 0 to use all the available cores
+  */
+  void TransformNormals(std::span<float>          data,
+                        size_t                    stride,
+                        mat4 const&               transform,
+                        bool                      renormalize = true,
+                        uint32_t                  threadCount = 1);
+
+  /**
+   \brief Transform normals stored as a structure of arrays by the inverse transpose of the upper 3x3 part of a matrix
+   \param x: the x coordinates
+   \param y: the y coordinates, must have the same size as x
+   \param z: the z coordinates, must have the same size as x
+   \param transform: the column major transformation applied to the positions
+   \param renormalize: if true the transformed normals are normalized
+   \param threadCount: the number of threads used for the computation, 0 to use all the available cores
+  */
+  void TransformNormals(std::span<float>          x,
+                        std::span<float>          y,
+                        std::span<float>          z,
+                        mat4 const&               transform,
+                        bool                      renormalize = true,
+                        uint32_t                  threadCount = 1);
+
+  /**
+   \brief Convert a column major matrix into the row major 3x4 matrix used by acceleration structure instances
+   \param transform: the matrix to convert, the last row is dropped
+   \return the converted matrix
+  */
+  VkTransformMatrixKHR ToTransformMatrix(mat4 const& transform);
+
+  /**
+   \brief Convert an array of column major matrices into row major 3x4 matrices used by acceleration structure instances
+   \param transforms: the matrices to convert
+   \param result: the converted matrices, must have the same size as transforms
+  */
+  void ToTransformMatrices(std::span<const mat4>              transforms,
+                           std::span<VkTransformMatrixKHR>    result);
+
+}
@@ -1,4 +1,5 @@
 #include "BottomLevelAS.h"
+#include <LavaCake/Helpers/Trace.h>
 
 namespace LavaCake {
 	namespace RayTracing {
@@ -49,6 +50,7 @@ namespace LavaCake {
 
 
 			void BottomLevelAccelerationStructure::allocate(const  Framework::Queue& queue, Framework::CommandBuffer& cmdBuff, bool allowUpdate) {
+				LAVACAKE_TRACE_ZONE("BottomLevelAccelerationStructure::allocate");
 
 				Framework::Device* d = Framework::Device::getDevice();
 				VkDevice device = d->getLogicalDevice();
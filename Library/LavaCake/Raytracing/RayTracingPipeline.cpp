@@ -1,4 +1,5 @@
 #include "RayTracingPipeline.h"
+#include <LavaCake/Helpers/Trace.h>
 
 namespace LavaCake {
 	namespace RayTracing {
@@ -163,6 +164,7 @@ namespace LavaCake {
 			}
 
 			void RayTracingPipeline::compile(const Framework::Queue& queue, Framework::CommandBuffer& cmdBuff) {
+				LAVACAKE_TRACE_ZONE("RayTracingPipeline::compile");
 
 				Framework::Device* d = Framework::Device::getDevice();
 				VkDevice logical = d->getLogicalDevice();
@@ -209,11 +211,13 @@ namespace LavaCake {
 			}
 
 			void RayTracingPipeline::trace(Framework::CommandBuffer& cmdbuff) {
+				LAVACAKE_TRACE_ZONE("RayTracingPipeline::trace");
 				vkCmdBindPipeline(cmdbuff.getHandle(), VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, m_pipeline);
 
 				std::vector<VkDescriptorSet> descriptorSets = { m_descriptorSet->getHandle() };
 				if (!m_descriptorSet->isEmpty()) {
 					vkCmdBindDescriptorSets(cmdbuff.getHandle(), VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, m_pipelineLayout, 0, (uint32_t)descriptorSets.size(), descriptorSets.data(), 0, 0);
+					Framework::FrameStatistics::add(Framework::COUNTER_DESCRIPTOR_BINDS);
 				}
 				VkStridedDeviceAddressRegionKHR callableShaderSbtEntry{};
                 
@@ -226,6 +230,8 @@ namespace LavaCake {
 					m_width,
 					m_height,
 					1);
+				Framework::FrameStatistics::add(Framework::COUNTER_PIPELINE_BINDS);
+				Framework::FrameStatistics::add(Framework::COUNTER_DISPATCHES);
 			}
 
 
@@ -1,9 +1,11 @@
 #include "ShaderBindingTable.h"
+#include <LavaCake/Helpers/Trace.h>
 
 namespace LavaCake {
   namespace RayTracing {
 
     void ShaderBindingTable::compile(const Framework::Queue& queue, Framework::CommandBuffer& cmdBuff, VkPipeline raytracingPipeline) {
+      LAVACAKE_TRACE_ZONE("ShaderBindingTable::compile");
       Framework::Device* d = Framework::Device::getDevice();
       VkDevice logical = d->getLogicalDevice();
       VkPhysicalDevice physical = d->getPhysicalDevice();
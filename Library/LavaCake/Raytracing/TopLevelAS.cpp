@@ -1,4 +1,5 @@
 #include "TopLevelAS.h"
+#include <LavaCake/Helpers/Trace.h>
 
 namespace LavaCake {
   namespace RayTracing {
@@ -18,7 +19,24 @@ namespace LavaCake {
 
       }
 
+      void TopLevelAccelerationStructure::addInstance(BottomLevelAccelerationStructure* bottomLevelAS, const mat4& transform, uint32_t instanceID, uint32_t hitGroupOffset) {
+        VkTransformMatrixKHR matrix = ToTransformMatrix(transform);
+        addInstance(bottomLevelAS, matrix, instanceID, hitGroupOffset);
+      }
+
+      void TopLevelAccelerationStructure::addInstances(BottomLevelAccelerationStructure* bottomLevelAS, std::span<const mat4> transforms, uint32_t firstInstanceID, uint32_t hitGroupOffset) {
+        std::vector<VkTransformMatrixKHR> matrices(transforms.size());
+        ToTransformMatrices(transforms, matrices);
+
+        m_instances.reserve(m_instances.size() + matrices.size());
+        m_AccelerationStructureInstances.reserve(m_AccelerationStructureInstances.size() + matrices.size());
+        for (uint32_t i = 0; i < (uint32_t)matrices.size(); i++) {
+          addInstance(bottomLevelAS, matrices[i], firstInstanceID + i, hitGroupOffset);
+        }
+      }
+
       void TopLevelAccelerationStructure::alloctate(const Framework::Queue& queue, Framework::CommandBuffer& cmdBuff, bool allowUpdate) {
+        LAVACAKE_TRACE_ZONE("TopLevelAccelerationStructure::alloctate");
         Framework::Device* d = Framework::Device::getDevice();
         VkDevice logical = d->getLogicalDevice();
         VkPhysicalDevice phyDevice = d->getPhysicalDevice();
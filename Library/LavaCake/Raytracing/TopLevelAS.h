@@ -1,6 +1,7 @@
 #pragma once
 #include "AllHeaders.h"
 #include "BottomLevelAS.h"
+#include <LavaCake/Math/transform.h>
 
 
 
@@ -11,6 +12,17 @@ namespace LavaCake {
     public:
       void addInstance(BottomLevelAccelerationStructure* bottomLevelAS, VkTransformMatrixKHR& transform, uint32_t instanceID, uint32_t hitGroupOffset);
 
+      /**
+      \brief Add an instance using a column major transformation matrix
+      */
+      void addInstance(BottomLevelAccelerationStructure* bottomLevelAS, const mat4& transform, uint32_t instanceID, uint32_t hitGroupOffset);
+
+      /**
+      \brief Add one instance of bottomLevelAS per transformation, converting all the matrices at once
+      \param firstInstanceID: the instance ID of the first instance, the following ones are incremented by one
+      */
+      void addInstances(BottomLevelAccelerationStructure* bottomLevelAS, std::span<const mat4> transforms, uint32_t firstInstanceID, uint32_t hitGroupOffset);
+
       void alloctate(const Framework::Queue& queue, Framework::CommandBuffer& cmdBuff, bool allowUpdate = false);
 
       const VkAccelerationStructureKHR& getHandle() const{